@@ -0,0 +1,500 @@
+#pragma once
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include "LineSelectionStrategy.h"
+#include "Person.h"
+#include "QueueTicket.h"
+#include "RingBuffer.h"
+#include "ThroughputTracker.h"
+
+/**
+ * @brief Line storage policy: every line is an inline ring of at most Capacity people
+ *
+ * No heap at all, so RAM use is fixed at build time (Lines * Capacity * sizeof(Person)).
+ * A full line is treated like a line at capacity and is never selected.
+ */
+template <size_t Capacity>
+struct FixedLineStorage
+{
+    static_assert(Capacity > 0 && (Capacity & (Capacity - 1)) == 0, "Line capacity must be a power of two");
+
+    static constexpr size_t CAPACITY = Capacity;
+
+    template <typename T>
+    class Line
+    {
+    public:
+        /// @return false if the line is full
+        bool push_back(const T &item)
+        {
+            if (full())
+            {
+                return false;
+            }
+            m_items[(m_head + m_size) & (Capacity - 1)] = item;
+            m_size++;
+            return true;
+        }
+
+        void pop_front()
+        {
+            m_head = (m_head + 1) & (Capacity - 1);
+            m_size--;
+        }
+
+        T &front() { return m_items[m_head]; }
+        const T &front() const { return m_items[m_head]; }
+        T &operator[](size_t index) { return m_items[(m_head + index) & (Capacity - 1)]; }
+        size_t size() const { return m_size; }
+        bool empty() const { return m_size == 0; }
+        bool full() const { return m_size == Capacity; }
+
+    private:
+        std::array<T, Capacity> m_items;
+        size_t m_head = 0;
+        size_t m_size = 0;
+    };
+};
+
+/**
+ * @brief Line storage policy: every line is a growable RingBuffer (host builds, long lines)
+ */
+struct GrowableLineStorage
+{
+    static constexpr size_t CAPACITY = 0; // Unbounded
+
+    template <typename T>
+    class Line
+    {
+    public:
+        bool push_back(const T &item)
+        {
+            m_items.push_back(item);
+            return true;
+        }
+
+        void pop_front() { m_items.pop_front(); }
+        T &front() { return m_items.front(); }
+        const T &front() const { return m_items.front(); }
+        T &operator[](size_t index) { return m_items[index]; }
+        size_t size() const { return m_items.size(); }
+        bool empty() const { return m_items.empty(); }
+        bool full() const { return false; }
+
+    private:
+        RingBuffer<T> m_items;
+    };
+};
+
+// Selection policies: strategy() names the strategy in effect, select() returns the 0-based
+// line to join or -1. Both are inlined into BasicQueueManager::enqueue().
+
+/// Shortest estimated wait (LineSelectionStrategy::SHORTEST_WAIT_TIME)
+struct ShortestWaitPolicy
+{
+    template <typename Manager>
+    static LineSelectionStrategy strategy(const Manager &) { return LineSelectionStrategy::SHORTEST_WAIT_TIME; }
+
+    template <typename Manager>
+    static int select(const Manager &manager)
+    {
+        return manager.lowestEligible([&manager](int lineIndex)
+                                      { return manager.waitEstimateAt(lineIndex); });
+    }
+};
+
+/// Fewest people (LineSelectionStrategy::FEWEST_PEOPLE)
+struct FewestPeoplePolicy
+{
+    template <typename Manager>
+    static LineSelectionStrategy strategy(const Manager &) { return LineSelectionStrategy::FEWEST_PEOPLE; }
+
+    template <typename Manager>
+    static int select(const Manager &manager)
+    {
+        return manager.lowestEligible([&manager](int lineIndex)
+                                      { return static_cast<double>(manager.peopleAt(lineIndex)); });
+    }
+};
+
+/// Highest eligible line number (LineSelectionStrategy::FARTHEST_FROM_ENTRANCE)
+struct FarthestFromEntrancePolicy
+{
+    template <typename Manager>
+    static LineSelectionStrategy strategy(const Manager &) { return LineSelectionStrategy::FARTHEST_FROM_ENTRANCE; }
+
+    template <typename Manager>
+    static int select(const Manager &manager)
+    {
+        return manager.lowestEligible([](int lineIndex)
+                                      { return -static_cast<double>(lineIndex); });
+    }
+};
+
+/// Lowest eligible line number (LineSelectionStrategy::NEAREST_TO_ENTRANCE)
+struct NearestToEntrancePolicy
+{
+    template <typename Manager>
+    static LineSelectionStrategy strategy(const Manager &) { return LineSelectionStrategy::NEAREST_TO_ENTRANCE; }
+
+    template <typename Manager>
+    static int select(const Manager &manager)
+    {
+        return manager.lowestEligible([](int lineIndex)
+                                      { return static_cast<double>(lineIndex); });
+    }
+};
+
+/// Same rule as QueueManager::enqueueAuto: fewest people until every line has reliable throughput data
+struct AutoPolicy
+{
+    template <typename Manager>
+    static LineSelectionStrategy strategy(const Manager &manager)
+    {
+        return manager.allLinesReliable() ? LineSelectionStrategy::SHORTEST_WAIT_TIME
+                                          : LineSelectionStrategy::FEWEST_PEOPLE;
+    }
+
+    template <typename Manager>
+    static int select(const Manager &manager)
+    {
+        return manager.allLinesReliable() ? ShortestWaitPolicy::select(manager) : FewestPeoplePolicy::select(manager);
+    }
+};
+
+/**
+ * @brief Queue core specialized at compile time for a fixed line count and selection policy
+ *
+ * Same arrival / service model as QueueManager (M/M/c wait estimates cached per line,
+ * 1-based line numbers, exit timestamp set on reaching a register), without the runtime
+ * configuration: arrays are sized by Lines, the policy is inlined instead of switching on
+ * a LineSelectionStrategy, and the template line-number overloads need no range check.
+ * With a handful of lines a linear pass over the cached estimates beats a heap.
+ *
+ * For builds that know their layout, e.g. the two-line ESP32 counter:
+ * `BasicQueueManager<2, AutoPolicy, FixedLineStorage<32>>`. Cloud publishing, history,
+ * abandonment, snapshots and the event log stay in QueueManager, the runtime-configured facade.
+ *
+ * @tparam Lines Number of lines
+ * @tparam StrategyPolicy ShortestWaitPolicy, FewestPeoplePolicy, FarthestFromEntrancePolicy,
+ *         NearestToEntrancePolicy, AutoPolicy or any type with the same static interface
+ * @tparam Storage FixedLineStorage<N> or GrowableLineStorage
+ */
+template <int Lines, typename StrategyPolicy = AutoPolicy, typename Storage = FixedLineStorage<64>>
+class BasicQueueManager
+{
+    static_assert(Lines > 0, "BasicQueueManager needs at least one line");
+
+public:
+    static constexpr int NUMBER_OF_LINES = Lines;
+
+    /**
+     * @param maxSize Maximum people per line (0 = limited only by the storage)
+     */
+    explicit BasicQueueManager(int maxSize = 0) : m_maxSize(maxSize)
+    {
+        m_available.fill(true);
+        for (int i = 0; i < Lines; ++i)
+        {
+            refresh(i);
+        }
+    }
+
+    /**
+     * @param maxSize Maximum people per line (0 = limited only by the storage)
+     * @param serviceRates Expected service rate of each line (people/second)
+     */
+    BasicQueueManager(int maxSize, const std::array<double, Lines> &serviceRates) : BasicQueueManager(maxSize)
+    {
+        for (int i = 0; i < Lines; ++i)
+        {
+            m_trackers[i] = ThroughputTracker(serviceRates[i]);
+            refresh(i);
+        }
+    }
+
+    // Core queue operations
+    /**
+     * @brief Adds a person to the line the policy selects
+     * @return Ticket with the assigned line, or not admitted if no line is eligible
+     */
+    EnqueueResult enqueue()
+    {
+        int lineIndex = StrategyPolicy::select(*this);
+        if (lineIndex < 0)
+        {
+            return EnqueueResult();
+        }
+        return admit(lineIndex, routingTagOf(StrategyPolicy::strategy(*this)));
+    }
+
+    /**
+     * @brief Adds a person to a specific line (e.g. a sensor on that line)
+     * @param lineNumber Line (1-based indexing)
+     */
+    EnqueueResult enqueueOnLine(int lineNumber)
+    {
+        if (!isValidLineNumber(lineNumber) || !hasRoom(lineNumber - 1))
+        {
+            return EnqueueResult();
+        }
+        return admit(lineNumber - 1, Person::NOT_ROUTED);
+    }
+
+    /// enqueueOnLine() for a line known at compile time
+    template <int LineNumber>
+    EnqueueResult enqueueOnLine()
+    {
+        static_assert(LineNumber >= 1 && LineNumber <= Lines, "Line number out of range");
+        return hasRoom(LineNumber - 1) ? admit(LineNumber - 1, Person::NOT_ROUTED) : EnqueueResult();
+    }
+
+    /**
+     * @brief Completes service of the person at the counter of a line
+     * @param lineNumber Line (1-based indexing)
+     * @return false if the line number is invalid or the line is empty
+     */
+    bool dequeue(int lineNumber)
+    {
+        return isValidLineNumber(lineNumber) && completeService(lineNumber - 1);
+    }
+
+    /// dequeue() for a line known at compile time
+    template <int LineNumber>
+    bool dequeue()
+    {
+        static_assert(LineNumber >= 1 && LineNumber <= Lines, "Line number out of range");
+        return completeService(LineNumber - 1);
+    }
+
+    /**
+     * @brief Line the policy would give the next arrival
+     * @return Line number (1-based indexing), or -1 if no line is eligible
+     */
+    int getNextLineNumber() const
+    {
+        int lineIndex = StrategyPolicy::select(*this);
+        return lineIndex < 0 ? -1 : lineIndex + 1;
+    }
+
+    /// Strategy the policy currently applies
+    LineSelectionStrategy getCurrentStrategy() const { return StrategyPolicy::strategy(*this); }
+
+    // Line state
+    /**
+     * @brief Marks a line as available or not (sensor health); unavailable lines are never selected
+     * @param lineNumber Line (1-based indexing)
+     */
+    void setLineAvailability(int lineNumber, bool available)
+    {
+        if (isValidLineNumber(lineNumber))
+        {
+            m_available[lineNumber - 1] = available;
+            refresh(lineNumber - 1);
+        }
+    }
+
+    /**
+     * @brief Sets how many registers are staffed on a line (one queue feeding several registers)
+     * @param lineNumber Line (1-based indexing)
+     * @param servers Staffed registers, at least 1
+     * @return false if the line number or server count is invalid
+     */
+    bool setServerCount(int lineNumber, int servers)
+    {
+        if (!isValidLineNumber(lineNumber) || servers < 1)
+        {
+            return false;
+        }
+        m_trackers[lineNumber - 1].setServerCount(servers);
+        startFreeRegisters(lineNumber - 1);
+        refresh(lineNumber - 1);
+        return true;
+    }
+
+    /// Staffed registers of a line, -1 for an invalid line number
+    int getServerCount(int lineNumber) const
+    {
+        return isValidLineNumber(lineNumber) ? m_trackers[lineNumber - 1].getServerCount() : -1;
+    }
+
+    bool isLineAvailable(int lineNumber) const
+    {
+        return isValidLineNumber(lineNumber) && m_available[lineNumber - 1];
+    }
+
+    /// People in a line, 0 for an invalid line number
+    int getLineCount(int lineNumber) const
+    {
+        return isValidLineNumber(lineNumber) ? peopleAt(lineNumber - 1) : 0;
+    }
+
+    /// getLineCount() for a line known at compile time
+    template <int LineNumber>
+    int getLineCount() const
+    {
+        static_assert(LineNumber >= 1 && LineNumber <= Lines, "Line number out of range");
+        return peopleAt(LineNumber - 1);
+    }
+
+    /**
+     * @brief Estimated wait until a new arrival reaches the counter (cached per line)
+     * @param lineNumber Line (1-based indexing)
+     * @return Seconds, 999 for an invalid line number
+     */
+    double getEstimatedWaitTime(int lineNumber) const
+    {
+        return isValidLineNumber(lineNumber) ? m_waitEstimates[lineNumber - 1] : 999.0;
+    }
+
+    /// Person at the counter of a line, nullptr if the line is empty or invalid
+    const Person *getFirstPersonInLine(int lineNumber) const
+    {
+        if (!isValidLineNumber(lineNumber) || m_lines[lineNumber - 1].empty())
+        {
+            return nullptr;
+        }
+        return &m_lines[lineNumber - 1].front();
+    }
+
+    /// Total people waiting in all lines
+    int size() const { return m_totalPeople; }
+
+    int getTotalPeopleEver() const { return m_totalPeopleEver; }
+    int getCompletedPeopleEver() const { return m_completedPeopleEver; }
+
+    /// Bumped on every change that may affect selection or estimates
+    uint64_t getStateVersion() const { return m_stateVersion; }
+
+    // Read by the selection policies (0-based line index, no range check)
+    int peopleAt(int lineIndex) const { return static_cast<int>(m_lines[lineIndex].size()); }
+    double waitEstimateAt(int lineIndex) const { return m_waitEstimates[lineIndex]; }
+
+    bool allLinesReliable() const
+    {
+        for (int i = 0; i < Lines; ++i)
+        {
+            if (!m_trackers[i].hasReliableData())
+            {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    /**
+     * @brief Eligible line with the lowest score (ties go to the lower line, as in QueueManager)
+     * @param score Callable (int lineIndex) -> double
+     * @return 0-based line index, or -1 if no line is eligible
+     */
+    template <typename Score>
+    int lowestEligible(Score score) const
+    {
+        int best = -1;
+        double bestScore = 0.0;
+        for (int i = 0; i < Lines; ++i)
+        {
+            if (!m_eligible[i])
+            {
+                continue;
+            }
+            double lineScore = score(i);
+            if (best < 0 || lineScore < bestScore)
+            {
+                best = i;
+                bestScore = lineScore;
+            }
+        }
+        return best;
+    }
+
+private:
+    using Line = typename Storage::template Line<Person>;
+
+    static bool isValidLineNumber(int lineNumber)
+    {
+        return static_cast<unsigned>(lineNumber - 1) < static_cast<unsigned>(Lines);
+    }
+
+    bool hasRoom(int lineIndex) const
+    {
+        return !m_lines[lineIndex].full() && (m_maxSize <= 0 || peopleAt(lineIndex) < m_maxSize);
+    }
+
+    EnqueueResult admit(int lineIndex, uint8_t routingTag)
+    {
+        double expectedWaitTime = m_waitEstimates[lineIndex];
+        Person person(expectedWaitTime, lineIndex + 1);
+        person.setPersonId(m_nextPersonId++);
+        person.setRoutingTag(routingTag);
+        if (!m_lines[lineIndex].push_back(person))
+        {
+            return EnqueueResult();
+        }
+        m_trackers[lineIndex].recordArrival();
+        m_totalPeople++;
+        m_totalPeopleEver++;
+
+        // A register is free: at the counter right away
+        if (peopleAt(lineIndex) <= m_trackers[lineIndex].getServerCount())
+        {
+            startFreeRegisters(lineIndex);
+        }
+        refresh(lineIndex);
+
+        return EnqueueResult(lineIndex + 1, peopleAt(lineIndex), person.getPersonId(), expectedWaitTime);
+    }
+
+    bool completeService(int lineIndex)
+    {
+        Line &line = m_lines[lineIndex];
+        if (line.empty())
+        {
+            return false;
+        }
+        line.pop_front();
+        m_totalPeople--;
+        m_trackers[lineIndex].recordServiceCompletion();
+        startFreeRegisters(lineIndex);
+        refresh(lineIndex);
+        return true;
+    }
+
+    // The first `servers` people in line are at a register; start the service of whoever just got one
+    void startFreeRegisters(int lineIndex)
+    {
+        Line &line = m_lines[lineIndex];
+        size_t atRegister = std::min(line.size(), static_cast<size_t>(m_trackers[lineIndex].getServerCount()));
+        for (size_t i = 0; i < atRegister; ++i)
+        {
+            if (!line[i].hasExited())
+            {
+                line[i].recordExitAt(Person::getCurrentTimestamp());
+                m_completedPeopleEver++;
+            }
+        }
+    }
+
+    void refresh(int lineIndex)
+    {
+        m_waitEstimates[lineIndex] = m_trackers[lineIndex].getEstimatedWaitTime(peopleAt(lineIndex));
+        m_eligible[lineIndex] = m_available[lineIndex] && hasRoom(lineIndex);
+        m_stateVersion++;
+    }
+
+    int m_maxSize;
+    int m_totalPeople = 0;
+    int m_totalPeopleEver = 0;
+    int m_completedPeopleEver = 0; // People who reached the counter
+    int m_nextPersonId = 1;
+    uint64_t m_stateVersion = 0;
+
+    std::array<Line, Lines> m_lines;
+    std::array<ThroughputTracker, Lines> m_trackers;
+    std::array<double, Lines> m_waitEstimates{};
+    std::array<bool, Lines> m_available{};
+    std::array<bool, Lines> m_eligible{}; // Available and not at capacity
+};
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <cstring>
+#include <vector>
+
+/**
+ * @brief Appends fixed-width values to a byte buffer in host byte order
+ *
+ * Used for the QueueManager snapshot format. Values are copied with memcpy, so the
+ * buffer has no alignment requirements; blobs are meant to be read back on the
+ * same architecture (ESP32 and x86/ARM desktops are all little-endian).
+ */
+class BinaryWriter
+{
+public:
+    explicit BinaryWriter(std::vector<uint8_t> &buffer) : m_buffer(buffer) {}
+
+    template <typename T>
+    void write(T value)
+    {
+        size_t offset = m_buffer.size();
+        m_buffer.resize(offset + sizeof(T));
+        std::memcpy(m_buffer.data() + offset, &value, sizeof(T));
+    }
+
+    size_t size() const { return m_buffer.size(); }
+
+private:
+    std::vector<uint8_t> &m_buffer;
+};
+
+/**
+ * @brief Reads fixed-width values back from a byte buffer with bounds checking
+ *
+ * A read past the end leaves the value untouched and latches the reader into a
+ * failed state, so a decoder can read a whole record and check ok() once.
+ */
+class BinaryReader
+{
+public:
+    BinaryReader(const uint8_t *data, size_t size) : m_data(data), m_size(size), m_offset(0), m_ok(data != nullptr) {}
+
+    template <typename T>
+    bool read(T &value)
+    {
+        if (!m_ok || m_size - m_offset < sizeof(T))
+        {
+            m_ok = false;
+            return false;
+        }
+        std::memcpy(&value, m_data + m_offset, sizeof(T));
+        m_offset += sizeof(T);
+        return true;
+    }
+
+    bool ok() const { return m_ok; }
+    size_t remaining() const { return m_size - m_offset; }
+
+private:
+    const uint8_t *m_data;
+    size_t m_size;
+    size_t m_offset;
+    bool m_ok;
+};
+
+/// 32-bit FNV-1a hash, used as the integrity check of stored blobs
+inline uint32_t fnv1aChecksum(const uint8_t *data, size_t size)
+{
+    uint32_t hash = 2166136261u;
+    for (size_t i = 0; i < size; ++i)
+    {
+        hash ^= data[i];
+        hash *= 16777619u;
+    }
+    return hash;
+}
@@ -0,0 +1,498 @@
+#include "CompletedPeopleArchive.h"
+#include <algorithm>
+#include <cmath>
+#include <limits>
+
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#define COMPLETED_ARCHIVE_SSE2 1
+#include <emmintrin.h>
+#endif
+
+namespace
+{
+    // Running aggregates before the means are taken
+    struct Partial
+    {
+        size_t count = 0;
+        int64_t totalWait = 0;
+        int32_t minWait = std::numeric_limits<int32_t>::max();
+        int32_t maxWait = std::numeric_limits<int32_t>::min();
+        double totalExpected = 0.0;
+        float minExpected = std::numeric_limits<float>::infinity();
+        float maxExpected = -std::numeric_limits<float>::infinity();
+    };
+
+    void aggregateScalar(const int32_t *entering, const int32_t *exiting, const float *expected,
+                         const uint32_t *attributes, size_t count, uint32_t mask, uint32_t value, Partial &partial)
+    {
+        for (size_t i = 0; i < count; ++i)
+        {
+            if ((attributes[i] & mask) != value)
+            {
+                continue;
+            }
+            int32_t wait = exiting[i] - entering[i];
+            partial.count++;
+            partial.totalWait += wait;
+            partial.minWait = std::min(partial.minWait, wait);
+            partial.maxWait = std::max(partial.maxWait, wait);
+            partial.totalExpected += expected[i];
+            partial.minExpected = std::min(partial.minExpected, expected[i]);
+            partial.maxExpected = std::max(partial.maxExpected, expected[i]);
+        }
+    }
+
+    CompletedPeopleArchive::Stats finish(const Partial &partial)
+    {
+        CompletedPeopleArchive::Stats stats;
+        if (partial.count == 0)
+        {
+            return stats;
+        }
+        stats.count = partial.count;
+        stats.totalActualWait = static_cast<double>(partial.totalWait);
+        stats.meanActualWait = stats.totalActualWait / partial.count;
+        stats.minActualWait = partial.minWait;
+        stats.maxActualWait = partial.maxWait;
+        stats.totalExpectedWait = partial.totalExpected;
+        stats.meanExpectedWait = partial.totalExpected / partial.count;
+        stats.minExpectedWait = partial.minExpected;
+        stats.maxExpectedWait = partial.maxExpected;
+        return stats;
+    }
+
+    size_t binOf(double wait, double binSeconds, size_t binCount)
+    {
+        double bin = wait / binSeconds; // Division keeps exact multiples on their bin edge
+        return bin >= static_cast<double>(binCount - 1) ? binCount - 1 : static_cast<size_t>(bin > 0.0 ? bin : 0.0);
+    }
+
+    size_t histogramScalar(const int32_t *entering, const int32_t *exiting, const uint32_t *attributes, size_t count,
+                           uint32_t mask, uint32_t value, double binSeconds, uint32_t *bins, size_t binCount)
+    {
+        size_t counted = 0;
+        for (size_t i = 0; i < count; ++i)
+        {
+            if ((attributes[i] & mask) == value)
+            {
+                bins[binOf(exiting[i] - entering[i], binSeconds, binCount)]++;
+                counted++;
+            }
+        }
+        return counted;
+    }
+
+#ifdef COMPLETED_ARCHIVE_SSE2
+    inline int popcount4(int bits)
+    {
+        return (bits & 1) + ((bits >> 1) & 1) + ((bits >> 2) & 1) + ((bits >> 3) & 1);
+    }
+
+    // a where select is all-ones, b elsewhere (SSE2 has no blend)
+    inline __m128i selectInt(__m128i select, __m128i a, __m128i b)
+    {
+        return _mm_or_si128(_mm_and_si128(select, a), _mm_andnot_si128(select, b));
+    }
+
+    inline __m128 selectFloat(__m128 select, __m128 a, __m128 b)
+    {
+        return _mm_or_ps(_mm_and_ps(select, a), _mm_andnot_ps(select, b));
+    }
+
+    /// Four rows per step; returns the number of rows processed (a multiple of 4)
+    size_t aggregateSse2(const int32_t *entering, const int32_t *exiting, const float *expected,
+                         const uint32_t *attributes, size_t count, uint32_t mask, uint32_t value, Partial &partial)
+    {
+        // Float sums are flushed to double every block so long columns keep their precision
+        const size_t BLOCK_ROWS = 4096;
+
+        const __m128i maskVector = _mm_set1_epi32(static_cast<int>(mask));
+        const __m128i valueVector = _mm_set1_epi32(static_cast<int>(value));
+        const __m128i zero = _mm_setzero_si128();
+        const __m128i intMax = _mm_set1_epi32(std::numeric_limits<int32_t>::max());
+        const __m128i intMin = _mm_set1_epi32(std::numeric_limits<int32_t>::min());
+        const __m128 infinity = _mm_set1_ps(std::numeric_limits<float>::infinity());
+        const __m128 negativeInfinity = _mm_set1_ps(-std::numeric_limits<float>::infinity());
+
+        __m128i totalWait = zero; // Two 64-bit lanes
+        __m128i minWait = intMax, maxWait = intMin;
+        __m128 minExpected = infinity, maxExpected = negativeInfinity;
+        size_t matched = 0;
+
+        size_t vectorRows = count & ~static_cast<size_t>(3);
+        for (size_t blockStart = 0; blockStart < vectorRows; blockStart += BLOCK_ROWS)
+        {
+            size_t blockEnd = std::min(vectorRows, blockStart + BLOCK_ROWS);
+            __m128 blockExpected = _mm_setzero_ps();
+            for (size_t i = blockStart; i < blockEnd; i += 4)
+            {
+                __m128i attribute = _mm_loadu_si128(reinterpret_cast<const __m128i *>(attributes + i));
+                __m128i match = _mm_cmpeq_epi32(_mm_and_si128(attribute, maskVector), valueVector);
+                __m128 matchFloat = _mm_castsi128_ps(match);
+                matched += popcount4(_mm_movemask_ps(matchFloat));
+
+                // Waits are never negative (see append), so zero-extending to 64 bits is exact
+                __m128i wait = _mm_sub_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i *>(exiting + i)),
+                                             _mm_loadu_si128(reinterpret_cast<const __m128i *>(entering + i)));
+                __m128i matchedWait = _mm_and_si128(match, wait);
+                totalWait = _mm_add_epi64(totalWait, _mm_unpacklo_epi32(matchedWait, zero));
+                totalWait = _mm_add_epi64(totalWait, _mm_unpackhi_epi32(matchedWait, zero));
+
+                __m128i lowCandidate = selectInt(match, wait, intMax);
+                minWait = selectInt(_mm_cmplt_epi32(lowCandidate, minWait), lowCandidate, minWait);
+                __m128i highCandidate = selectInt(match, wait, intMin);
+                maxWait = selectInt(_mm_cmpgt_epi32(highCandidate, maxWait), highCandidate, maxWait);
+
+                __m128 expectedWait = _mm_loadu_ps(expected + i);
+                blockExpected = _mm_add_ps(blockExpected, _mm_and_ps(matchFloat, expectedWait));
+                minExpected = _mm_min_ps(minExpected, selectFloat(matchFloat, expectedWait, infinity));
+                maxExpected = _mm_max_ps(maxExpected, selectFloat(matchFloat, expectedWait, negativeInfinity));
+            }
+
+            float lanes[4];
+            _mm_storeu_ps(lanes, blockExpected);
+            partial.totalExpected += static_cast<double>(lanes[0]) + lanes[1] + lanes[2] + lanes[3];
+        }
+
+        int64_t waitLanes[2];
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(waitLanes), totalWait);
+        int32_t minLanes[4], maxLanes[4];
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(minLanes), minWait);
+        _mm_storeu_si128(reinterpret_cast<__m128i *>(maxLanes), maxWait);
+        float minExpectedLanes[4], maxExpectedLanes[4];
+        _mm_storeu_ps(minExpectedLanes, minExpected);
+        _mm_storeu_ps(maxExpectedLanes, maxExpected);
+
+        partial.count += matched;
+        partial.totalWait += waitLanes[0] + waitLanes[1];
+        for (int lane = 0; lane < 4; ++lane)
+        {
+            partial.minWait = std::min(partial.minWait, minLanes[lane]);
+            partial.maxWait = std::max(partial.maxWait, maxLanes[lane]);
+            partial.minExpected = std::min(partial.minExpected, minExpectedLanes[lane]);
+            partial.maxExpected = std::max(partial.maxExpected, maxExpectedLanes[lane]);
+        }
+        return vectorRows;
+    }
+
+    /// Bin indices for four rows at a time, counted with scalar increments; returns rows processed
+    size_t histogramSse2(const int32_t *entering, const int32_t *exiting, const uint32_t *attributes, size_t count,
+                         uint32_t mask, uint32_t value, double binSeconds, uint32_t *bins, size_t binCount,
+                         size_t &counted)
+    {
+        const __m128i maskVector = _mm_set1_epi32(static_cast<int>(mask));
+        const __m128i valueVector = _mm_set1_epi32(static_cast<int>(value));
+        const __m128 width = _mm_set1_ps(static_cast<float>(binSeconds));
+        const __m128 lastBin = _mm_set1_ps(static_cast<float>(binCount - 1));
+
+        size_t vectorRows = count & ~static_cast<size_t>(3);
+        int32_t index[4];
+        for (size_t i = 0; i < vectorRows; i += 4)
+        {
+            __m128i attribute = _mm_loadu_si128(reinterpret_cast<const __m128i *>(attributes + i));
+            int matches = _mm_movemask_ps(_mm_castsi128_ps(
+                _mm_cmpeq_epi32(_mm_and_si128(attribute, maskVector), valueVector)));
+            if (matches == 0)
+            {
+                continue;
+            }
+
+            __m128i wait = _mm_sub_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i *>(exiting + i)),
+                                         _mm_loadu_si128(reinterpret_cast<const __m128i *>(entering + i)));
+            __m128 bin = _mm_min_ps(_mm_div_ps(_mm_cvtepi32_ps(wait), width), lastBin);
+            _mm_storeu_si128(reinterpret_cast<__m128i *>(index), _mm_cvttps_epi32(bin));
+
+            for (int lane = 0; lane < 4; ++lane)
+            {
+                if (matches & (1 << lane))
+                {
+                    bins[index[lane]]++;
+                    counted++;
+                }
+            }
+        }
+        return vectorRows;
+    }
+#endif
+}
+
+void CompletedPeopleArchive::append(const Person &person, long long completedTimestamp)
+{
+    if (person.getLineNumber() < 1 || person.getLineNumber() > MAX_LINES)
+    {
+        return; // Would alias another line in the 16-bit line field
+    }
+    if (MAX_ROWS > 0 && m_completed.size() >= MAX_ROWS)
+    {
+        dropOldestHalf();
+    }
+
+    // Keep the completion column sorted and waits non-negative (the kernels rely on both)
+    int32_t completed = static_cast<int32_t>(completedTimestamp);
+    if (!m_completed.empty() && completed < m_completed.back())
+    {
+        completed = m_completed.back();
+    }
+    int32_t entering = static_cast<int32_t>(person.getEnteringTimestamp());
+    int32_t exiting = person.hasExited() ? static_cast<int32_t>(person.getExitingTimestamp()) : completed;
+    if (exiting < entering)
+    {
+        exiting = entering;
+    }
+
+    uint32_t attributes = static_cast<uint32_t>(person.getLineNumber()) & LINE_MASK;
+    attributes |= (static_cast<uint32_t>(person.getRoutingTag()) << ROUTING_SHIFT) & ROUTING_MASK;
+    if (person.hasAbandoned())
+    {
+        attributes |= ABANDONED_BIT;
+    }
+
+    m_entering.push_back(entering);
+    m_exiting.push_back(exiting);
+    m_completed.push_back(completed);
+    m_expectedWait.push_back(static_cast<float>(person.getExpectedWaitTime()));
+    m_attributes.push_back(attributes);
+}
+
+void CompletedPeopleArchive::clear()
+{
+    m_entering.clear();
+    m_exiting.clear();
+    m_completed.clear();
+    m_expectedWait.clear();
+    m_attributes.clear();
+}
+
+void CompletedPeopleArchive::reserve(size_t rows)
+{
+    m_entering.reserve(rows);
+    m_exiting.reserve(rows);
+    m_completed.reserve(rows);
+    m_expectedWait.reserve(rows);
+    m_attributes.reserve(rows);
+}
+
+void CompletedPeopleArchive::dropOldestHalf()
+{
+    size_t dropped = m_completed.size() / 2;
+    m_entering.erase(m_entering.begin(), m_entering.begin() + dropped);
+    m_exiting.erase(m_exiting.begin(), m_exiting.begin() + dropped);
+    m_completed.erase(m_completed.begin(), m_completed.begin() + dropped);
+    m_expectedWait.erase(m_expectedWait.begin(), m_expectedWait.begin() + dropped);
+    m_attributes.erase(m_attributes.begin(), m_attributes.begin() + dropped);
+}
+
+bool CompletedPeopleArchive::simdAvailable()
+{
+#ifdef COMPLETED_ARCHIVE_SSE2
+    return true;
+#else
+    return false;
+#endif
+}
+
+void CompletedPeopleArchive::rowRange(const Query &query, size_t &begin, size_t &end) const
+{
+    long long from = std::max<long long>(query.fromTimestamp, std::numeric_limits<int32_t>::min());
+    long long to = std::min<long long>(query.toTimestamp, std::numeric_limits<int32_t>::max());
+    if (from >= to)
+    {
+        begin = end = 0;
+        return;
+    }
+    begin = std::lower_bound(m_completed.begin(), m_completed.end(), static_cast<int32_t>(from)) - m_completed.begin();
+    end = std::lower_bound(m_completed.begin() + begin, m_completed.end(), static_cast<int32_t>(to)) - m_completed.begin();
+    if (to == std::numeric_limits<int32_t>::max())
+    {
+        end = m_completed.size(); // Open-ended window also includes the largest representable time
+    }
+}
+
+void CompletedPeopleArchive::attributeFilter(const Query &query, uint32_t &mask, uint32_t &value)
+{
+    mask = 0;
+    value = 0;
+    if (query.lineNumber > 0)
+    {
+        // Line 0 is never stored, so a line beyond MAX_LINES matches no row
+        mask |= LINE_MASK;
+        value |= query.lineNumber <= MAX_LINES ? static_cast<uint32_t>(query.lineNumber) : 0;
+    }
+    if (query.routingTag >= 0)
+    {
+        mask |= ROUTING_MASK;
+        value |= (static_cast<uint32_t>(query.routingTag) << ROUTING_SHIFT) & ROUTING_MASK;
+    }
+    if (query.outcome != Outcome::ANY)
+    {
+        mask |= ABANDONED_BIT;
+        value |= query.outcome == Outcome::ABANDONED ? ABANDONED_BIT : 0;
+    }
+}
+
+CompletedPeopleArchive::Stats CompletedPeopleArchive::aggregate(const Query &query, bool useSimd) const
+{
+    size_t begin, end;
+    rowRange(query, begin, end);
+    uint32_t mask, value;
+    attributeFilter(query, mask, value);
+    return aggregateRows(begin, end, mask, value, useSimd);
+}
+
+CompletedPeopleArchive::Stats CompletedPeopleArchive::aggregateRows(size_t begin, size_t end, uint32_t mask,
+                                                                    uint32_t value, bool useSimd) const
+{
+    const int32_t *entering = m_entering.data() + begin;
+    const int32_t *exiting = m_exiting.data() + begin;
+    const float *expected = m_expectedWait.data() + begin;
+    const uint32_t *attributes = m_attributes.data() + begin;
+    size_t count = end - begin;
+
+    Partial partial;
+    size_t done = 0;
+#ifdef COMPLETED_ARCHIVE_SSE2
+    if (useSimd)
+    {
+        done = aggregateSse2(entering, exiting, expected, attributes, count, mask, value, partial);
+    }
+#else
+    (void)useSimd;
+#endif
+    if (done < count)
+    {
+        aggregateScalar(entering + done, exiting + done, expected + done, attributes + done, count - done,
+                        mask, value, partial);
+    }
+
+    return finish(partial);
+}
+
+size_t CompletedPeopleArchive::histogram(const Query &query, double binSeconds, uint32_t *bins, size_t binCount,
+                                         bool useSimd) const
+{
+    if (!bins || binCount == 0)
+    {
+        return 0;
+    }
+    std::fill(bins, bins + binCount, 0u);
+    if (!(binSeconds > 0.0))
+    {
+        return 0;
+    }
+
+    size_t begin, end;
+    rowRange(query, begin, end);
+    uint32_t mask, value;
+    attributeFilter(query, mask, value);
+    return histogramRows(begin, end, mask, value, binSeconds, bins, binCount, useSimd);
+}
+
+size_t CompletedPeopleArchive::histogramRows(size_t begin, size_t end, uint32_t mask, uint32_t value,
+                                             double binSeconds, uint32_t *bins, size_t binCount, bool useSimd) const
+{
+    const int32_t *entering = m_entering.data() + begin;
+    const int32_t *exiting = m_exiting.data() + begin;
+    const uint32_t *attributes = m_attributes.data() + begin;
+    size_t count = end - begin;
+
+    size_t counted = 0;
+    size_t done = 0;
+#ifdef COMPLETED_ARCHIVE_SSE2
+    // Single precision bin arithmetic is exact enough while the bin indices stay well inside float range
+    if (useSimd && binCount < (1u << 20))
+    {
+        done = histogramSse2(entering, exiting, attributes, count, mask, value, binSeconds, bins, binCount, counted);
+    }
+#else
+    (void)useSimd;
+#endif
+    if (done < count)
+    {
+        counted += histogramScalar(entering + done, exiting + done, attributes + done, count - done,
+                                   mask, value, binSeconds, bins, binCount);
+    }
+    return counted;
+}
+
+std::vector<CompletedPeopleArchive::Stats> CompletedPeopleArchive::aggregateByLine(const Query &query,
+                                                                                   int numberOfLines) const
+{
+    std::vector<Stats> result(numberOfLines > 0 ? numberOfLines : 0);
+    size_t begin, end;
+    rowRange(query, begin, end);
+
+    Query anyLine = query;
+    anyLine.lineNumber = 0;
+    uint32_t mask, value;
+    attributeFilter(anyLine, mask, value);
+
+    // One pass scattering into per-line partials, instead of one filtered pass per line
+    std::vector<Partial> partials(result.size());
+    for (size_t i = begin; i < end; ++i)
+    {
+        uint32_t attributes = m_attributes[i];
+        size_t lineIndex = static_cast<size_t>(attributes & LINE_MASK) - 1;
+        if ((attributes & mask) != value || lineIndex >= partials.size())
+        {
+            continue;
+        }
+        Partial &partial = partials[lineIndex];
+        int32_t wait = m_exiting[i] - m_entering[i];
+        partial.count++;
+        partial.totalWait += wait;
+        partial.minWait = std::min(partial.minWait, wait);
+        partial.maxWait = std::max(partial.maxWait, wait);
+        partial.totalExpected += m_expectedWait[i];
+        partial.minExpected = std::min(partial.minExpected, m_expectedWait[i]);
+        partial.maxExpected = std::max(partial.maxExpected, m_expectedWait[i]);
+    }
+    for (size_t i = 0; i < result.size(); ++i)
+    {
+        result[i] = finish(partials[i]);
+    }
+    return result;
+}
+
+std::vector<CompletedPeopleArchive::Stats> CompletedPeopleArchive::aggregateByPeriod(const Query &query,
+                                                                                     long long periodSeconds,
+                                                                                     long long *firstPeriodStart) const
+{
+    std::vector<Stats> result;
+    size_t begin, end;
+    rowRange(query, begin, end);
+    if (periodSeconds <= 0 || begin >= end)
+    {
+        return result;
+    }
+
+    // Aligned periods spanning the rows actually in the window
+    auto floorToPeriod = [periodSeconds](long long timestamp)
+    {
+        long long start = timestamp - timestamp % periodSeconds;
+        return timestamp % periodSeconds < 0 ? start - periodSeconds : start;
+    };
+    long long first = floorToPeriod(std::max<long long>(query.fromTimestamp, m_completed[begin]));
+    long long last = floorToPeriod(m_completed[end - 1]);
+    if (firstPeriodStart)
+    {
+        *firstPeriodStart = first;
+    }
+
+    uint32_t mask, value;
+    attributeFilter(query, mask, value);
+    result.reserve(static_cast<size_t>((last - first) / periodSeconds + 1));
+    size_t rowBegin = begin;
+    for (long long periodStart = first; periodStart <= last; periodStart += periodSeconds)
+    {
+        long long periodEnd = std::min<long long>(periodStart + periodSeconds, std::numeric_limits<int32_t>::max());
+        size_t rowEnd = std::lower_bound(m_completed.begin() + rowBegin, m_completed.begin() + end,
+                                         static_cast<int32_t>(periodEnd)) - m_completed.begin();
+        if (periodStart + periodSeconds > last)
+        {
+            rowEnd = end;
+        }
+        result.push_back(aggregateRows(rowBegin, rowEnd, mask, value, true));
+        rowBegin = rowEnd;
+    }
+    return result;
+}
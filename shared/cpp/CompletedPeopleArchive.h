@@ -0,0 +1,150 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "Person.h"
+
+/**
+ * @brief Column store of everyone who left the queue, for per-line / per-hour / per-strategy analytics
+ *
+ * Each attribute lives in its own contiguous array (entering, exiting and completion
+ * timestamps, expected wait, and a packed line / routing / outcome word), so a query
+ * only streams the columns it needs and the aggregate kernels process four rows per
+ * instruction with SSE2 (scalar fallback elsewhere, e.g. ESP32).
+ *
+ * Rows are appended in completion order, and completion times are kept non-decreasing,
+ * so a time window is a contiguous row range found by binary search; line, routing and
+ * outcome filters are a single masked compare per row.
+ *
+ * Timestamps are stored as 32-bit seconds since simulation start, and line numbers in
+ * 16 bits: people on lines above MAX_LINES are not archived.
+ */
+class CompletedPeopleArchive
+{
+public:
+    /// Which people a query counts
+    enum class Outcome
+    {
+        SERVED,    ///< Reached the counter and were served
+        ABANDONED, ///< Left the line before being served
+        ANY
+    };
+
+    /**
+     * @brief Row filter; the defaults select every served person
+     */
+    struct Query
+    {
+        long long fromTimestamp = 0;         ///< Completion time window start (inclusive, seconds since simulation start)
+        long long toTimestamp = 0x7fffffff;  ///< Completion time window end (exclusive)
+        int lineNumber = 0;                  ///< 1-based line, 0 = every line
+        int routingTag = -1;                 ///< Person::getRoutingTag() value, -1 = any
+        Outcome outcome = Outcome::SERVED;
+    };
+
+    /**
+     * @brief Aggregates over the rows a query selected (all zero if none matched)
+     *
+     * Actual wait is the time until reaching the counter, or until leaving for abandoned people.
+     */
+    struct Stats
+    {
+        size_t count = 0;
+        double totalActualWait = 0.0;
+        double meanActualWait = 0.0;
+        long long minActualWait = 0;
+        long long maxActualWait = 0;
+        double totalExpectedWait = 0.0;
+        double meanExpectedWait = 0.0;
+        double minExpectedWait = 0.0;
+        double maxExpectedWait = 0.0;
+    };
+
+    /// Highest line number a row can hold
+    static const int MAX_LINES = 0xffff;
+
+    CompletedPeopleArchive() = default;
+
+    /**
+     * @brief Adds one person who left the queue
+     * @param person Served (exit recorded) or abandoned person; ignored if their line is outside 1..MAX_LINES
+     * @param completedTimestamp When they left the system (seconds since simulation start);
+     *        clamped to the previous row's so the column stays sorted
+     */
+    void append(const Person &person, long long completedTimestamp);
+
+    /// Number of archived people
+    size_t size() const { return m_completed.size(); }
+
+    bool empty() const { return m_completed.empty(); }
+
+    /// Forgets every row
+    void clear();
+
+    /// Ensures room for `rows` people without further growth
+    void reserve(size_t rows);
+
+    /**
+     * @brief Sum, mean, min and max of actual and expected wait over the selected rows
+     * @param useSimd false forces the scalar kernel (for cross-checking)
+     */
+    Stats aggregate(const Query &query, bool useSimd = true) const;
+
+    /**
+     * @brief Counts the selected rows by actual wait
+     * @param binSeconds Width of each bin; bin i holds waits in [i * binSeconds, (i + 1) * binSeconds)
+     * @param bins Caller array of binCount counters, overwritten; the last bin also holds everything longer
+     * @return Number of rows counted
+     */
+    size_t histogram(const Query &query, double binSeconds, uint32_t *bins, size_t binCount,
+                     bool useSimd = true) const;
+
+    /**
+     * @brief One Stats per line (index 0 = line 1) in a single pass; the query's own line filter is ignored
+     */
+    std::vector<Stats> aggregateByLine(const Query &query, int numberOfLines) const;
+
+    /**
+     * @brief One Stats per period of completion time (e.g. 3600 for hourly)
+     *
+     * Periods are aligned to multiples of periodSeconds; the first covers the query start
+     * (or the first row, if the query starts earlier) and the last covers its end (or the last row).
+     * @param firstPeriodStart Set to the start timestamp of element 0 if not null
+     */
+    std::vector<Stats> aggregateByPeriod(const Query &query, long long periodSeconds,
+                                         long long *firstPeriodStart = nullptr) const;
+
+    /// true if aggregate() and histogram() use SIMD kernels on this build
+    static bool simdAvailable();
+
+private:
+#ifdef ESP32
+    static const size_t MAX_ROWS = 1024; // ~20KB; the oldest half is dropped when full
+#else
+    static const size_t MAX_ROWS = 0;    // Unbounded
+#endif
+
+    // Layout of m_attributes
+    static const uint32_t LINE_MASK = 0x0000ffff;
+    static const int ROUTING_SHIFT = 16;
+    static const uint32_t ROUTING_MASK = 0x00ff0000;
+    static const uint32_t ABANDONED_BIT = 0x01000000;
+
+    /// Row range [begin, end) whose completion time lies in the query window
+    void rowRange(const Query &query, size_t &begin, size_t &end) const;
+    /// Attribute mask/value pair: a row matches if (attributes & mask) == value
+    static void attributeFilter(const Query &query, uint32_t &mask, uint32_t &value);
+
+    Stats aggregateRows(size_t begin, size_t end, uint32_t mask, uint32_t value, bool useSimd) const;
+    size_t histogramRows(size_t begin, size_t end, uint32_t mask, uint32_t value, double binSeconds,
+                         uint32_t *bins, size_t binCount, bool useSimd) const;
+
+    void dropOldestHalf();
+
+    std::vector<int32_t> m_entering;     // Entering timestamp
+    std::vector<int32_t> m_exiting;      // Reached the counter (or left the line)
+    std::vector<int32_t> m_completed;    // Left the system; non-decreasing
+    std::vector<float> m_expectedWait;   // Seconds, as told on arrival
+    std::vector<uint32_t> m_attributes;  // Line number | routing tag << 16 | abandoned bit
+};
@@ -0,0 +1,150 @@
+#include "ConcurrentQueueManager.h"
+#include <chrono>
+
+namespace
+{
+    const int IDLE_SPINS_BEFORE_SLEEP = 64;                      // Yields before the applier starts sleeping
+    const std::chrono::microseconds IDLE_SLEEP_INTERVAL(200);    // Applier sleep while the queue stays empty
+}
+
+ConcurrentQueueManager::ConcurrentQueueManager(int maxSize, int numberOfLines, const std::string &strategyPrefix,
+                                               const std::string &appName, const std::vector<double> &serviceRates,
+                                               size_t eventCapacity)
+    : m_manager(maxSize, numberOfLines, strategyPrefix, appName, serviceRates),
+      m_events(eventCapacity), m_batchScratch(MAX_BATCH_SIZE),
+      m_strategy(static_cast<int>(LineSelectionStrategy::SHORTEST_WAIT_TIME)), m_running(false),
+      m_submittedEvents(0), m_processedEvents(0), m_droppedEvents(0), m_snapshotVersion(0)
+{
+    publishSnapshot(0);
+}
+
+ConcurrentQueueManager::~ConcurrentQueueManager()
+{
+    stop();
+}
+
+void ConcurrentQueueManager::start()
+{
+    bool expected = false;
+    if (!m_running.compare_exchange_strong(expected, true))
+        return;
+
+    m_applierThread = std::thread([this]()
+                                  { applierLoop(); });
+}
+
+void ConcurrentQueueManager::stop()
+{
+    bool expected = true;
+    if (!m_running.compare_exchange_strong(expected, false))
+        return;
+
+    if (m_applierThread.joinable())
+    {
+        m_applierThread.join();
+    }
+}
+
+bool ConcurrentQueueManager::submit(const QueueEvent &event)
+{
+    if (!m_events.tryPush(event))
+    {
+        m_droppedEvents.fetch_add(1, std::memory_order_relaxed);
+        return false;
+    }
+    m_submittedEvents.fetch_add(1, std::memory_order_release);
+    return true;
+}
+
+void ConcurrentQueueManager::setStrategy(LineSelectionStrategy strategy)
+{
+    m_strategy.store(static_cast<int>(strategy), std::memory_order_relaxed);
+}
+
+LineSelectionStrategy ConcurrentQueueManager::getStrategy() const
+{
+    return static_cast<LineSelectionStrategy>(m_strategy.load(std::memory_order_relaxed));
+}
+
+std::shared_ptr<const QueueSnapshot> ConcurrentQueueManager::getSnapshot() const
+{
+    return std::atomic_load(&m_snapshot);
+}
+
+void ConcurrentQueueManager::flush() const
+{
+    uint64_t target = m_submittedEvents.load(std::memory_order_acquire);
+    while (m_running.load() && m_processedEvents.load(std::memory_order_acquire) < target)
+    {
+        std::this_thread::sleep_for(IDLE_SLEEP_INTERVAL);
+    }
+}
+
+void ConcurrentQueueManager::applierLoop()
+{
+    int idleSpins = 0;
+    while (true)
+    {
+        size_t count = drainBatch();
+        if (count > 0)
+        {
+            idleSpins = 0;
+            continue;
+        }
+
+        // Check after an empty drain so events submitted before stop() are still applied
+        if (!m_running.load())
+            break;
+
+        if (++idleSpins < IDLE_SPINS_BEFORE_SLEEP)
+        {
+            std::this_thread::yield();
+        }
+        else
+        {
+            std::this_thread::sleep_for(IDLE_SLEEP_INTERVAL);
+        }
+    }
+}
+
+size_t ConcurrentQueueManager::drainBatch()
+{
+    size_t count = 0;
+    while (count < m_batchScratch.size() && m_events.tryPop(m_batchScratch[count]))
+    {
+        count++;
+    }
+    if (count == 0)
+        return 0;
+
+    m_manager.applyBatch(m_batchScratch.data(), count, getStrategy());
+
+    // Publish before counting the events as processed, so flush() callers see this snapshot
+    uint64_t processed = m_processedEvents.load(std::memory_order_relaxed) + count;
+    publishSnapshot(processed);
+    m_processedEvents.store(processed, std::memory_order_release);
+    return count;
+}
+
+void ConcurrentQueueManager::publishSnapshot(uint64_t eventsApplied)
+{
+    auto snapshot = std::make_shared<QueueSnapshot>();
+    snapshot->version = ++m_snapshotVersion;
+    snapshot->eventsApplied = eventsApplied;
+    snapshot->stateVersion = m_manager.getStateVersion();
+    snapshot->totalPeople = m_manager.size();
+    snapshot->recommendedLine = m_manager.getNextLineNumber(getStrategy());
+    snapshot->lineAvailability = m_manager.getAllLineAvailability();
+
+    int numberOfLines = static_cast<int>(snapshot->lineAvailability.size());
+    snapshot->lineCounts.reserve(numberOfLines);
+    snapshot->estimatedWaitTimes.reserve(numberOfLines);
+    for (int line = 1; line <= numberOfLines; ++line)
+    {
+        snapshot->lineCounts.push_back(m_manager.getLineCount(line));
+        snapshot->estimatedWaitTimes.push_back(m_manager.getEstimatedWaitTimeForNewPerson(line));
+    }
+    snapshot->peopleSummary = m_manager.getCumulativePeopleSummary();
+
+    std::atomic_store(&m_snapshot, std::shared_ptr<const QueueSnapshot>(std::move(snapshot)));
+}
@@ -0,0 +1,135 @@
+#pragma once
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include "QueueManager.h"
+#include "QueueEvent.h"
+#include "MpscQueue.h"
+
+/**
+ * @brief Immutable picture of the queue state after one applied batch
+ *
+ * Built by the applier thread and shared read-only, so any number of readers can
+ * hold one while the applier keeps going. Vectors are indexed by line - 1.
+ */
+struct QueueSnapshot
+{
+    uint64_t version = 0;       ///< Increases by one with every published snapshot
+    uint64_t eventsApplied = 0; ///< Events taken off the ingestion queue so far (applied or rejected)
+    uint64_t stateVersion = 0;  ///< QueueManager::getStateVersion() when the snapshot was taken
+    int totalPeople = 0;
+    int recommendedLine = -1;   ///< Line for the next arrival under the current strategy (1-based, -1 = none)
+    std::vector<int> lineCounts;
+    std::vector<bool> lineAvailability;
+    std::vector<double> estimatedWaitTimes; ///< Wait until first in line for a new arrival (seconds)
+    FirebasePeopleStructureBuilder::PeopleSummary peopleSummary{0, 0, 0, 0.0, 0.0};
+
+    /// People in a line (1-based), or -1 if the line number is invalid
+    int getLineCount(int lineNumber) const
+    {
+        return lineNumber >= 1 && lineNumber <= static_cast<int>(lineCounts.size()) ? lineCounts[lineNumber - 1] : -1;
+    }
+};
+
+/**
+ * @brief Thread-safe front end for a QueueManager
+ *
+ * Producers (sensor handlers, network handlers, simulator threads) submit QueueEvents
+ * into a lock-free MPSC queue and return immediately. A single applier thread owns the
+ * QueueManager: it drains the queue in batches, applies each batch with
+ * QueueManager::applyBatch (one Firebase publish per batch) and then publishes a new
+ * QueueSnapshot. Readers call getSnapshot() and never wait on producers or on the applier.
+ *
+ * @note Events from one producer are applied in submission order; events from different
+ *       producers interleave in the order they won a queue slot
+ */
+class ConcurrentQueueManager
+{
+public:
+    static const size_t DEFAULT_EVENT_CAPACITY = 1024; ///< Pending events before submit() starts failing
+
+    /**
+     * @brief Creates the managed QueueManager (same parameters) and the ingestion queue
+     * @param eventCapacity Maximum number of pending events (rounded up to a power of two)
+     * @note The applier thread is not running until start() is called
+     */
+    ConcurrentQueueManager(int maxSize, int numberOfLines, const std::string &strategyPrefix = "",
+                           const std::string &appName = "iot-queue-management",
+                           const std::vector<double> &serviceRates = {},
+                           size_t eventCapacity = DEFAULT_EVENT_CAPACITY);
+
+    /// Stops the applier thread after applying every event already submitted
+    ~ConcurrentQueueManager();
+
+    ConcurrentQueueManager(const ConcurrentQueueManager &) = delete;
+    ConcurrentQueueManager &operator=(const ConcurrentQueueManager &) = delete;
+
+    /// Starts the applier thread (no-op if already running)
+    void start();
+
+    /// Applies all pending events, then joins the applier thread (no-op if not running)
+    void stop();
+
+    bool isRunning() const { return m_running.load(); }
+
+    // Producer API (any thread, lock-free, never blocks)
+    /**
+     * @brief Queues an event for the applier thread
+     * @return false if the ingestion queue is full and the event was dropped
+     */
+    bool submit(const QueueEvent &event);
+
+    bool submitArrival(int lineNumber = 0) { return submit(QueueEvent::arrival(lineNumber)); }
+    bool submitServiceCompletion(int lineNumber) { return submit(QueueEvent::serviceCompletion(lineNumber)); }
+    bool submitAvailabilityChange(int lineNumber, bool available) { return submit(QueueEvent::availabilityChange(lineNumber, available)); }
+    bool submitAbandonment(int personId) { return submit(QueueEvent::abandonment(personId)); }
+
+    /**
+     * @brief Sets the strategy used for routed arrivals and the published recommendation
+     * Takes effect from the next batch the applier processes
+     */
+    void setStrategy(LineSelectionStrategy strategy);
+    LineSelectionStrategy getStrategy() const;
+
+    // Reader API (any thread)
+    /**
+     * @brief Gets the most recently published state
+     * @return Shared immutable snapshot; stays valid for as long as the caller holds it
+     */
+    std::shared_ptr<const QueueSnapshot> getSnapshot() const;
+
+    /**
+     * @brief Waits until every event submitted before this call has been applied
+     * Returns immediately if the applier thread is not running
+     */
+    void flush() const;
+
+    /// Number of events rejected by submit() because the ingestion queue was full
+    uint64_t getDroppedEventCount() const { return m_droppedEvents.load(); }
+
+private:
+    static const size_t MAX_BATCH_SIZE = 64; // Events applied per applyBatch call (one publish each)
+
+    void applierLoop();
+    size_t drainBatch();
+    void publishSnapshot(uint64_t eventsApplied);
+
+    QueueManager m_manager;               // Only touched by the applier thread while running
+    MpscQueue<QueueEvent> m_events;       // Pending events from all producers
+    std::vector<QueueEvent> m_batchScratch; // Applier-owned batch buffer (MAX_BATCH_SIZE entries)
+
+    std::atomic<int> m_strategy;
+    std::atomic<bool> m_running;
+    std::thread m_applierThread;
+
+    std::atomic<uint64_t> m_submittedEvents; // Successful submit() calls
+    std::atomic<uint64_t> m_processedEvents; // Events taken off the queue by the applier
+    std::atomic<uint64_t> m_droppedEvents;
+
+    std::shared_ptr<const QueueSnapshot> m_snapshot; // Read/written only via std::atomic_load/atomic_store
+    uint64_t m_snapshotVersion;                      // Applier-owned
+};
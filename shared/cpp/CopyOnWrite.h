@@ -0,0 +1,88 @@
+#pragma once
+
+#include <atomic>
+#include <utility>
+
+/**
+ * @brief Reference-counted value that is copied only when a shared instance is modified
+ *
+ * Copies of a CopyOnWrite share one value. Reading is free; write() first checks
+ * whether this handle is the only owner and, if not, replaces its value with a private
+ * clone. A shared value is therefore never modified, which makes it safe for handles
+ * owned by different threads to share it.
+ *
+ * The owner count is checked with an acquire load that pairs with the release in the
+ * other owners' destructors, so once write() sees itself as the sole owner every read
+ * another thread made through its (now destroyed) handle is guaranteed to be finished.
+ */
+template <typename T>
+class CopyOnWrite
+{
+public:
+    /// Creates a handle that is the sole owner of `value`
+    explicit CopyOnWrite(T value) : m_node(new Node(std::move(value))) {}
+
+    CopyOnWrite(const CopyOnWrite &other) : m_node(other.m_node)
+    {
+        m_node->owners.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    CopyOnWrite(CopyOnWrite &&other) noexcept : m_node(other.m_node)
+    {
+        other.m_node = nullptr;
+    }
+
+    CopyOnWrite &operator=(CopyOnWrite other) noexcept
+    {
+        std::swap(m_node, other.m_node);
+        return *this;
+    }
+
+    ~CopyOnWrite()
+    {
+        release();
+    }
+
+    const T &operator*() const { return m_node->value; }
+    const T *operator->() const { return &m_node->value; }
+
+    /// true if no other handle shares the value
+    bool unique() const
+    {
+        return m_node->owners.load(std::memory_order_acquire) == 1;
+    }
+
+    /**
+     * @brief Gets the value for modification, unsharing it first if needed
+     * @param clone Callable (const T &) -> T producing the private copy when the value is shared
+     */
+    template <typename Clone>
+    T &write(Clone &&clone)
+    {
+        if (!unique())
+        {
+            *this = CopyOnWrite(clone(m_node->value));
+        }
+        return m_node->value;
+    }
+
+private:
+    struct Node
+    {
+        explicit Node(T &&initial) : value(std::move(initial)), owners(1) {}
+
+        T value;
+        std::atomic<long> owners;
+    };
+
+    void release()
+    {
+        if (m_node && m_node->owners.fetch_sub(1, std::memory_order_acq_rel) == 1)
+        {
+            delete m_node;
+        }
+        m_node = nullptr;
+    }
+
+    Node *m_node;
+};
@@ -0,0 +1,24 @@
+#pragma once
+
+#include <cstdint>
+
+/// Kind of customer, for lanes that only serve some of them
+enum class CustomerClass : uint8_t
+{
+    STANDARD,      ///< Regular customer (every line by default)
+    EXPRESS,       ///< Small basket (e.g. 10 items or fewer), may use express lanes
+    ACCESSIBILITY, ///< Needs an accessible counter
+    PRIORITY       ///< VIP or staff-assisted customer
+};
+
+/// Number of customer classes; per-class arrays are sized by it
+const int CUSTOMER_CLASS_COUNT = static_cast<int>(CustomerClass::PRIORITY) + 1;
+
+/// Bit of a class in a line's accepted-class mask (QueueManager::setLineClasses)
+inline uint8_t customerClassBit(CustomerClass customerClass)
+{
+    return static_cast<uint8_t>(1u << static_cast<int>(customerClass));
+}
+
+/// Mask of a line that accepts every class (the default)
+const uint8_t ALL_CUSTOMER_CLASSES = static_cast<uint8_t>((1u << CUSTOMER_CLASS_COUNT) - 1);
@@ -0,0 +1,246 @@
+#include "EventLog.h"
+#include <iostream>
+
+#if !defined(ESP32) && !defined(_WIN32)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define EVENT_LOG_HAS_MMAP 1
+#endif
+
+EventLog::EventLog()
+    : m_path(), m_fd(-1), m_mapping(nullptr), m_capacity(0)
+{
+}
+
+EventLog::~EventLog()
+{
+    close();
+}
+
+size_t EventLog::size() const
+{
+    return m_mapping ? static_cast<size_t>(header()->recordCount) : 0;
+}
+
+const EventLogRecord *EventLog::records() const
+{
+    if (!m_mapping)
+    {
+        return nullptr;
+    }
+    return reinterpret_cast<const EventLogRecord *>(static_cast<const char *>(m_mapping) + sizeof(Header));
+}
+
+void EventLog::setConfiguration(int numberOfLines, int maxSize, long long simulationStartMillis)
+{
+    if (!m_mapping)
+    {
+        return;
+    }
+    header()->numberOfLines = numberOfLines;
+    header()->maxSize = maxSize;
+    header()->simulationStartMillis = simulationStartMillis;
+}
+
+int EventLog::getNumberOfLines() const
+{
+    return m_mapping ? header()->numberOfLines : 0;
+}
+
+int EventLog::getMaxSize() const
+{
+    return m_mapping ? header()->maxSize : 0;
+}
+
+long long EventLog::getSimulationStartMillis() const
+{
+    return m_mapping ? header()->simulationStartMillis : 0;
+}
+
+#ifdef EVENT_LOG_HAS_MMAP
+
+bool EventLog::open(const std::string &path, bool truncate)
+{
+    close();
+
+    int flags = O_RDWR | O_CREAT | (truncate ? O_TRUNC : 0);
+    m_fd = ::open(path.c_str(), flags, 0644);
+    if (m_fd < 0)
+    {
+        std::cerr << "❌ Cannot open event log " << path << std::endl;
+        return false;
+    }
+    m_path = path;
+
+    struct stat fileInfo;
+    if (fstat(m_fd, &fileInfo) != 0)
+    {
+        std::cerr << "❌ Cannot stat event log " << path << std::endl;
+        close();
+        return false;
+    }
+
+    size_t fileSize = static_cast<size_t>(fileInfo.st_size);
+    if (fileSize < sizeof(Header))
+    {
+        // New (or truncated) log: create the header
+        if (!mapFile(INITIAL_CAPACITY))
+        {
+            close();
+            return false;
+        }
+        Header *newHeader = header();
+        *newHeader = Header();
+        newHeader->magic = MAGIC;
+        newHeader->formatVersion = FORMAT_VERSION;
+        newHeader->recordSize = sizeof(EventLogRecord);
+        return true;
+    }
+
+    // Existing log: validate before trusting the committed count
+    size_t capacity = (fileSize - sizeof(Header)) / sizeof(EventLogRecord);
+    if (!mapFile(capacity))
+    {
+        close();
+        return false;
+    }
+    const Header *existing = header();
+    if (existing->magic != MAGIC || existing->formatVersion != FORMAT_VERSION ||
+        existing->recordSize != sizeof(EventLogRecord) || existing->recordCount > capacity)
+    {
+        std::cerr << "❌ " << path << " is not a compatible event log" << std::endl;
+        close();
+        return false;
+    }
+
+    std::cout << "📜 Event log " << path << " opened with " << existing->recordCount << " records" << std::endl;
+    return true;
+}
+
+void EventLog::close()
+{
+    unmapFile();
+    if (m_fd >= 0)
+    {
+        ::close(m_fd);
+        m_fd = -1;
+    }
+    m_path.clear();
+}
+
+bool EventLog::append(EventLogRecord record)
+{
+    if (!m_mapping)
+    {
+        return false;
+    }
+
+    size_t count = size();
+    if (count >= m_capacity && !grow())
+    {
+        return false;
+    }
+
+    record.sequence = count;
+    EventLogRecord *slot = reinterpret_cast<EventLogRecord *>(static_cast<char *>(m_mapping) + sizeof(Header)) + count;
+    *slot = record;
+
+    // Commit only after the record is in place, so a crash never exposes a partial record
+    header()->recordCount = count + 1;
+    return true;
+}
+
+bool EventLog::sync()
+{
+    if (!m_mapping)
+    {
+        return false;
+    }
+    size_t usedBytes = sizeof(Header) + size() * sizeof(EventLogRecord);
+    return msync(m_mapping, usedBytes, MS_SYNC) == 0;
+}
+
+bool EventLog::mapFile(size_t capacity)
+{
+    size_t fileSize = sizeof(Header) + capacity * sizeof(EventLogRecord);
+    if (ftruncate(m_fd, static_cast<off_t>(fileSize)) != 0)
+    {
+        std::cerr << "❌ Cannot resize event log " << m_path << std::endl;
+        return false;
+    }
+
+    void *mapping = mmap(nullptr, fileSize, PROT_READ | PROT_WRITE, MAP_SHARED, m_fd, 0);
+    if (mapping == MAP_FAILED)
+    {
+        std::cerr << "❌ Cannot map event log " << m_path << std::endl;
+        return false;
+    }
+
+    m_mapping = mapping;
+    m_capacity = capacity;
+    return true;
+}
+
+void EventLog::unmapFile()
+{
+    if (m_mapping)
+    {
+        munmap(m_mapping, sizeof(Header) + m_capacity * sizeof(EventLogRecord));
+        m_mapping = nullptr;
+        m_capacity = 0;
+    }
+}
+
+bool EventLog::grow()
+{
+    size_t oldCapacity = m_capacity;
+    size_t newCapacity = m_capacity > 0 ? m_capacity * 2 : INITIAL_CAPACITY;
+    unmapFile();
+    if (mapFile(newCapacity))
+    {
+        return true;
+    }
+    mapFile(oldCapacity); // Keep the committed records usable
+    return false;
+}
+
+#else // No mmap (ESP32, Windows): the log cannot be opened
+
+bool EventLog::open(const std::string &path, bool)
+{
+    std::cerr << "❌ Event log " << path << " not supported on this platform (requires mmap)" << std::endl;
+    return false;
+}
+
+void EventLog::close()
+{
+    m_path.clear();
+}
+
+bool EventLog::append(EventLogRecord)
+{
+    return false;
+}
+
+bool EventLog::sync()
+{
+    return false;
+}
+
+bool EventLog::mapFile(size_t)
+{
+    return false;
+}
+
+void EventLog::unmapFile()
+{
+}
+
+bool EventLog::grow()
+{
+    return false;
+}
+
+#endif
@@ -0,0 +1,135 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+/// Kind of state change stored in an EventLogRecord
+enum class EventLogRecordType : uint8_t
+{
+    ARRIVAL = 1,             ///< Person entered lineNumber (the line assignment); value = expected wait (s)
+    BECAME_FIRST = 2,        ///< personId reached a register of lineNumber at timestamp
+    SERVICE_COMPLETION = 3,  ///< Front person of lineNumber left; value = line tracker session time (ms)
+    AVAILABILITY_CHANGE = 4, ///< Sensor health of lineNumber changed; available = new state
+    ARRIVAL_RATE_CHANGE = 5, ///< System arrival rate changed; value = arrivals per second
+    ABANDONMENT = 6,         ///< personId left lineNumber before being served, at timestamp
+    SERVICE_DEMAND = 7,      ///< Follows the ARRIVAL of personId when its service demand is not 1.0; value = demand
+    SERVER_COUNT_CHANGE = 8, ///< Registers staffed on lineNumber changed; personId = new count, value = line tracker session time (ms)
+    CUSTOMER_CLASS = 9,      ///< Follows the ARRIVAL of personId when its class is not STANDARD; value = CustomerClass
+    LINE_CLASSES_CHANGE = 10, ///< Classes served by lineNumber changed; value = customerClassBit() mask
+    MOVE = 11                 ///< personId moved to the back of lineNumber (failover); value = new expected wait (s)
+};
+
+/**
+ * @brief One fixed-size (32 byte) entry of the QueueManager event log
+ *
+ * Plain data with an explicit layout, so the log file can be mapped and read
+ * back directly (same-endian machines) by the replay engine or offline tools.
+ */
+struct EventLogRecord
+{
+    uint64_t sequence;       ///< Position in the log, starting at 0
+    int64_t timestamp;       ///< Seconds since simulation start (same scale as Person timestamps)
+    double value;            ///< Type-specific payload (see EventLogRecordType)
+    int32_t personId;        ///< Person concerned, 0 for line/system events
+    EventLogRecordType type;
+    uint8_t available;       ///< AVAILABILITY_CHANGE only: 1 = available, 0 = unavailable
+    uint16_t lineNumber;     ///< 1-based line, 0 for system-wide events
+};
+
+static_assert(sizeof(EventLogRecord) == 32, "EventLogRecord must stay 32 bytes (on-disk format)");
+
+/**
+ * @brief Append-only binary log of EventLogRecords in a memory-mapped file
+ *
+ * The file is a 64-byte header followed by a dense array of records. append() writes
+ * the record into the mapping and only then bumps the committed count in the header,
+ * so after a process crash the file always holds a consistent prefix. The mapping
+ * grows by doubling (ftruncate + remap). sync() flushes to disk for power-loss safety.
+ *
+ * @note Memory mapping is only available on POSIX hosts; on ESP32 and Windows
+ *       open() reports the log as unsupported and returns false
+ */
+class EventLog
+{
+public:
+    /// Highest line count a log can describe (EventLogRecord::lineNumber is 16 bits)
+    static const int MAX_LINES = UINT16_MAX;
+
+    EventLog();
+    ~EventLog();
+
+    EventLog(const EventLog &) = delete;
+    EventLog &operator=(const EventLog &) = delete;
+
+    /**
+     * @brief Opens (or creates) a log file and maps it
+     * @param path File to open
+     * @param truncate true to discard any existing records
+     * @return true on success, false if the file is unusable or has a foreign format
+     */
+    bool open(const std::string &path, bool truncate = false);
+
+    /// Unmaps and closes the file (committed records stay on disk)
+    void close();
+
+    bool isOpen() const { return m_mapping != nullptr; }
+
+    /**
+     * @brief Appends one record; its sequence field is assigned by the log
+     * @return false if the log is not open or could not grow
+     */
+    bool append(EventLogRecord record);
+
+    /// Flushes the mapping to disk (blocking)
+    bool sync();
+
+    /// Number of committed records
+    size_t size() const;
+    bool empty() const { return size() == 0; }
+
+    /// Committed records (pointer + count, valid until the next append or close)
+    const EventLogRecord *records() const;
+    const EventLogRecord &operator[](size_t index) const { return records()[index]; }
+
+    /**
+     * @brief Stores the configuration of the QueueManager writing this log
+     * Replay uses it to check that the target manager has a compatible layout
+     * @param simulationStartMillis Person::getSimulationStartTime() of the writer, to map timestamps to wall-clock time
+     */
+    void setConfiguration(int numberOfLines, int maxSize, long long simulationStartMillis);
+    int getNumberOfLines() const;
+    int getMaxSize() const;
+    long long getSimulationStartMillis() const;
+
+    const std::string &getPath() const { return m_path; }
+
+private:
+    struct Header
+    {
+        uint64_t magic;
+        uint32_t formatVersion;
+        uint32_t recordSize;
+        int32_t numberOfLines;
+        int32_t maxSize;
+        int64_t simulationStartMillis;
+        uint64_t recordCount; ///< Committed records; written after the record itself
+        uint8_t reserved[24];
+    };
+    static_assert(sizeof(Header) == 64, "EventLog header must stay 64 bytes (on-disk format)");
+
+    static const uint64_t MAGIC = 0x31474F4C56454D51ULL; // "QMEVLOG1"
+    static const uint32_t FORMAT_VERSION = 1;
+    static const size_t INITIAL_CAPACITY = 4096; // Records (128KB) before the first growth
+
+    bool mapFile(size_t capacity);
+    void unmapFile();
+    bool grow();
+
+    Header *header() const { return static_cast<Header *>(m_mapping); }
+
+    std::string m_path;
+    int m_fd;
+    void *m_mapping;
+    size_t m_capacity; // Records that fit in the current mapping
+};
@@ -0,0 +1,88 @@
+#pragma once
+
+#include <cstddef>
+#include <vector>
+
+/**
+ * @brief Fenwick (binary indexed) tree of values over slots 0..n-1
+ *
+ * add() and prefix sums are O(log n). Used to count marked slots before a
+ * position without scanning, e.g. abandoned entries ahead of someone in a line,
+ * and (with non-negative weights) to sample a slot in proportion to its weight.
+ */
+template <typename T>
+class BasicFenwickTree
+{
+public:
+    explicit BasicFenwickTree(size_t slotCount = 0) { reset(slotCount); }
+
+    /// Sets all values to zero over slots 0..slotCount-1
+    void reset(size_t slotCount) { m_tree.assign(slotCount + 1, T()); }
+
+    /// Rebuilds the tree from slotCount values in O(n) (also clears accumulated rounding for floating point)
+    void assign(const T *values, size_t slotCount)
+    {
+        m_tree.assign(slotCount + 1, T());
+        for (size_t i = 1; i <= slotCount; ++i)
+        {
+            m_tree[i] += values[i - 1];
+            size_t parent = i + (i & (~i + 1));
+            if (parent <= slotCount)
+                m_tree[parent] += m_tree[i];
+        }
+    }
+
+    size_t size() const { return m_tree.size() - 1; }
+
+    /// Adds `delta` to the value of `slot`
+    void add(size_t slot, T delta)
+    {
+        for (size_t i = slot + 1; i < m_tree.size(); i += i & (~i + 1))
+            m_tree[i] += delta;
+    }
+
+    /// Sum of the values of slots 0..end-1
+    T prefixSum(size_t end) const
+    {
+        T sum = T();
+        for (size_t i = end; i > 0; i -= i & (~i + 1))
+            sum += m_tree[i];
+        return sum;
+    }
+
+    /// Sum of the values of slots begin..end-1
+    T rangeSum(size_t begin, size_t end) const { return prefixSum(end) - prefixSum(begin); }
+
+    /// Value of one slot
+    T at(size_t slot) const { return rangeSum(slot, slot + 1); }
+
+    /// Sum of every slot
+    T total() const { return prefixSum(size()); }
+
+    /**
+     * @brief First slot whose running sum exceeds target (values must be non-negative)
+     * @return Slot in 0..n-1, or n if target >= total()
+     */
+    size_t upperBound(T target) const
+    {
+        size_t position = 0;
+        size_t step = 1;
+        while (step * 2 < m_tree.size())
+            step *= 2;
+        for (; step > 0; step /= 2)
+        {
+            if (position + step < m_tree.size() && !(target < m_tree[position + step]))
+            {
+                position += step;
+                target -= m_tree[position];
+            }
+        }
+        return position;
+    }
+
+private:
+    std::vector<T> m_tree; // 1-based implicit tree, m_tree[0] unused
+};
+
+/// Integer counts (tombstones in PersonLocationIndex)
+using FenwickTree = BasicFenwickTree<int>;
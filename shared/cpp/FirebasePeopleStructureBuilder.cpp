@@ -13,7 +13,10 @@ std::string FirebasePeopleStructureBuilder::generatePersonDataJson(const PersonD
          << "\"exitingTimestamp\":" << personData.exitingTimestamp << ","
          << "\"lineNumber\":" << personData.lineNumber << ","
          << "\"actualWaitTime\":" << std::fixed << std::setprecision(2) << personData.actualWaitTime << ","
-         << "\"hasExited\":" << (personData.exitingTimestamp != 0 ? "true" : "false")
+         << "\"hasExited\":" << (personData.exitingTimestamp != 0 ? "true" : "false") << ","
+         << "\"hasAbandoned\":" << (personData.abandoned ? "true" : "false") << ","
+         << "\"position\":" << personData.position << ","
+         << "\"remainingWait\":" << std::fixed << std::setprecision(2) << personData.remainingWait
          << "}";
     return json.str();
 }
@@ -25,6 +28,7 @@ std::string FirebasePeopleStructureBuilder::generatePeopleSummaryJson(const Peop
          << "\"totalPeople\":" << summary.totalPeople << ","
          << "\"activePeople\":" << summary.activePeople << ","
          << "\"completedPeople\":" << summary.completedPeople << ","
+         << "\"abandonedPeople\":" << summary.abandonedPeople << ","
          << "\"historicalAvgExpectedWait\":" << std::fixed << std::setprecision(2) << summary.historicalAvgExpectedWait << ","
          << "\"historicalAvgActualWait\":" << std::fixed << std::setprecision(2) << summary.historicalAvgActualWait << ","
          << "\"lastUpdated\":\"" << summary.lastUpdated << "\""
@@ -47,6 +51,7 @@ FirebasePeopleStructureBuilder::PeopleSummary FirebasePeopleStructureBuilder::cr
     int totalPeople = static_cast<int>(allPeople.size());
     int activePeople = 0;
     int completedPeople = 0;
+    int abandonedPeople = 0;
     double totalExpectedWait = 0.0;
     double totalActualWait = 0.0;
 
@@ -54,7 +59,11 @@ FirebasePeopleStructureBuilder::PeopleSummary FirebasePeopleStructureBuilder::cr
     {
         totalExpectedWait += person.getExpectedWaitTime();
         
-        if (person.hasExited())
+        if (person.hasAbandoned())
+        {
+            abandonedPeople++;
+        }
+        else if (person.hasExited())
         {
             completedPeople++;
             totalActualWait += person.getActualWaitTime();
@@ -68,7 +77,7 @@ FirebasePeopleStructureBuilder::PeopleSummary FirebasePeopleStructureBuilder::cr
     double averageExpectedWait = totalPeople > 0 ? totalExpectedWait / totalPeople : 0.0;
     double averageActualWait = completedPeople > 0 ? totalActualWait / completedPeople : 0.0;
 
-    return PeopleSummary(totalPeople, activePeople, completedPeople, averageExpectedWait, averageActualWait);
+    return PeopleSummary(totalPeople, activePeople, completedPeople, averageExpectedWait, averageActualWait, abandonedPeople);
 }
 
 std::string FirebasePeopleStructureBuilder::getCurrentTimestamp()
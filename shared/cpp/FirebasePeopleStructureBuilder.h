@@ -25,14 +25,20 @@ public:
         long long exitingTimestamp;
         int lineNumber;
         double actualWaitTime;
+        bool abandoned;
+        int position;         // Place in line (1 = at the counter), 0 if not waiting
+        double remainingWait; // Seconds until reaching the counter, -1 if not waiting
 
-        PersonData(const Person& person)
+        PersonData(const Person& person, int linePosition = 0, double remainingWaitTime = -1.0)
             : personId(person.getId())
             , expectedWaitTime(person.getExpectedWaitTime())
             , enteringTimestamp(person.getEnteringTimestamp())
             , exitingTimestamp(person.getExitingTimestamp())
             , lineNumber(person.getLineNumber())
             , actualWaitTime(person.getActualWaitTime())
+            , abandoned(person.hasAbandoned())
+            , position(linePosition)
+            , remainingWait(remainingWaitTime)
         {}
     };
 
@@ -41,25 +47,26 @@ public:
         int totalPeople;
         int activePeople;                    // People still in queue
         int completedPeople;                 // People who have exited
+        int abandonedPeople;                 // People who left before being served (not in completedPeople)
         double historicalAvgExpectedWait;    // Average of what people were told they'd wait
         double historicalAvgActualWait;      // Average of what people actually waited (completed only)
         std::string lastUpdated;
 
-        PeopleSummary(int total, int active, int completed, double avgExpected, double avgActual)
-            : totalPeople(total), activePeople(active), completedPeople(completed)
+        PeopleSummary(int total, int active, int completed, double avgExpected, double avgActual, int abandoned = 0)
+            : totalPeople(total), activePeople(active), completedPeople(completed), abandonedPeople(abandoned)
             , historicalAvgExpectedWait(avgExpected), historicalAvgActualWait(avgActual)
             , lastUpdated(getCurrentTimestamp()) {}
     };
 
     /**
      * Generate JSON for individual person data
-     * Structure: { personId, expectedWaitTime, enteringTimestamp, exitingTimestamp, lineNumber, actualWaitTime, hasExited }
+     * Structure: { personId, expectedWaitTime, enteringTimestamp, exitingTimestamp, lineNumber, actualWaitTime, hasExited, hasAbandoned, position, remainingWait }
      */
     static std::string generatePersonDataJson(const PersonData& personData);
 
     /**
      * Generate JSON for people summary data
-     * Structure: { totalPeople, activePeople, completedPeople, historicalAvgExpectedWait, historicalAvgActualWait, lastUpdated }
+     * Structure: { totalPeople, activePeople, completedPeople, abandonedPeople, historicalAvgExpectedWait, historicalAvgActualWait, lastUpdated }
      */
     static std::string generatePeopleSummaryJson(const PeopleSummary& summary);
 
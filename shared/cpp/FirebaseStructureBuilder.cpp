@@ -26,6 +26,20 @@ std::string FirebaseStructureBuilder::generateAggregatedDataJson(const Aggregate
     return json.str();
 }
 
+std::string FirebaseStructureBuilder::generateRebalanceJson(const RebalanceData &rebalanceData)
+{
+    std::ostringstream json;
+    json << "{\n";
+    json << "  \"fromLine\": " << rebalanceData.fromLine << ",\n";
+    json << "  \"toLine\": " << rebalanceData.toLine << ",\n";
+    json << "  \"people\": " << rebalanceData.people << ",\n";
+    json << "  \"firstPosition\": " << rebalanceData.firstPosition << ",\n";
+    json << "  \"gainSeconds\": " << std::fixed << std::setprecision(2) << rebalanceData.gainSeconds << ",\n";
+    json << "  \"lastUpdated\": \"" << getCurrentTimestamp() << "\"\n";
+    json << "}";
+    return json.str();
+}
+
 std::string FirebaseStructureBuilder::getLineDataPath(int lineNumber)
 {
     return "queues/line" + std::to_string(lineNumber);
@@ -36,6 +50,11 @@ std::string FirebaseStructureBuilder::getAggregatedDataPath()
     return "recommendedChoice";
 }
 
+std::string FirebaseStructureBuilder::getRebalanceDataPath()
+{
+    return "rebalance";
+}
+
 std::string FirebaseStructureBuilder::getCurrentTimestamp()
 {
     auto now = std::chrono::system_clock::now();
@@ -43,6 +43,18 @@ public:
               recommendedLineEstWaitTime(waitTime), recommendedLineQueueLength(occupancy) {}
     };
 
+    struct RebalanceData
+    {
+        int fromLine;
+        int toLine;
+        int people; // 0 = no move recommended any more
+        int firstPosition;
+        double gainSeconds;
+
+        RebalanceData(int from, int to, int count, int position, double gain)
+            : fromLine(from), toLine(to), people(count), firstPosition(position), gainSeconds(gain) {}
+    };
+
     /**
      * Generate JSON for queue line data (what you'd see if you joined this line right now)
      * Structure: { queueLength, serviceRatePeoplePerSec, estimatedWaitForNewPerson, lastUpdated, lineNumber }
@@ -55,6 +67,12 @@ public:
      */
     static std::string generateAggregatedDataJson(const AggregatedData &aggData);
 
+    /**
+     * Generate JSON for rebalancing advice (move the last people of one line to another)
+     * Structure: { fromLine, toLine, people, firstPosition, gainSeconds, lastUpdated }
+     */
+    static std::string generateRebalanceJson(const RebalanceData &rebalanceData);
+
     /**
      * Get the Firebase path for a specific line
      * Returns: "queues/line{lineNumber}"
@@ -67,6 +85,12 @@ public:
      */
     static std::string getAggregatedDataPath();
 
+    /**
+     * Get the Firebase path for rebalancing advice
+     * Returns: "rebalance"
+     */
+    static std::string getRebalanceDataPath();
+
     /**
      * Create AggregatedData with recommended line and duplicated wait time/occupancy info
      * Uses the provided recommendedLine (from actual strategy selection)
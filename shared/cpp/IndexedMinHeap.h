@@ -0,0 +1,131 @@
+#pragma once
+
+#include <cstddef>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Binary min-heap over a fixed id range (0..n-1) with in-place key updates
+ *
+ * Every id is either in the heap with one key or absent. update() inserts or
+ * re-keys an id and remove() drops it, both in O(log n); top() is O(1).
+ * Ties on key are broken by the lower id, which matches the "first line wins"
+ * behaviour of a left-to-right linear scan.
+ */
+class IndexedMinHeap
+{
+public:
+    explicit IndexedMinHeap(size_t idCount = 0) { resize(idCount); }
+
+    /// Resets the heap to an empty state able to hold ids 0..idCount-1
+    void resize(size_t idCount)
+    {
+        m_heap.clear();
+        m_heap.reserve(idCount);
+        m_positions.assign(idCount, NOT_IN_HEAP);
+        m_keys.assign(idCount, 0.0);
+    }
+
+    bool empty() const { return m_heap.empty(); }
+    size_t size() const { return m_heap.size(); }
+    bool contains(size_t id) const { return id < m_positions.size() && m_positions[id] != NOT_IN_HEAP; }
+
+    /// Id with the smallest key (heap must not be empty)
+    size_t top() const { return m_heap.front(); }
+    double topKey() const { return m_keys[m_heap.front()]; }
+    double key(size_t id) const { return m_keys[id]; }
+
+    /// Inserts `id` with `key`, or moves it to its new position if already present
+    void update(size_t id, double key)
+    {
+        if (id >= m_positions.size())
+            return;
+
+        if (m_positions[id] == NOT_IN_HEAP)
+        {
+            m_keys[id] = key;
+            m_positions[id] = m_heap.size();
+            m_heap.push_back(id);
+            siftUp(m_positions[id]);
+            return;
+        }
+
+        double oldKey = m_keys[id];
+        m_keys[id] = key;
+        if (key < oldKey)
+            siftUp(m_positions[id]);
+        else
+            siftDown(m_positions[id]);
+    }
+
+    /// Removes `id` if present
+    void remove(size_t id)
+    {
+        if (!contains(id))
+            return;
+
+        size_t position = m_positions[id];
+        size_t lastId = m_heap.back();
+        m_heap[position] = lastId;
+        m_positions[lastId] = position;
+        m_heap.pop_back();
+        m_positions[id] = NOT_IN_HEAP;
+
+        if (position < m_heap.size())
+        {
+            siftUp(position);
+            siftDown(m_positions[lastId]);
+        }
+    }
+
+private:
+    static constexpr size_t NOT_IN_HEAP = static_cast<size_t>(-1);
+
+    bool less(size_t a, size_t b) const
+    {
+        return m_keys[a] < m_keys[b] || (m_keys[a] == m_keys[b] && a < b);
+    }
+
+    void place(size_t position, size_t id)
+    {
+        m_heap[position] = id;
+        m_positions[id] = position;
+    }
+
+    void siftUp(size_t position)
+    {
+        size_t id = m_heap[position];
+        while (position > 0)
+        {
+            size_t parent = (position - 1) / 2;
+            if (!less(id, m_heap[parent]))
+                break;
+            place(position, m_heap[parent]);
+            position = parent;
+        }
+        place(position, id);
+    }
+
+    void siftDown(size_t position)
+    {
+        size_t id = m_heap[position];
+        size_t count = m_heap.size();
+        while (true)
+        {
+            size_t child = 2 * position + 1;
+            if (child >= count)
+                break;
+            if (child + 1 < count && less(m_heap[child + 1], m_heap[child]))
+                child++;
+            if (!less(m_heap[child], id))
+                break;
+            place(position, m_heap[child]);
+            position = child;
+        }
+        place(position, id);
+    }
+
+    std::vector<size_t> m_heap;      ///< Heap-ordered ids
+    std::vector<size_t> m_positions; ///< Position of each id in m_heap, or NOT_IN_HEAP
+    std::vector<double> m_keys;      ///< Current key of each id
+};
@@ -0,0 +1,28 @@
+#pragma once
+
+#include <cstdint>
+
+/// Line selection strategies for queue management
+enum class LineSelectionStrategy
+{
+    SHORTEST_WAIT_TIME,     ///< Selects line with shortest estimated wait time (considers queue length + throughput)
+    FEWEST_PEOPLE,          ///< Simply chooses line with fewest people (ignores throughput differences)
+    FARTHEST_FROM_ENTRANCE, ///< Chooses line where last person is farthest from entrance (assumes higher line numbers = farther)
+    NEAREST_TO_ENTRANCE,    ///< Chooses line where last person is nearest to entrance (assumes lower line numbers = nearer)
+    ADAPTIVE,               ///< FEWEST_PEOPLE until every line has reliable throughput data, then SHORTEST_WAIT_TIME
+    SHORTEST_WORKLOAD,      ///< Least outstanding service demand per throughput (uses each person's service demand hint)
+    LOOKAHEAD,              ///< Projects lines a short horizon ahead (pending recommendations, forecast arrivals) and minimizes system-wide wait
+    WALK_AND_WAIT           ///< Least walking time plus predicted wait on reaching the line (needs QueueManager::setVenueLayout)
+};
+
+/// Number of built-in strategies; QueueManager::addStrategy assigns ids from here on
+const int BUILT_IN_STRATEGY_COUNT = static_cast<int>(LineSelectionStrategy::WALK_AND_WAIT) + 1;
+
+/**
+ * @brief Routing tag that people placed by a strategy carry (Person::getRoutingTag)
+ * @param strategy Strategy that chose the line
+ */
+inline uint8_t routingTagOf(LineSelectionStrategy strategy)
+{
+    return static_cast<uint8_t>(static_cast<int>(strategy) + 1);
+}
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <utility>
+
+/**
+ * @brief Bounded lock-free multi-producer / single-consumer queue
+ *
+ * Fixed ring of cells, each tagged with a sequence number (Vyukov's bounded queue).
+ * Producers claim a slot with one compare-and-swap on the tail and publish it by
+ * bumping the cell sequence; they never wait for each other or for the consumer.
+ * A full queue makes tryPush() fail instead of blocking, so the caller decides
+ * whether to drop, retry or count the event.
+ *
+ * Only one thread may call tryPop(); any number of threads may call tryPush().
+ */
+template <typename T>
+class MpscQueue
+{
+public:
+    /**
+     * @brief Creates a queue holding at least `capacity` elements
+     * @param capacity Requested size, rounded up to a power of two (minimum 2)
+     */
+    explicit MpscQueue(size_t capacity)
+    {
+        size_t roundedCapacity = 2;
+        while (roundedCapacity < capacity)
+            roundedCapacity *= 2;
+
+        m_capacity = roundedCapacity;
+        m_cells.reset(new Cell[m_capacity]);
+        for (size_t i = 0; i < m_capacity; ++i)
+            m_cells[i].sequence.store(i, std::memory_order_relaxed);
+        m_tail.store(0, std::memory_order_relaxed);
+        m_head = 0;
+    }
+
+    MpscQueue(const MpscQueue &) = delete;
+    MpscQueue &operator=(const MpscQueue &) = delete;
+
+    /**
+     * @brief Appends an element (safe from any thread)
+     * @return false if the queue is full
+     */
+    bool tryPush(const T &value)
+    {
+        size_t position = m_tail.load(std::memory_order_relaxed);
+        while (true)
+        {
+            Cell &cell = m_cells[position & (m_capacity - 1)];
+            size_t sequence = cell.sequence.load(std::memory_order_acquire);
+            std::ptrdiff_t difference = static_cast<std::ptrdiff_t>(sequence) - static_cast<std::ptrdiff_t>(position);
+
+            if (difference == 0)
+            {
+                // Slot is free for this lap: claim it
+                if (m_tail.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                {
+                    cell.value = value;
+                    cell.sequence.store(position + 1, std::memory_order_release);
+                    return true;
+                }
+            }
+            else if (difference < 0)
+            {
+                return false; // Consumer has not freed this slot yet: queue is full
+            }
+            else
+            {
+                position = m_tail.load(std::memory_order_relaxed); // Another producer won, retry
+            }
+        }
+    }
+
+    /**
+     * @brief Removes the oldest element (consumer thread only)
+     * @return false if the queue is empty
+     */
+    bool tryPop(T &value)
+    {
+        Cell &cell = m_cells[m_head & (m_capacity - 1)];
+        size_t sequence = cell.sequence.load(std::memory_order_acquire);
+        if (sequence != m_head + 1)
+            return false; // Empty, or a producer has claimed the slot but not finished writing
+
+        value = std::move(cell.value);
+        cell.sequence.store(m_head + m_capacity, std::memory_order_release);
+        m_head++;
+        return true;
+    }
+
+    size_t capacity() const { return m_capacity; }
+
+private:
+    static constexpr size_t CACHE_LINE_SIZE = 64;
+
+    struct Cell
+    {
+        std::atomic<size_t> sequence; ///< position when free, position + 1 when holding a value
+        T value;
+    };
+
+    std::unique_ptr<Cell[]> m_cells;
+    size_t m_capacity;
+    alignas(CACHE_LINE_SIZE) std::atomic<size_t> m_tail; ///< Next position to claim (producers)
+    alignas(CACHE_LINE_SIZE) size_t m_head;              ///< Next position to read (consumer only)
+};
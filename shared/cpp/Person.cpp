@@ -1,9 +1,9 @@
 #include "Person.h"
-#include <sstream>
-#include <iomanip>
+#include "SimulationClock.h"
+#include <cstdio>
 
 // Initialize static member
-long long Person::s_simulationStartTime = 0;
+std::atomic<long long> Person::s_simulationStartTime{0};
 
 Person::Person(double expectedWaitTime, int lineNumber)
     : m_expectedWaitTime(expectedWaitTime)
@@ -11,6 +11,23 @@ Person::Person(double expectedWaitTime, int lineNumber)
     , m_exitingTimestamp(0)
     , m_lineNumber(lineNumber)
     , m_personId(0) // Will be set by QueueManager
+    , m_abandoned(false)
+    , m_routingTag(NOT_ROUTED)
+    , m_customerClass(static_cast<uint8_t>(CustomerClass::STANDARD))
+    , m_serviceDemand(1.0f)
+{
+}
+
+Person::Person(double expectedWaitTime, int lineNumber, long long enteringTimestamp)
+    : m_expectedWaitTime(expectedWaitTime)
+    , m_enteringTimestamp(enteringTimestamp)
+    , m_exitingTimestamp(0)
+    , m_lineNumber(lineNumber)
+    , m_personId(0)
+    , m_abandoned(false)
+    , m_routingTag(NOT_ROUTED)
+    , m_customerClass(static_cast<uint8_t>(CustomerClass::STANDARD))
+    , m_serviceDemand(1.0f)
 {
 }
 
@@ -32,18 +49,42 @@ void Person::recordExit()
     }
 }
 
+void Person::recordExitAt(long long timestamp)
+{
+    if (m_exitingTimestamp == 0) // Only record exit once
+    {
+        m_exitingTimestamp = timestamp;
+    }
+}
+
+void Person::recordAbandonmentAt(long long timestamp)
+{
+    m_abandoned = true;
+    recordExitAt(timestamp);
+}
+
 std::string Person::getId() const
 {
-    std::ostringstream oss;
-    oss << "person_" << m_personId;
-    return oss.str();
+    // "person_" plus any int with its sign; IDs below 100000000 also fit the small-string
+    // buffer, so the usual case does not touch the heap
+    char buffer[20];
+    std::snprintf(buffer, sizeof(buffer), "person_%d", m_personId);
+    return std::string(buffer);
 }
 
 void Person::setSimulationStartTime()
 {
-    auto now = std::chrono::system_clock::now();
-    auto duration = now.time_since_epoch();
-    s_simulationStartTime = std::chrono::duration_cast<std::chrono::milliseconds>(duration).count();
+    s_simulationStartTime.store(SimulationClock::systemMillis(), std::memory_order_release);
+}
+
+void Person::setSimulationStartTime(long long startMillis)
+{
+    s_simulationStartTime.store(startMillis, std::memory_order_release);
+}
+
+long long Person::getSimulationStartTime()
+{
+    return s_simulationStartTime.load(std::memory_order_acquire);
 }
 
 void Person::setPersonId(int id)
@@ -53,16 +94,15 @@ void Person::setPersonId(int id)
 
 long long Person::getCurrentTimestamp()
 {
-    if (s_simulationStartTime == 0) {
-        // If simulation start time not set, set it now
-        setSimulationStartTime();
-        return 0; // First timestamp is always 0
+    long long currentMillis = SimulationClock::systemMillis();
+
+    long long startTime = s_simulationStartTime.load(std::memory_order_acquire);
+    if (startTime == 0) {
+        // If simulation start time not set, set it now (first thread to get here wins)
+        if (s_simulationStartTime.compare_exchange_strong(startTime, currentMillis, std::memory_order_acq_rel))
+            return 0; // First timestamp is always 0
     }
     
-    auto now = std::chrono::system_clock::now();
-    auto duration = now.time_since_epoch();
-    auto currentMillis = std::chrono::duration_cast<std::chrono::milliseconds>(duration).count();
-    
     // Return seconds since simulation start
-    return (currentMillis - s_simulationStartTime) / 1000;
+    return (currentMillis - startTime) / 1000;
 }
\ No newline at end of file
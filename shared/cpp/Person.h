@@ -1,7 +1,10 @@
 #pragma once
 
+#include <atomic>
 #include <chrono>
+#include <cstdint>
 #include <string>
+#include "CustomerClass.h"
 
 /**
  * @brief Represents a person in the queue system
@@ -19,6 +22,14 @@ public:
      */
     Person(double expectedWaitTime, int lineNumber);
 
+    /**
+     * @brief Reconstructs a Person with a known entering timestamp (event log replay)
+     * @param expectedWaitTime Estimated wait time when entering the queue (in seconds)
+     * @param lineNumber The line number this person is assigned to (1-based indexing)
+     * @param enteringTimestamp Recorded entering time (seconds since simulation start)
+     */
+    Person(double expectedWaitTime, int lineNumber, long long enteringTimestamp);
+
     /**
      * @brief Default constructor for containers
      */
@@ -61,18 +72,78 @@ public:
      */
     bool hasExited() const { return m_exitingTimestamp != 0; }
 
+    /**
+     * @brief Checks if this person left the line before being served (reneging)
+     * @return true if the person abandoned the queue
+     */
+    bool hasAbandoned() const { return m_abandoned; }
+
     // Setters
     /**
      * @brief Records the exit timestamp for this person
      */
     void recordExit();
 
+    /**
+     * @brief Records a known exit timestamp for this person (event log replay)
+     * @param timestamp Recorded exit time (seconds since simulation start)
+     */
+    void recordExitAt(long long timestamp);
+
+    /**
+     * @brief Marks this person as having left the line without being served
+     * @param timestamp Time they left (seconds since simulation start); kept if an exit was already recorded
+     */
+    void recordAbandonmentAt(long long timestamp);
+
     /**
      * @brief Sets the line number for this person
      * @param lineNumber New line number (1-based indexing)
      */
     void setLineNumber(int lineNumber) { m_lineNumber = lineNumber; }
 
+    /**
+     * @brief Replaces the expected wait, e.g. after moving to another line (used by QueueManager)
+     * @param expectedWaitTime Seconds from entering until reaching the counter
+     */
+    void setExpectedWaitTime(double expectedWaitTime) { m_expectedWaitTime = expectedWaitTime; }
+
+    /**
+     * @brief Gets how this person's line was chosen
+     * @return NOT_ROUTED if the line was given directly, otherwise 1 + the LineSelectionStrategy value used
+     */
+    int getRoutingTag() const { return m_routingTag; }
+
+    /**
+     * @brief Records how this person's line was chosen (used by QueueManager)
+     * @param routingTag NOT_ROUTED or 1 + the LineSelectionStrategy value used
+     */
+    void setRoutingTag(uint8_t routingTag) { m_routingTag = routingTag; }
+
+    static const uint8_t NOT_ROUTED = 0; ///< Line given directly (sensor, manual entry or replay)
+
+    /**
+     * @brief Gets the expected size of this person's service (basket or party size)
+     * @return Multiple of an average customer's service time (1.0 = average)
+     */
+    double getServiceDemand() const { return m_serviceDemand; }
+
+    /**
+     * @brief Records the expected size of this person's service (used by QueueManager)
+     * @param serviceDemand Multiple of an average customer's service time, > 0
+     */
+    void setServiceDemand(double serviceDemand) { m_serviceDemand = static_cast<float>(serviceDemand); }
+
+    /**
+     * @brief Gets the kind of customer (decides which lines may serve them)
+     */
+    CustomerClass getCustomerClass() const { return static_cast<CustomerClass>(m_customerClass); }
+
+    /**
+     * @brief Records the kind of customer (used by QueueManager)
+     */
+    void setCustomerClass(CustomerClass customerClass) { m_customerClass = static_cast<uint8_t>(customerClass); }
+
     /**
      * @brief Gets a unique identifier for this person
      * @return Unique ID string based on entering timestamp
@@ -90,24 +161,40 @@ public:
      */
     static void setSimulationStartTime();
 
+    /**
+     * @brief Sets the simulation start time to a recorded value (e.g. from an event log)
+     * @param startMillis Start time in system milliseconds since epoch
+     */
+    static void setSimulationStartTime(long long startMillis);
+
+    /**
+     * @brief Gets the simulation start time that all timestamps are relative to
+     * @return Start time in system milliseconds since epoch (0 if not started yet)
+     */
+    static long long getSimulationStartTime();
+
     /**
      * @brief Sets the person ID for this person (used by QueueManager)
      * @param id The unique ID to assign to this person
      */
     void setPersonId(int id);
 
+    /**
+     * @brief Gets current timestamp in seconds since simulation start
+     * @return Current timestamp relative to simulation start (same scale as entering/exiting timestamps)
+     */
+    static long long getCurrentTimestamp();
+
 private:
     double m_expectedWaitTime;      ///< Expected wait time when entering (seconds)
     long long m_enteringTimestamp;  ///< Timestamp when entering queue (seconds since simulation start)
     long long m_exitingTimestamp;   ///< Timestamp when exiting queue (seconds since simulation start, 0 = not exited)
     int m_lineNumber;               ///< Line number assignment (1-based indexing)
     int m_personId;                 ///< Unique person ID assigned by QueueManager
+    bool m_abandoned;               ///< Left the line before being served
+    uint8_t m_routingTag;           ///< How the line was chosen (see getRoutingTag)
+    uint8_t m_customerClass;        ///< CustomerClass value (fits the struct padding)
+    float m_serviceDemand;          ///< Expected service size, 1.0 = average customer (fits the struct padding)
 
-    /**
-     * @brief Gets current timestamp in seconds since simulation start
-     * @return Current timestamp relative to simulation start
-     */
-    static long long getCurrentTimestamp();
-
-    static long long s_simulationStartTime; ///< Start time of simulation in system milliseconds
+    static std::atomic<long long> s_simulationStartTime; ///< Start time of simulation in system milliseconds (shared by all threads)
 };
\ No newline at end of file
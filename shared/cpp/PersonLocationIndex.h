@@ -0,0 +1,384 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+#include "FenwickTree.h"
+#include "RingBuffer.h"
+
+/**
+ * @brief Maps waiting person IDs to their line and place in it
+ *
+ * Each line numbers its arrivals with a running sequence, so a person's position is
+ * their sequence minus the sequence of the entry currently at the front. QueueManager
+ * hands out IDs in increasing order, so the ID -> location table is a ring indexed by
+ * (id - lowest tracked id). Adding appends a slot; leaving clears the slot and trims
+ * the cleared prefix. Someone who waits far longer than everyone else (for example in a
+ * line that stopped serving) would pin that prefix, so once the ring spans more than
+ * four times the people waiting in it, the oldest waiting entries move to a small
+ * sorted side table of outliers and the ring trims past them. Memory is therefore
+ * bounded by the number of people waiting, not by the arrivals since the oldest one.
+ *
+ * People who abandon a line stay in it as tombstones until they reach the front. A
+ * per-line Fenwick tree counts those tombstones by sequence, so a position is still
+ * O(log n): the raw offset minus the tombstones ahead. Lines that never had an
+ * abandonment skip the tree and stay O(1).
+ *
+ * People moved to another line (failover) keep their ID: their old entry becomes a
+ * tombstone and their slot points to the back of the new line, so a line is no longer
+ * in ID order once someone moved into it.
+ *
+ * Sequences are 32-bit and compared by unsigned difference, so they may wrap.
+ */
+class PersonLocationIndex
+{
+public:
+    explicit PersonLocationIndex(int numberOfLines = 0) { reset(numberOfLines); }
+
+    /// Forgets everyone and sizes the per-line counters
+    void reset(int numberOfLines)
+    {
+        m_slots.clear();
+        m_baseId = 0;
+        m_ringWaiting = 0;
+        m_outliers.clear();
+        m_lines.assign(numberOfLines, LineSequence());
+    }
+
+    /// Ensures room for `count` tracked IDs without further growth
+    void reserve(size_t count)
+    {
+        m_slots.reserve(count);
+        m_outliers.reserve(MIN_RING_SPAN);
+    }
+
+    /**
+     * @brief Records a person joining the back of a line
+     * IDs must not decrease between calls; gaps are allowed (an older ID is ignored)
+     */
+    void add(int personId, int lineIndex)
+    {
+        if (!appendSlotFor(personId))
+        {
+            return;
+        }
+
+        LineSequence &line = m_lines[lineIndex];
+        m_slots.push_back(Location{lineIndex, line.next++});
+        m_ringWaiting++;
+        if (line.tombstones > 0 && line.next - line.front > line.tombstoneSlots.size())
+        {
+            growTombstoneWindow(line);
+        }
+    }
+
+    /**
+     * @brief Records a person already at a known place in a line (rebuilding a freshly reset index)
+     * IDs must not decrease between calls, but places may come in any order: people who moved
+     * to a line stand behind newer arrivals
+     * @param offset 0-based place from the front of the line storage
+     */
+    void addAt(int personId, int lineIndex, int offset)
+    {
+        if (!appendSlotFor(personId))
+        {
+            return;
+        }
+
+        LineSequence &line = m_lines[lineIndex];
+        uint32_t sequence = line.front + static_cast<uint32_t>(offset);
+        m_slots.push_back(Location{lineIndex, sequence});
+        m_ringWaiting++;
+        if (sequence - line.front >= line.next - line.front)
+        {
+            line.next = sequence + 1;
+        }
+    }
+
+    /**
+     * @brief Records a waiting person moving to the back of another line
+     * Their old entry stays in the old line as a tombstone until removeFront() reaches it
+     * @return false if the person is not waiting
+     */
+    bool move(int personId, int lineIndex)
+    {
+        Location *location = find(personId);
+        if (!location || location->lineIndex == NOT_WAITING)
+        {
+            return false;
+        }
+
+        addTombstone(m_lines[location->lineIndex], location->sequence);
+
+        LineSequence &line = m_lines[lineIndex];
+        location->lineIndex = lineIndex;
+        location->sequence = line.next++;
+        if (line.tombstones > 0 && line.next - line.front > line.tombstoneSlots.size())
+        {
+            growTombstoneWindow(line);
+        }
+        return true;
+    }
+
+    /**
+     * @brief Records a person leaving from the middle of their line
+     * Their entry stays in the line until removeFront() reaches it
+     * @return false if the person is not waiting
+     */
+    bool abandon(int personId)
+    {
+        Location *location = find(personId);
+        if (!location || location->lineIndex == NOT_WAITING)
+        {
+            return false;
+        }
+
+        addTombstone(m_lines[location->lineIndex], location->sequence);
+
+        leave(personId);
+        return true;
+    }
+
+    /// Records the entry at the front of a line (a person or a tombstone) leaving it
+    void removeFront(int personId, int lineIndex)
+    {
+        LineSequence &line = m_lines[lineIndex];
+        if (line.tombstones > 0 && line.tombstoneSlots.at(slotOf(line, line.front)) > 0)
+        {
+            line.tombstoneSlots.add(slotOf(line, line.front), -1);
+            line.tombstones--;
+        }
+        else
+        {
+            leave(personId);
+        }
+        line.front++;
+    }
+
+    /// 0-based line of a waiting person, or -1 if the ID is not in any line
+    int lineIndexOf(int personId) const
+    {
+        const Location *location = find(personId);
+        return location ? location->lineIndex : NOT_WAITING;
+    }
+
+    /// 0-based offset of a waiting person's entry from the front of the line storage (tombstones included), or -1
+    int offsetOf(int personId) const
+    {
+        const Location *location = find(personId);
+        if (!location || location->lineIndex == NOT_WAITING)
+        {
+            return -1;
+        }
+        return static_cast<int>(location->sequence - m_lines[location->lineIndex].front);
+    }
+
+    /// 1-based position of a waiting person among the people still in their line, or 0 if not waiting
+    int positionOf(int personId) const
+    {
+        const Location *location = find(personId);
+        if (!location || location->lineIndex == NOT_WAITING)
+        {
+            return 0;
+        }
+        const LineSequence &line = m_lines[location->lineIndex];
+        return static_cast<int>(location->sequence - line.front) - tombstonesBefore(line, location->sequence) + 1;
+    }
+
+    /// Tombstones still stored in a line
+    int tombstoneCount(int lineIndex) const { return static_cast<int>(m_lines[lineIndex].tombstones); }
+
+private:
+    struct Location
+    {
+        int32_t lineIndex; ///< 0-based line, NOT_WAITING once the person left
+        uint32_t sequence; ///< Arrival number within the line
+    };
+
+    struct LineSequence
+    {
+        uint32_t front = 0;          ///< Sequence of the entry at the front
+        uint32_t next = 0;           ///< Sequence the next arrival gets
+        uint32_t tombstones = 0;     ///< Abandoned entries not yet removed
+        FenwickTree tombstoneSlots;  ///< Tombstones by sequence modulo a power-of-two window; empty until the first abandonment
+    };
+
+    static const int32_t NOT_WAITING = -1;
+    static const size_t MIN_TOMBSTONE_WINDOW = 16;
+    static const size_t MIN_RING_SPAN = 64;   ///< Ring span below which outliers are never set aside
+
+    struct Outlier
+    {
+        int personId;
+        Location location;
+    };
+
+    static size_t slotOf(const LineSequence &line, uint32_t sequence)
+    {
+        return sequence & (line.tombstoneSlots.size() - 1);
+    }
+
+    static void addTombstone(LineSequence &line, uint32_t sequence)
+    {
+        if (line.next - line.front > line.tombstoneSlots.size())
+        {
+            growTombstoneWindow(line);
+        }
+        line.tombstoneSlots.add(slotOf(line, sequence), 1);
+        line.tombstones++;
+    }
+
+    static int tombstonesBefore(const LineSequence &line, uint32_t sequence)
+    {
+        if (line.tombstones == 0)
+        {
+            return 0;
+        }
+        size_t begin = slotOf(line, line.front), end = slotOf(line, sequence);
+        if (begin <= end)
+        {
+            return line.tombstoneSlots.rangeSum(begin, end);
+        }
+        return line.tombstoneSlots.rangeSum(begin, line.tombstoneSlots.size()) + line.tombstoneSlots.prefixSum(end);
+    }
+
+    /// Doubles the window until it covers every stored sequence of the line, keeping the tombstones
+    static void growTombstoneWindow(LineSequence &line)
+    {
+        size_t span = line.next - line.front;
+        size_t window = line.tombstoneSlots.size() > 0 ? line.tombstoneSlots.size() : MIN_TOMBSTONE_WINDOW;
+        while (window < span)
+        {
+            window *= 2;
+        }
+
+        FenwickTree resized(window);
+        if (line.tombstones > 0)
+        {
+            // Only sequences inside the old window can hold tombstones (the newest arrival never does)
+            size_t covered = span < line.tombstoneSlots.size() ? span : line.tombstoneSlots.size();
+            for (uint32_t sequence = line.front; sequence != line.front + covered; ++sequence)
+            {
+                int count = line.tombstoneSlots.at(slotOf(line, sequence));
+                if (count > 0)
+                {
+                    resized.add(sequence & (window - 1), count);
+                }
+            }
+        }
+        line.tombstoneSlots = resized;
+    }
+
+    /// Starts the ring at or pads it up to personId; false if the ID is older than the ring's end
+    bool appendSlotFor(int personId)
+    {
+        if (m_slots.empty())
+        {
+            m_baseId = personId;
+        }
+        int end = m_baseId + static_cast<int>(m_slots.size());
+        if (personId < end)
+        {
+            return false;
+        }
+
+        // A gap far wider than the people in the ring (rebuilding behind an outlier) would
+        // only be trimmed again: set them aside and restart the ring at the new ID
+        size_t gap = static_cast<size_t>(personId - end);
+        if (gap > MIN_RING_SPAN && gap > 4 * m_ringWaiting)
+        {
+            for (size_t i = 0; i < m_slots.size(); ++i)
+            {
+                if (m_slots[i].lineIndex != NOT_WAITING)
+                {
+                    m_outliers.push_back(Outlier{m_baseId + static_cast<int>(i), m_slots[i]});
+                }
+            }
+            m_slots.clear();
+            m_ringWaiting = 0;
+            m_baseId = personId;
+        }
+        while (m_baseId + static_cast<int>(m_slots.size()) < personId)
+        {
+            m_slots.push_back(Location{NOT_WAITING, 0});
+        }
+        return true;
+    }
+
+    /// Forgets a person who is no longer in any line
+    void leave(int personId)
+    {
+        if (personId < m_baseId)
+        {
+            std::vector<Outlier>::const_iterator outlier = findOutlier(personId);
+            if (outlier != m_outliers.end())
+            {
+                m_outliers.erase(outlier);
+            }
+            return;
+        }
+
+        Location *location = find(personId);
+        if (location && location->lineIndex != NOT_WAITING)
+        {
+            location->lineIndex = NOT_WAITING;
+            m_ringWaiting--;
+        }
+        trim();
+    }
+
+    /// Drops the cleared prefix, setting waiting entries aside while the ring is mostly cleared
+    void trim()
+    {
+        while (!m_slots.empty())
+        {
+            const Location &front = m_slots.front();
+            if (front.lineIndex != NOT_WAITING)
+            {
+                if (m_slots.size() <= MIN_RING_SPAN || m_slots.size() <= 4 * m_ringWaiting)
+                {
+                    break;
+                }
+                // Outliers leave the ring in ID order, so the side table stays sorted
+                m_outliers.push_back(Outlier{m_baseId, front});
+                m_ringWaiting--;
+            }
+            m_slots.pop_front();
+            m_baseId++;
+        }
+    }
+
+    std::vector<Outlier>::const_iterator findOutlier(int personId) const
+    {
+        std::vector<Outlier>::const_iterator outlier = std::lower_bound(
+            m_outliers.begin(), m_outliers.end(), personId,
+            [](const Outlier &entry, int id) { return entry.personId < id; });
+        return outlier != m_outliers.end() && outlier->personId == personId ? outlier : m_outliers.end();
+    }
+
+    const Location *find(int personId) const
+    {
+        if (personId < m_baseId)
+        {
+            std::vector<Outlier>::const_iterator outlier = findOutlier(personId);
+            return outlier != m_outliers.end() ? &outlier->location : nullptr;
+        }
+        if (personId - m_baseId >= static_cast<int>(m_slots.size()))
+        {
+            return nullptr;
+        }
+        return &m_slots[static_cast<size_t>(personId - m_baseId)];
+    }
+
+    Location *find(int personId)
+    {
+        return const_cast<Location *>(static_cast<const PersonLocationIndex *>(this)->find(personId));
+    }
+
+    RingBuffer<Location> m_slots;    // Slot i describes person m_baseId + i
+    int m_baseId;                    // Lowest ID in the ring
+    size_t m_ringWaiting;            // Slots in the ring that still hold someone
+    std::vector<Outlier> m_outliers; // Waiting people below m_baseId, sorted by ID
+    std::vector<LineSequence> m_lines;
+};
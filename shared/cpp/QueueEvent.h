@@ -0,0 +1,50 @@
+#pragma once
+
+#include "CustomerClass.h"
+
+/**
+ * @brief A single state change fed to QueueManager::applyBatch
+ *
+ * Events are small value types so a burst (several sensor edges, one simulator tick)
+ * can be collected in a plain array and applied together with a single cloud publish.
+ */
+struct QueueEvent
+{
+    enum class Type
+    {
+        ARRIVAL,             ///< New person; lineNumber 0 = choose a line by strategy
+        SERVICE_COMPLETION,  ///< Front person of lineNumber has been served
+        AVAILABILITY_CHANGE, ///< Sensor of lineNumber changed health (see available)
+        ABANDONMENT,         ///< Person personId left their line before being served
+        SERVER_COUNT_CHANGE  ///< Registers staffed on lineNumber changed (see serverCount)
+    };
+
+    Type type;
+    int lineNumber; ///< Target line (1-based indexing), 0 for strategy-routed arrivals
+    bool available; ///< New availability, AVAILABILITY_CHANGE only
+    int personId;   ///< Person concerned, ABANDONMENT only
+    float serviceDemand; ///< Expected service size (1.0 = average customer), ARRIVAL only
+    int serverCount;     ///< New number of staffed registers, SERVER_COUNT_CHANGE only
+    CustomerClass customerClass; ///< Kind of customer, ARRIVAL only
+
+    QueueEvent(Type eventType = Type::ARRIVAL, int line = 0, bool isAvailable = true, int person = 0,
+               float demand = 1.0f)
+        : type(eventType), lineNumber(line), available(isAvailable), personId(person), serviceDemand(demand), serverCount(1),
+          customerClass(CustomerClass::STANDARD) {}
+
+    static QueueEvent arrival(int line = 0, float serviceDemand = 1.0f, CustomerClass customerClass = CustomerClass::STANDARD)
+    {
+        QueueEvent event(Type::ARRIVAL, line, true, 0, serviceDemand);
+        event.customerClass = customerClass;
+        return event;
+    }
+    static QueueEvent serviceCompletion(int line) { return QueueEvent(Type::SERVICE_COMPLETION, line); }
+    static QueueEvent availabilityChange(int line, bool isAvailable) { return QueueEvent(Type::AVAILABILITY_CHANGE, line, isAvailable); }
+    static QueueEvent abandonment(int person) { return QueueEvent(Type::ABANDONMENT, 0, true, person); }
+    static QueueEvent serverCountChange(int line, int servers)
+    {
+        QueueEvent event(Type::SERVER_COUNT_CHANGE, line);
+        event.serverCount = servers;
+        return event;
+    }
+};
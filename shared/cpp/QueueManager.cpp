@@ -5,6 +5,8 @@
 #include "FirebasePeopleStructureBuilder.h"
 #include "ThroughputTracker.h"
 #include "Person.h"
+#include "BinaryCodec.h"
+#include <cstdio>
 #include <cstring>
 #include <iostream>
 #include <iomanip>
@@ -14,37 +16,139 @@
 #include <chrono>
 
 // Constants
-static const long long ONE_HOUR_MS = 60 * 60 * 1000; // One hour in milliseconds
+static const long long ONE_HOUR_SECONDS = 60 * 60; // One hour in Person timestamp units (seconds)
+static const uint32_t SNAPSHOT_MAGIC = 0x53534D51;  // "QMSS"
+static const uint16_t SNAPSHOT_FORMAT_VERSION = 6; // 2: abandonment counts and flags, 3: service demand, 4: staffed registers,
+                                                   // 5: customer classes, 6: service demand served
 
-QueueManager::QueueManager(int maxSize, int numberOfLines, const std::string &strategyPrefix,
-                           const std::string &appName, const std::vector<double> &serviceRates)
-    : m_maxSize(maxSize), m_numberOfLines(numberOfLines), m_totalPeople(0), m_lines(),
-      m_firebaseClient(nullptr), m_strategyPrefix(strategyPrefix), m_throughputTrackers(),
-      m_expectedServiceRates(), m_currentArrivalRate(0.5), // Default arrival rate from simulations
-      m_totalPeopleEver(0), m_completedPeopleEver(0), m_totalExpectedWaitTime(0.0), m_totalActualWaitTime(0.0),
-      m_lastSelectedLine(-1), m_nextPersonId(1) // Each QueueManager starts its own ID counter at 1
+// Snapshot encoding of one person
+static const size_t SNAPSHOT_PERSON_BYTES = 38;
+static const uint8_t SNAPSHOT_PERSON_ABANDONED = 0x01;
+static const int SNAPSHOT_PERSON_ROUTING_SHIFT = 1; // Routing tag in the upper 7 bits of the flags byte
+
+static void writePerson(BinaryWriter &writer, const Person &person)
+{
+    writer.write<int32_t>(person.getPersonId());
+    writer.write<int32_t>(person.getLineNumber());
+    writer.write<double>(person.getExpectedWaitTime());
+    writer.write<int64_t>(person.getEnteringTimestamp());
+    writer.write<int64_t>(person.getExitingTimestamp());
+    writer.write<uint8_t>(static_cast<uint8_t>((person.hasAbandoned() ? SNAPSHOT_PERSON_ABANDONED : 0) |
+                                               (person.getRoutingTag() << SNAPSHOT_PERSON_ROUTING_SHIFT)));
+    writer.write<float>(static_cast<float>(person.getServiceDemand()));
+    writer.write<uint8_t>(static_cast<uint8_t>(person.getCustomerClass()));
+}
+
+static bool readPerson(BinaryReader &reader, Person &person)
 {
-    // Initialize simulation time to start from 0 (only once globally)
-    static bool timeInitialized = false;
-    if (!timeInitialized)
+    int32_t personId = 0, lineNumber = 0;
+    double expectedWaitTime = 0.0;
+    int64_t entering = 0, exiting = 0;
+    uint8_t flags = 0;
+    float serviceDemand = 1.0f;
+    uint8_t customerClass = 0;
+    reader.read(personId);
+    reader.read(lineNumber);
+    reader.read(expectedWaitTime);
+    reader.read(entering);
+    reader.read(exiting);
+    reader.read(flags);
+    reader.read(serviceDemand);
+    reader.read(customerClass);
+    if (!reader.ok() || customerClass >= CUSTOMER_CLASS_COUNT)
+    {
+        return false;
+    }
+
+    person = Person(expectedWaitTime, lineNumber, entering);
+    person.setPersonId(personId);
+    person.setRoutingTag(static_cast<uint8_t>(flags >> SNAPSHOT_PERSON_ROUTING_SHIFT));
+    person.setServiceDemand(serviceDemand);
+    person.setCustomerClass(static_cast<CustomerClass>(customerClass));
+    if (flags & SNAPSHOT_PERSON_ABANDONED)
+    {
+        person.recordAbandonmentAt(exiting);
+    }
+    else if (exiting != 0)
     {
-        Person::setSimulationStartTime();
-        timeInitialized = true;
+        person.recordExitAt(exiting);
     }
+    return true;
+}
+
+QueueManager::QueueManager(int maxSize, int numberOfLines, const std::string &strategyPrefix,
+                           const std::string &appName, const std::vector<double> &serviceRates,
+                           bool clearCloudOnStart)
+    : m_maxSize(maxSize), m_numberOfLines(numberOfLines), m_totalPeople(0),
+      m_linePool(std::make_shared<RingBufferPool<Person>>()), m_lines(), m_personIndex(PersonLocationIndex()),
+      m_totalPeopleEver(0), m_completedPeopleEver(0), m_abandonedPeopleEver(0), m_totalExpectedWaitTime(0.0), m_totalActualWaitTime(0.0),
+      m_lastSelectedLine(-1), m_nextPersonId(1), // Each QueueManager starts its own ID counter at 1
+      m_firebaseClient(nullptr), m_cloudPublishingEnabled(true), m_strategyPrefix(strategyPrefix),
+      m_cloudRootPath("simulation" + strategyPrefix), m_throughputTrackers(),
+      m_expectedServiceRates(), m_currentArrivalRate(0.5), // Default arrival rate from simulations
+      m_failoverEnabled(false),
+      m_recommendationTimeout(120), m_stateVersion(0), m_lineVersions(), m_publishedLineVersions(),
+      m_etaCursorLine(0), m_etaCursorVersion(0), m_etaCursorPosition(0),
+      m_rebalanceThreshold(0.0), m_rebalanceSequence(0), m_publishedRebalanceSequence(0), m_rebalanceStanding(false),
+      m_isFork(false)
+{
+    // Initialize simulation time to start from 0 (only once globally; static init is thread-safe)
+    static const bool timeInitialized = (Person::setSimulationStartTime(), true);
+    (void)timeInitialized;
 
     if (m_numberOfLines < 0)
         m_numberOfLines = 0;
-    if (m_numberOfLines > MAX_LINES)
-        m_numberOfLines = MAX_LINES;                      // enforce historical cap
-    m_lines.reserve(m_numberOfLines);                     // reserve capacity to avoid reallocations
-    m_lines.assign(m_numberOfLines, std::list<Person>()); // initialize with empty lists
+    m_lines.reserve(m_numberOfLines); // reserve capacity to avoid reallocations
+    for (int i = 0; i < m_numberOfLines; ++i)
+    {
+        m_lines.emplace_back(RingBuffer<Person>(m_linePool)); // empty ring buffers sharing one block pool
+    }
+    mutablePersonIndex().reset(m_numberOfLines);
 
     // Initialize line availability - all lines start as available (sensors working)
     m_lineAvailability.assign(m_numberOfLines, true);
 
+    // Every line serves every customer class until told otherwise
+    m_lineClassMasks.assign(m_numberOfLines, ALL_CUSTOMER_CLASSES);
+    m_walkSeconds.assign(m_numberOfLines, 0.0); // Unknown until setVenueLayout
+
+    // Cloud paths are fixed for the lifetime of the manager
+    m_recommendedChoicePath = m_cloudRootPath + "/recommendedChoice";
+    m_peopleSummaryPath = m_cloudRootPath + "/" + FirebasePeopleStructureBuilder::getPeopleSummaryPath();
+    m_rebalancePath = m_cloudRootPath + "/" + FirebaseStructureBuilder::getRebalanceDataPath();
+    m_rebalanceMoves.reserve(REBALANCE_HISTORY);
+    m_lineCloudPaths.reserve(m_numberOfLines);
+    for (int i = 1; i <= m_numberOfLines; ++i)
+    {
+        m_lineCloudPaths.push_back(m_cloudRootPath + "/queues/line" + std::to_string(i));
+    }
+    m_lineDataScratch.reserve(m_numberOfLines);
+    m_lastHourHistory = RingBuffer<Person>(m_linePool);
+
     // Initialize throughput trackers with service rates
     initializeThroughputTrackers(serviceRates);
 
+    // Built-in strategies sit at their LineSelectionStrategy values
+    m_strategies.reserve(BUILT_IN_STRATEGY_COUNT);
+    m_strategies.emplace_back(new ShortestWaitTimeStrategy());
+    m_strategies.emplace_back(new FewestPeopleStrategy());
+    m_strategies.emplace_back(new FarthestFromEntranceStrategy());
+    m_strategies.emplace_back(new NearestToEntranceStrategy());
+    m_strategies.emplace_back(new AdaptiveStrategy());
+    m_strategies.emplace_back(new ShortestWorkloadStrategy());
+    m_strategies.emplace_back(new LookaheadStrategy());
+    m_strategies.emplace_back(new WalkAndWaitStrategy());
+    m_lastAutoStrategy = LineSelectionStrategy::ADAPTIVE; // Not used yet, so the first enqueueAuto reports its choice
+
+    // Rank all lines for every strategy (all empty and available at this point)
+    rebuildLineSelection();
+
+    // Running without cloud integration (benchmarks, offline tools)
+    if (appName.empty())
+    {
+        return;
+    }
+
     // Initialize Firebase client with provided app name and database secret
     m_firebaseClient = std::make_shared<FirebaseClient>(
         appName,
@@ -60,196 +164,388 @@ QueueManager::QueueManager(int maxSize, int numberOfLines, const std::string &st
     else
     {
         std::cout << "Firebase client initialized successfully for " << appName << std::endl;
-        // Clear existing data when QueueManager starts
-        clearCloudData();
+        // Clear existing data when QueueManager starts (kept when resuming from a snapshot)
+        if (clearCloudOnStart)
+        {
+            clearCloudData();
+        }
     }
 }
 
-bool QueueManager::enqueue(LineSelectionStrategy strategy)
+QueueManager::QueueManager(const QueueManager &source, ForkTag)
+    : m_maxSize(source.m_maxSize), m_numberOfLines(source.m_numberOfLines), m_totalPeople(source.m_totalPeople),
+      m_linePool(std::make_shared<RingBufferPool<Person>>()), m_lines(source.m_lines), // Shared until first write
+      m_personIndex(source.m_personIndex),
+      m_totalPeopleEver(source.m_totalPeopleEver), m_completedPeopleEver(source.m_completedPeopleEver),
+      m_abandonedPeopleEver(source.m_abandonedPeopleEver),
+      m_totalExpectedWaitTime(source.m_totalExpectedWaitTime), m_totalActualWaitTime(source.m_totalActualWaitTime),
+      m_lastSelectedLine(source.m_lastSelectedLine), m_nextPersonId(source.m_nextPersonId),
+      m_eventLog(nullptr), m_firebaseClient(nullptr), m_cloudPublishingEnabled(false),
+      m_strategyPrefix(source.m_strategyPrefix), m_throughputTrackers(source.m_throughputTrackers),
+      m_expectedServiceRates(source.m_expectedServiceRates), m_currentArrivalRate(source.m_currentArrivalRate),
+      m_lineAvailability(source.m_lineAvailability), m_walkSeconds(source.m_walkSeconds),
+      m_failoverEnabled(source.m_failoverEnabled), m_lineClassMasks(source.m_lineClassMasks),
+      m_classCounts(source.m_classCounts), m_lastAutoStrategy(source.m_lastAutoStrategy),
+      m_waitEstimates(source.m_waitEstimates), m_outstandingWork(source.m_outstandingWork),
+      m_recommendations(source.m_recommendations), m_pendingCounts(source.m_pendingCounts),
+      m_arrivedUnexpired(source.m_arrivedUnexpired), m_recommendationTimeout(source.m_recommendationTimeout),
+      m_stateVersion(source.m_stateVersion),
+      m_lineVersions(source.m_lineVersions), m_publishedLineVersions(source.m_publishedLineVersions.size(), 0),
+      m_etaCursorLine(0), m_etaCursorVersion(0), m_etaCursorPosition(0),
+      m_rebalanceThreshold(source.m_rebalanceThreshold), m_longestTails(source.m_longestTails),
+      m_shortestWaits(source.m_shortestWaits), m_rebalanceMoves(source.m_rebalanceMoves),
+      m_rebalanceSequence(source.m_rebalanceSequence), m_publishedRebalanceSequence(source.m_rebalanceSequence),
+      m_rebalanceStanding(source.m_rebalanceStanding),
+      m_lastHourHistory(m_linePool), m_isFork(true)
 {
-    int lineNumber = getNextLineNumber(strategy);
-    if (lineNumber == -1)
+    m_strategies.reserve(source.m_strategies.size());
+    for (const auto &strategy : source.m_strategies)
+    {
+        m_strategies.push_back(strategy->clone());
+    }
+    for (int c = 0; c < CUSTOMER_CLASS_COUNT; ++c)
     {
-        return false; // No available lines (all at capacity or no lines exist)
+        for (const auto &strategy : source.m_classStrategies[c])
+        {
+            m_classStrategies[c].push_back(strategy->clone());
+        }
     }
+}
 
-    // Store the selected line for Firebase reporting
-    m_lastSelectedLine = lineNumber;
+std::unique_ptr<QueueManager> QueueManager::fork() const
+{
+    return std::unique_ptr<QueueManager>(new QueueManager(*this, ForkTag()));
+}
 
-    // Check per-line capacity only
-    if (m_maxSize > 0 && static_cast<int>(m_lines[lineNumber - 1].size()) >= m_maxSize)
+void QueueManager::rebuildPersonIndex()
+{
+    // The index takes IDs in increasing order; places are given explicitly, since someone who
+    // moved to a line (failover) stands behind people with newer IDs
+    struct Place
+    {
+        int personId;
+        int lineIndex;
+        int offset;
+        bool operator<(const Place &other) const { return personId < other.personId; }
+    };
+    std::vector<Place> waiting;
+    waiting.reserve(m_totalPeople);
+    for (int i = 0; i < m_numberOfLines; ++i)
     {
-        return false; // Selected line is at capacity
+        int offset = 0;
+        for (const Person &person : *m_lines[i])
+        {
+            waiting.push_back(Place{person.getPersonId(), i, offset++});
+        }
     }
+    std::sort(waiting.begin(), waiting.end());
 
-    // Calculate expected wait time for this person
-    double expectedWaitTime = getEstimatedWaitTimeForNewPerson(lineNumber);
+    PersonLocationIndex &index = mutablePersonIndex();
+    index.reset(m_numberOfLines);
+    for (const Place &place : waiting)
+    {
+        index.addAt(place.personId, place.lineIndex, place.offset);
+    }
+}
 
-    // Create a new person and add to the line
-    Person newPerson(expectedWaitTime, lineNumber);
-    newPerson.setPersonId(m_nextPersonId++); // Assign unique ID for this QueueManager instance
-    auto &line = m_lines[lineNumber - 1];
-    line.push_back(newPerson);
-    m_totalPeople++;
+RingBuffer<Person> &QueueManager::mutableLine(int lineIndex)
+{
+    // If the line is still shared with a fork (or the manager this was forked from), take a private copy
+    // backed by our own pool, so the two never touch the same storage or pool
+    auto copyIntoOwnPool = [this](const RingBuffer<Person> &shared)
+    {
+        RingBuffer<Person> copy(m_linePool);
+        copy.reserve(shared.size() + 1);
+        for (const Person &person : shared)
+        {
+            copy.push_back(person);
+        }
+        return copy;
+    };
+    return m_lines[lineIndex].write(copyIntoOwnPool);
+}
 
-    // Add person to history for offline functionality
-    addPersonToHistory(newPerson);
+PersonLocationIndex &QueueManager::mutablePersonIndex()
+{
+    auto copy = [](const PersonLocationIndex &shared)
+    {
+        return shared;
+    };
+    return m_personIndex.write(copy);
+}
 
-    // Update running statistics
-    m_totalPeopleEver++;
-    m_totalExpectedWaitTime += expectedWaitTime;
+EnqueueResult QueueManager::enqueue(LineSelectionStrategy strategy, double serviceDemand, CustomerClass customerClass)
+{
+    int lineNumber = getNextLineNumber(strategy, customerClass);
+    if (lineNumber == -1)
+    {
+        return EnqueueResult(); // No available lines (all at capacity or no lines exist)
+    }
+
+    // Store the selected line for Firebase reporting
+    m_lastSelectedLine = lineNumber;
 
-    // If this person is first in line, set their exit timestamp immediately
-    if (line.size() == 1)
+    // Adaptive arrivals are tagged with the strategy that actually picked the line
+    EnqueueResult ticket = addPersonToLine(lineNumber, routingTagOf(getEffectiveStrategy(strategy)), serviceDemand,
+                                           customerClass);
+    if (!ticket)
     {
-        line.front().recordExit();
-        // Update completion statistics
-        m_completedPeopleEver++;
-        m_totalActualWaitTime += line.front().getActualWaitTime();
+        return ticket; // Selected line is at capacity
     }
 
     // Automatically write to Firebase after state change
     writeToFirebase(strategy);
 
-    return true;
+    return ticket;
 }
 
-bool QueueManager::enqueueAuto()
+EnqueueResult QueueManager::enqueueAuto(double serviceDemand, CustomerClass customerClass)
 {
-    // Only switch to SHORTEST_WAIT_TIME when EVERY line has 7+ completions
-    // This ensures we have reliable throughput data for all lines before making decisions
-    LineSelectionStrategy strategy;
-
-    // Check if every line has reliable throughput data (7+ completions each)
-    bool allLinesReliable = true;
-    std::cout << "🔍 Strategy Check - Total completions: " << m_completedPeopleEver << std::endl;
-
-    for (int i = 0; i < m_numberOfLines; i++)
+    // The adaptive strategy tracks line reliability itself; only report when it switches
+    LineSelectionStrategy effective = getEffectiveStrategy(LineSelectionStrategy::ADAPTIVE);
+    if (effective != m_lastAutoStrategy)
     {
-        int lineCompletions = m_throughputTrackers[i].getServiceCount();
-        bool lineReliable = m_throughputTrackers[i].hasReliableData();
-        std::cout << "   Line " << (i + 1) << ": " << lineCompletions << " completions, reliable: "
-                  << (lineReliable ? "YES" : "NO") << std::endl;
-
-        if (!lineReliable)
+        m_lastAutoStrategy = effective;
+        if (effective == LineSelectionStrategy::SHORTEST_WAIT_TIME)
+        {
+            std::cout << "✅ STRATEGY SWITCHED TO SHORTEST_WAIT_TIME (all lines reliable)" << std::endl;
+        }
+        else
         {
-            allLinesReliable = false;
+            std::cout << "⏳ Using FEWEST_PEOPLE (waiting for all lines to be reliable)" << std::endl;
         }
     }
 
-    if (allLinesReliable)
+    return enqueue(LineSelectionStrategy::ADAPTIVE, serviceDemand, customerClass);
+}
+
+bool QueueManager::dequeueAuto(int lineNumber)
+{
+    return dequeue(lineNumber, LineSelectionStrategy::ADAPTIVE);
+}
+
+bool QueueManager::dequeue(int lineNumber, LineSelectionStrategy strategy)
+{
+    if (!removePersonFromLine(lineNumber))
     {
-        // All lines have 7+ completions - use sophisticated strategy
-        strategy = LineSelectionStrategy::SHORTEST_WAIT_TIME;
-        std::cout << "✅ STRATEGY SWITCHED TO SHORTEST_WAIT_TIME (all lines reliable)" << std::endl;
+        return false;
     }
-    else
+
+    // Store the selected line for Firebase reporting (same as enqueue)
+    int recommendedLine = getNextLineNumber(strategy);
+    if (recommendedLine != -1)
     {
-        // Some lines still don't have enough data - stick with simple strategy
-        strategy = LineSelectionStrategy::FEWEST_PEOPLE;
-        std::cout << "⏳ Using FEWEST_PEOPLE (waiting for all lines to be reliable)" << std::endl;
+        m_lastSelectedLine = recommendedLine;
     }
 
-    return enqueue(strategy);
+    // Automatically write to Firebase after state change
+    writeToFirebase(strategy);
+
+    return true;
 }
 
-bool QueueManager::dequeueAuto(int lineNumber)
+EnqueueResult QueueManager::enqueueOnLine(int lineNumber, double serviceDemand, CustomerClass customerClass)
 {
-    // Only switch to SHORTEST_WAIT_TIME when EVERY line has 7+ completions
-    // This ensures we have reliable throughput data for all lines before making decisions
-    LineSelectionStrategy strategy;
+    EnqueueResult ticket = addPersonToLine(lineNumber, Person::NOT_ROUTED, serviceDemand, customerClass);
+    if (!ticket)
+    {
+        return ticket;
+    }
+
+    // Automatically write to Firebase after state change
+    writeToFirebase();
 
-    // Check if every line has reliable throughput data (7+ completions each)
-    bool allLinesReliable = true;
+    return ticket;
+}
 
-    for (int i = 0; i < m_numberOfLines; i++)
+GroupEnqueueResult QueueManager::enqueueGroup(int size, double serviceDemand, LineSelectionStrategy strategy,
+                                              CustomerClass customerClass)
+{
+    if (size < 1)
     {
-        bool lineReliable = m_throughputTrackers[i].hasReliableData();
+        std::cerr << "❌ Invalid party size " << size << std::endl;
+        return GroupEnqueueResult();
+    }
 
-        if (!lineReliable)
-        {
-            allLinesReliable = false;
-        }
+    if (serviceDemand == 0.0)
+    {
+        serviceDemand = size; // Every member an average customer
+    }
+    if (!(serviceDemand > 0.0) || !std::isfinite(serviceDemand))
+    {
+        std::cerr << "❌ Invalid service demand " << serviceDemand << " (must be a positive multiple of an average customer)" << std::endl;
+        return GroupEnqueueResult();
     }
 
-    if (allLinesReliable)
+    // Strategies rank lines for one more person; a line with fewer free places than members
+    // would split the party, so take the shortest wait that fits all of them instead. The
+    // strategy did not choose that line: tag it by how it was chosen, for per-strategy analytics
+    uint8_t routingTag = routingTagOf(getEffectiveStrategy(strategy));
+    int lineNumber = getNextLineNumber(strategy, customerClass);
+    if (lineNumber != -1 && !hasRoomFor(lineNumber - 1, size))
     {
-        // All lines have 7+ completions - use sophisticated strategy
-        strategy = LineSelectionStrategy::SHORTEST_WAIT_TIME;
+        lineNumber = findLineWithRoomFor(size, customerClass);
+        routingTag = routingTagOf(LineSelectionStrategy::SHORTEST_WAIT_TIME);
     }
-    else
+    if (lineNumber == -1)
+    {
+        return GroupEnqueueResult(); // No line can take the whole party
+    }
+
+    m_lastSelectedLine = lineNumber;
+
+    // Outstanding work (SHORTEST_WORKLOAD) grows by the party's demand; wait estimates count
+    // heads, so the wait quoted to whoever comes next grows by one person per member
+    double memberDemand = serviceDemand / size;
+    EnqueueResult firstMember = addPersonToLine(lineNumber, routingTag, memberDemand, customerClass);
+    for (int member = 1; member < size; ++member)
     {
-        // Some lines still don't have enough data - stick with simple strategy
-        strategy = LineSelectionStrategy::FEWEST_PEOPLE;
+        addPersonToLine(lineNumber, routingTag, memberDemand, customerClass);
     }
 
-    return dequeue(lineNumber, strategy);
+    // One publish for the whole party
+    writeToFirebase(strategy);
+
+    return GroupEnqueueResult(firstMember, size);
 }
 
-bool QueueManager::dequeue(int lineNumber, LineSelectionStrategy strategy)
+bool QueueManager::abandon(int personId)
 {
-    if (!isValidLineNumber(lineNumber))
+    if (!removeAbandonedPerson(personId, Person::getCurrentTimestamp()))
     {
         return false;
     }
 
-    // Check if line has people
-    if (m_lines[lineNumber - 1].empty())
+    // Automatically write to Firebase after state change
+    writeToFirebase();
+
+    return true;
+}
+
+bool QueueManager::moveWaitingPerson(int personId, int lineNumber)
+{
+    if (!isValidLineNumber(lineNumber))
     {
+        std::cerr << "❌ Invalid line number " << lineNumber << " for moveWaitingPerson" << std::endl;
         return false;
     }
 
-    // Remove the first person from the line (they have already had their exit timestamp set when they became first in line)
-    auto &line = m_lines[lineNumber - 1];
-    if (!line.empty())
+    // Only people behind a register move, to a line that takes their class and has room
+    int fromLineIndex = m_personIndex->lineIndexOf(personId);
+    int toLineIndex = lineNumber - 1;
+    if (fromLineIndex < 0 || fromLineIndex == toLineIndex ||
+        m_personIndex->positionOf(personId) <= m_throughputTrackers[fromLineIndex].getServerCount())
     {
-        // Store the completed person info before removing them to update history
-        Person completedPerson = line.front();
-        
-        line.pop_front();
-        m_totalPeople--;
+        return false;
+    }
+    const Person &person = (*m_lines[fromLineIndex])[static_cast<size_t>(m_personIndex->offsetOf(personId))];
+    if (!m_lineAvailability[toLineIndex] || !(m_lineClassMasks[toLineIndex] & customerClassBit(person.getCustomerClass())) ||
+        !hasRoomFor(toLineIndex, 1))
+    {
+        return false;
+    }
+
+    // Expected wait stays measured from entering, as for failover
+    long long now = Person::getCurrentTimestamp();
+    double expectedWaitTime = static_cast<double>(now - person.getEnteringTimestamp()) +
+                              getEstimatedWaitTimeForNewPerson(lineNumber);
+    movePerson(personId, toLineIndex, expectedWaitTime, now);
+    startFreeRegisters(toLineIndex, now);
+
+    // Automatically write to Firebase after state change
+    writeToFirebase();
+
+    return true;
+}
 
-        // Update the completed person in history with their exit information
-        updatePersonInHistory(completedPerson);
+int QueueManager::applyBatch(const QueueEvent *events, size_t count, LineSelectionStrategy strategy, bool *appliedFlags,
+                             EnqueueResult *tickets)
+{
+    int applied = 0;
 
-        // If there is a new first person, set their exit timestamp now
-        if (!line.empty() && !line.front().hasExited())
+    // Mutate state for every event first - no recommendation or cloud write in between
+    for (size_t i = 0; i < count; ++i)
+    {
+        const QueueEvent &event = events[i];
+        bool ok = false;
+        switch (event.type)
         {
-            line.front().recordExit();
+        case QueueEvent::Type::ARRIVAL:
+        {
+            int lineNumber = event.lineNumber > 0 ? event.lineNumber : getNextLineNumber(strategy, event.customerClass);
+            uint8_t routingTag = event.lineNumber > 0 ? Person::NOT_ROUTED : routingTagOf(getEffectiveStrategy(strategy));
+            EnqueueResult ticket = lineNumber != -1
+                                       ? addPersonToLine(lineNumber, routingTag, event.serviceDemand, event.customerClass)
+                                       : EnqueueResult();
+            if (tickets)
+            {
+                tickets[i] = ticket;
+            }
+            ok = ticket.admitted;
+            break;
+        }
+        case QueueEvent::Type::SERVICE_COMPLETION:
+            ok = removePersonFromLine(event.lineNumber);
+            break;
+        case QueueEvent::Type::AVAILABILITY_CHANGE:
+            ok = isValidLineNumber(event.lineNumber);
+            if (ok)
+            {
+                changeLineAvailability(event.lineNumber, event.available);
+            }
+            break;
+        case QueueEvent::Type::ABANDONMENT:
+            ok = removeAbandonedPerson(event.personId, Person::getCurrentTimestamp());
+            break;
+        case QueueEvent::Type::SERVER_COUNT_CHANGE:
+            ok = setServerCount(event.lineNumber, event.serverCount);
+            break;
+        }
 
-            // Update completion statistics
-            m_completedPeopleEver++;
-            m_totalActualWaitTime += line.front().getActualWaitTime();
+        if (appliedFlags)
+        {
+            appliedFlags[i] = ok;
+        }
+        if (ok)
+        {
+            applied++;
         }
     }
 
-    // Record service completion for throughput tracking
-    m_throughputTrackers[lineNumber - 1].recordServiceCompletion();
+    if (applied == 0)
+    {
+        return 0; // Nothing changed - nothing to publish
+    }
 
-    // Store the selected line for Firebase reporting (same as enqueue)
+    // One recommendation and one publish for the whole batch
     int recommendedLine = getNextLineNumber(strategy);
     if (recommendedLine != -1)
     {
         m_lastSelectedLine = recommendedLine;
     }
-
-    // Automatically write to Firebase after state change
     writeToFirebase(strategy);
 
-    return true;
+    return applied;
 }
 
-bool QueueManager::enqueueOnLine(int lineNumber)
+EnqueueResult QueueManager::addPersonToLine(int lineNumber, uint8_t routingTag, double serviceDemand,
+                                            CustomerClass customerClass)
 {
     if (!isValidLineNumber(lineNumber))
     {
-        return false;
+        return EnqueueResult();
+    }
+
+    if (!(serviceDemand > 0.0) || !std::isfinite(serviceDemand))
+    {
+        std::cerr << "❌ Invalid service demand " << serviceDemand << " (must be a positive multiple of an average customer)" << std::endl;
+        return EnqueueResult();
     }
 
     // Check if the specific line is at capacity
-    if (m_maxSize > 0 && static_cast<int>(m_lines[lineNumber - 1].size()) >= m_maxSize)
+    if (isLineAtCapacity(lineNumber - 1))
     {
-        return false; // This specific line is at capacity
+        return EnqueueResult(); // This specific line is at capacity
     }
 
     // Calculate expected wait time for this person
@@ -258,143 +554,1207 @@ bool QueueManager::enqueueOnLine(int lineNumber)
     // Create a new person and add to the specified line
     Person newPerson(expectedWaitTime, lineNumber);
     newPerson.setPersonId(m_nextPersonId++); // Assign unique ID for this QueueManager instance
-    auto &line = m_lines[lineNumber - 1];
-    line.push_back(newPerson);
+    newPerson.setRoutingTag(routingTag);
+    newPerson.setServiceDemand(serviceDemand);
+    newPerson.setCustomerClass(customerClass);
+    admitPerson(newPerson);
+
+    // If a register is free for this person, set their exit timestamp immediately
+    if (activeCount(lineNumber - 1) <= m_throughputTrackers[lineNumber - 1].getServerCount())
+    {
+        startFreeRegisters(lineNumber - 1, Person::getCurrentTimestamp());
+    }
+
+    return EnqueueResult(lineNumber, activeCount(lineNumber - 1), newPerson.getPersonId(), expectedWaitTime);
+}
+
+bool QueueManager::removePersonFromLine(int lineNumber)
+{
+    if (!isValidLineNumber(lineNumber))
+    {
+        return false;
+    }
+
+    // Check if line has people
+    int lineIndex = lineNumber - 1;
+    if (m_lines[lineIndex]->empty())
+    {
+        return false;
+    }
+
+    // Remove the first person from the line (they have already had their exit timestamp set when they became first in line)
+    long long now = Person::getCurrentTimestamp();
+    completeServiceOfFront(lineIndex, m_throughputTrackers[lineIndex].getSessionTimeMillis(), now);
+
+    // Whoever takes the register that was freed gets their exit timestamp now
+    startFreeRegisters(lineIndex, now);
+
+    return true;
+}
+
+void QueueManager::admitPerson(const Person &person)
+{
+    int lineIndex = person.getLineNumber() - 1;
+    mutableLine(lineIndex).push_back(person);
+    mutablePersonIndex().add(person.getPersonId(), lineIndex);
+    m_throughputTrackers[lineIndex].recordArrival();
+    m_outstandingWork[lineIndex] += person.getServiceDemand();
+    m_classCounts[lineIndex][static_cast<int>(person.getCustomerClass())]++;
     m_totalPeople++;
 
+    // Whoever arrives is taken to be the oldest person sent here
+    expireRecommendations(person.getEnteringTimestamp());
+    if (m_pendingCounts[lineIndex] > 0)
+    {
+        m_pendingCounts[lineIndex]--;
+        m_arrivedUnexpired[lineIndex]++;
+    }
+    refreshLineSelection(lineIndex, LineChange::ARRIVAL);
+
     // Add person to history for offline functionality
-    addPersonToHistory(newPerson);
+    addPersonToHistory(person);
 
     // Update running statistics
     m_totalPeopleEver++;
-    m_totalExpectedWaitTime += expectedWaitTime;
+    m_totalExpectedWaitTime += person.getExpectedWaitTime();
+
+    logEvent(EventLogRecordType::ARRIVAL, person.getLineNumber(), person.getPersonId(),
+             person.getEnteringTimestamp(), person.getExpectedWaitTime());
+    if (person.getServiceDemand() != 1.0)
+    {
+        logEvent(EventLogRecordType::SERVICE_DEMAND, person.getLineNumber(), person.getPersonId(),
+                 person.getEnteringTimestamp(), person.getServiceDemand());
+    }
+    if (person.getCustomerClass() != CustomerClass::STANDARD)
+    {
+        logEvent(EventLogRecordType::CUSTOMER_CLASS, person.getLineNumber(), person.getPersonId(),
+                 person.getEnteringTimestamp(), static_cast<double>(person.getCustomerClass()));
+    }
+}
+
+void QueueManager::startServiceAt(int lineIndex, int offset, long long timestamp)
+{
+    Person &person = mutableLine(lineIndex)[static_cast<size_t>(offset)];
+    person.recordExitAt(timestamp);
+
+    // Update completion statistics
+    m_completedPeopleEver++;
+    m_totalActualWaitTime += person.getActualWaitTime();
+
+    logEvent(EventLogRecordType::BECAME_FIRST, lineIndex + 1, person.getPersonId(), timestamp, 0.0);
+}
+
+void QueueManager::movePerson(int personId, int toLineIndex, double expectedWaitTime, long long timestamp)
+{
+    int fromLineIndex = m_personIndex->lineIndexOf(personId);
+    int offset = m_personIndex->offsetOf(personId);
+
+    // The old entry stays as a tombstone until it reaches the front, as for an abandonment;
+    // the person keeps their ID and arrival time, and queues again at the back of the new line
+    Person &entry = mutableLine(fromLineIndex)[static_cast<size_t>(offset)];
+    Person person = entry;
+    entry.recordAbandonmentAt(timestamp);
+    mutablePersonIndex().move(personId, toLineIndex);
+    m_outstandingWork[fromLineIndex] -= person.getServiceDemand();
+    m_classCounts[fromLineIndex][static_cast<int>(person.getCustomerClass())]--;
+
+    m_totalExpectedWaitTime += expectedWaitTime - person.getExpectedWaitTime();
+    person.setLineNumber(toLineIndex + 1);
+    person.setExpectedWaitTime(expectedWaitTime);
+    mutableLine(toLineIndex).push_back(person);
+    m_outstandingWork[toLineIndex] += person.getServiceDemand();
+    m_classCounts[toLineIndex][static_cast<int>(person.getCustomerClass())]++;
+    updatePersonInHistory(person);
+
+    // Strategies see what the sensors would: someone leaving one line and joining another
+    refreshLineSelection(fromLineIndex, LineChange::ABANDONMENT);
+    refreshLineSelection(toLineIndex, LineChange::ARRIVAL);
+
+    logEvent(EventLogRecordType::MOVE, toLineIndex + 1, personId, timestamp, expectedWaitTime);
+}
+
+void QueueManager::startFreeRegisters(int lineIndex, long long timestamp)
+{
+    // The first `servers` people still in line are at a register (FIFO); start whoever just got one
+    int servers = m_throughputTrackers[lineIndex].getServerCount();
+    int atRegister = 0;
+    for (size_t offset = 0; offset < m_lines[lineIndex]->size() && atRegister < servers; ++offset)
+    {
+        const Person &person = (*m_lines[lineIndex])[offset]; // Re-read: starting a service may unshare the line
+        if (person.hasAbandoned())
+        {
+            continue;
+        }
+        atRegister++;
+        if (!person.hasExited())
+        {
+            startServiceAt(lineIndex, static_cast<int>(offset), timestamp);
+        }
+    }
+}
+
+void QueueManager::completeServiceOfFront(int lineIndex, long long sessionMillis, long long timestamp)
+{
+    // Store the completed person info before removing them to update history
+    Person completedPerson = popFront(lineIndex);
+    m_totalPeople--;
+
+    // Update the completed person in history with their exit information
+    updatePersonInHistory(completedPerson);
+    archiveDeparture(completedPerson, timestamp);
+
+    // Record service completion for throughput tracking, and the time at the register for the person's class
+    m_throughputTrackers[lineIndex].recordServiceCompletionAt(sessionMillis);
+    m_throughputTrackers[lineIndex].recordServiceDemand(completedPerson.getServiceDemand());
+    if (completedPerson.hasExited())
+    {
+        m_throughputTrackers[lineIndex].recordClassService(
+            completedPerson.getCustomerClass(), static_cast<double>(timestamp - completedPerson.getExitingTimestamp()));
+    }
+    refreshLineSelection(lineIndex, LineChange::SERVICE);
+
+    logEvent(EventLogRecordType::SERVICE_COMPLETION, lineIndex + 1, completedPerson.getPersonId(),
+             timestamp, static_cast<double>(sessionMillis));
+}
+
+Person QueueManager::popFront(int lineIndex)
+{
+    auto &line = mutableLine(lineIndex);
+    PersonLocationIndex &index = mutablePersonIndex();
+
+    Person front = line.front();
+    line.pop_front();
+    index.removeFront(front.getPersonId(), lineIndex);
+    m_outstandingWork[lineIndex] -= front.getServiceDemand(); // The front is never a tombstone
+    m_classCounts[lineIndex][static_cast<int>(front.getCustomerClass())]--;
+
+    // Abandoned entries are only dropped here, once nobody is waiting in front of them
+    while (!line.empty() && line.front().hasAbandoned())
+    {
+        index.removeFront(line.front().getPersonId(), lineIndex);
+        line.pop_front();
+    }
+    if (line.empty())
+    {
+        m_outstandingWork[lineIndex] = 0.0; // Drop accumulated rounding
+    }
+    return front;
+}
+
+bool QueueManager::removeAbandonedPerson(int personId, long long timestamp)
+{
+    int lineIndex = m_personIndex->lineIndexOf(personId);
+    if (lineIndex < 0)
+    {
+        return false; // Not waiting (already served, already gone or unknown)
+    }
+
+    Person leavingPerson;
+    int offset = m_personIndex->offsetOf(personId);
+    if (offset == 0)
+    {
+        // Walked away from the counter: no longer counted as reaching it, and the next person is up
+        leavingPerson = popFront(lineIndex);
+        m_completedPeopleEver--;
+        m_totalActualWaitTime -= leavingPerson.getActualWaitTime();
+        leavingPerson.recordAbandonmentAt(timestamp);
+        startFreeRegisters(lineIndex, timestamp);
+    }
+    else
+    {
+        // Tombstone in place: O(1) in the line, O(log n) in the index
+        Person &entry = mutableLine(lineIndex)[static_cast<size_t>(offset)];
+        bool wasAtRegister = entry.hasExited(); // Possible on lines with several registers
+        if (wasAtRegister)
+        {
+            m_completedPeopleEver--;
+            m_totalActualWaitTime -= entry.getActualWaitTime();
+        }
+        entry.recordAbandonmentAt(timestamp);
+        leavingPerson = entry;
+        mutablePersonIndex().abandon(personId);
+        m_outstandingWork[lineIndex] -= entry.getServiceDemand();
+        m_classCounts[lineIndex][static_cast<int>(entry.getCustomerClass())]--;
+        if (wasAtRegister)
+        {
+            startFreeRegisters(lineIndex, timestamp);
+        }
+    }
+
+    m_totalPeople--;
+    m_abandonedPeopleEver++;
+    m_throughputTrackers[lineIndex].recordAbandonment();
+    updatePersonInHistory(leavingPerson);
+    archiveDeparture(leavingPerson, timestamp);
+    refreshLineSelection(lineIndex, LineChange::ABANDONMENT);
+
+    logEvent(EventLogRecordType::ABANDONMENT, lineIndex + 1, personId, timestamp, 0.0);
+    return true;
+}
+
+void QueueManager::archiveDeparture(const Person &person, long long timestamp)
+{
+    if (m_isFork)
+    {
+        return; // What-if runs do not feed analytics
+    }
+    m_completedArchive.append(person, timestamp);
+}
+
+int QueueManager::activeCount(int lineIndex) const
+{
+    return static_cast<int>(m_lines[lineIndex]->size()) - m_personIndex->tombstoneCount(lineIndex);
+}
+
+void QueueManager::logEvent(EventLogRecordType type, int lineNumber, int personId, long long timestamp,
+                            double value, bool available)
+{
+    if (!m_eventLog)
+    {
+        return;
+    }
+
+    EventLogRecord record = {};
+    record.timestamp = timestamp;
+    record.value = value;
+    record.personId = personId;
+    record.type = type;
+    record.available = available ? 1 : 0;
+    record.lineNumber = static_cast<uint16_t>(lineNumber);
+    m_eventLog->append(record);
+}
+
+bool QueueManager::attachEventLog(std::shared_ptr<EventLog> eventLog)
+{
+    if (eventLog && m_numberOfLines > EventLog::MAX_LINES)
+    {
+        std::cerr << "❌ Event log records hold line numbers up to " << EventLog::MAX_LINES
+                  << ", this manager has " << m_numberOfLines << " lines" << std::endl;
+        m_eventLog = nullptr;
+        return false;
+    }
+    m_eventLog = std::move(eventLog);
+    if (m_eventLog && m_eventLog->empty())
+    {
+        m_eventLog->setConfiguration(m_numberOfLines, m_maxSize, Person::getSimulationStartTime());
+    }
+    return true;
+}
+
+size_t QueueManager::replay(const EventLog &eventLog)
+{
+    if (eventLog.getNumberOfLines() != m_numberOfLines)
+    {
+        std::cerr << "❌ Event log was written for " << eventLog.getNumberOfLines()
+                  << " lines, this manager has " << m_numberOfLines << std::endl;
+        return 0;
+    }
+    return replay(eventLog.records(), eventLog.size());
+}
+
+size_t QueueManager::replay(const EventLogRecord *records, size_t count)
+{
+    // Replayed events are already in a log: do not record them again
+    std::shared_ptr<EventLog> attachedLog = std::move(m_eventLog);
+    m_eventLog = nullptr;
+
+    // Latest session time logged per line; the trackers continue from it once replay is done
+    std::vector<long long> loggedSessionMillis(m_numberOfLines, -1);
+
+    size_t applied = 0;
+    for (size_t i = 0; i < count; ++i)
+    {
+        const EventLogRecord &record = records[i];
+        int lineNumber = record.lineNumber;
+        int lineIndex = lineNumber - 1;
+        if (record.type != EventLogRecordType::ARRIVAL_RATE_CHANGE && !isValidLineNumber(lineNumber))
+        {
+            continue;
+        }
+
+        switch (record.type)
+        {
+        case EventLogRecordType::ARRIVAL:
+        {
+            // The log is authoritative: capacity was checked when the event happened
+            Person person(record.value, lineNumber, record.timestamp);
+            person.setPersonId(record.personId);
+            for (size_t next = i + 1; next < count && records[next].personId == record.personId; ++next)
+            {
+                if (records[next].type == EventLogRecordType::SERVICE_DEMAND)
+                {
+                    person.setServiceDemand(records[next].value);
+                }
+                else if (records[next].type == EventLogRecordType::CUSTOMER_CLASS &&
+                         records[next].value >= 0.0 && records[next].value < CUSTOMER_CLASS_COUNT)
+                {
+                    person.setCustomerClass(static_cast<CustomerClass>(static_cast<int>(records[next].value)));
+                }
+                else
+                {
+                    break;
+                }
+            }
+            admitPerson(person);
+            m_nextPersonId = std::max(m_nextPersonId, record.personId + 1);
+            break;
+        }
+        case EventLogRecordType::BECAME_FIRST:
+        {
+            int offset = m_personIndex->offsetOf(record.personId);
+            if (offset < 0 || m_personIndex->lineIndexOf(record.personId) != lineIndex ||
+                (*m_lines[lineIndex])[static_cast<size_t>(offset)].hasExited())
+            {
+                continue;
+            }
+            startServiceAt(lineIndex, offset, record.timestamp);
+            break;
+        }
+        case EventLogRecordType::SERVICE_COMPLETION:
+            if (m_lines[lineIndex]->empty())
+            {
+                continue;
+            }
+            completeServiceOfFront(lineIndex, static_cast<long long>(record.value), record.timestamp);
+            loggedSessionMillis[lineIndex] = std::max(loggedSessionMillis[lineIndex], static_cast<long long>(record.value));
+            break;
+        case EventLogRecordType::AVAILABILITY_CHANGE:
+            m_lineAvailability[lineIndex] = record.available != 0;
+            refreshLineSelection(lineIndex, LineChange::AVAILABILITY);
+            break;
+        case EventLogRecordType::ARRIVAL_RATE_CHANGE:
+            setArrivalRate(record.value);
+            break;
+        case EventLogRecordType::ABANDONMENT:
+            if (!removeAbandonedPerson(record.personId, record.timestamp))
+            {
+                continue;
+            }
+            break;
+        case EventLogRecordType::SERVICE_DEMAND:
+        case EventLogRecordType::CUSTOMER_CLASS:
+            continue; // Applied together with the ARRIVAL they follow
+        case EventLogRecordType::SERVER_COUNT_CHANGE:
+            // People moving up to the new registers follow as their own BECAME_FIRST records
+            m_throughputTrackers[lineIndex].setServerCountAt(record.personId, static_cast<long long>(record.value));
+            loggedSessionMillis[lineIndex] = std::max(loggedSessionMillis[lineIndex], static_cast<long long>(record.value));
+            refreshLineSelection(lineIndex, LineChange::ESTIMATE);
+            break;
+        case EventLogRecordType::LINE_CLASSES_CHANGE:
+            if (!setLineClasses(lineNumber, static_cast<uint8_t>(record.value)))
+            {
+                continue;
+            }
+            break;
+        case EventLogRecordType::MOVE:
+        {
+            int fromLineIndex = m_personIndex->lineIndexOf(record.personId);
+            if (fromLineIndex < 0 || fromLineIndex == lineIndex || m_personIndex->offsetOf(record.personId) == 0)
+            {
+                continue; // Not waiting, or at the front (only people behind a register are moved)
+            }
+            movePerson(record.personId, lineIndex, record.value, record.timestamp);
+            break;
+        }
+        default:
+            continue; // Unknown record type (newer writer): skip
+        }
+        applied++;
+    }
+
+    // Like restore(): live completions after replay are divided by the logged session,
+    // not by the few seconds this process has been running
+    for (int i = 0; i < m_numberOfLines; ++i)
+    {
+        if (loggedSessionMillis[i] > m_throughputTrackers[i].getSessionTimeMillis())
+        {
+            m_throughputTrackers[i].resumeSessionAt(loggedSessionMillis[i]);
+        }
+    }
+
+    m_eventLog = std::move(attachedLog);
+    return applied;
+}
+
+std::vector<uint8_t> QueueManager::saveSnapshot() const
+{
+    std::vector<uint8_t> blob;
+    blob.reserve(128 + m_numberOfLines * 64 + (m_totalPeople + m_lastHourHistory.size()) * SNAPSHOT_PERSON_BYTES);
+    BinaryWriter writer(blob);
+
+    writer.write<uint32_t>(SNAPSHOT_MAGIC);
+    writer.write<uint16_t>(SNAPSHOT_FORMAT_VERSION);
+    writer.write<uint16_t>(0); // Reserved
+    writer.write<int32_t>(m_numberOfLines);
+    writer.write<int32_t>(m_maxSize);
+    writer.write<int64_t>(Person::getSimulationStartTime());
+
+    // Running totals
+    writer.write<int32_t>(m_nextPersonId);
+    writer.write<int32_t>(m_totalPeopleEver);
+    writer.write<int32_t>(m_completedPeopleEver);
+    writer.write<int32_t>(m_abandonedPeopleEver);
+    writer.write<double>(m_totalExpectedWaitTime);
+    writer.write<double>(m_totalActualWaitTime);
+    writer.write<double>(m_currentArrivalRate);
+
+    // Lines: availability, throughput tracker, people front to back
+    for (int i = 0; i < m_numberOfLines; ++i)
+    {
+        const ThroughputTracker &tracker = m_throughputTrackers[i];
+        writer.write<uint8_t>(m_lineAvailability[i] ? 1 : 0);
+        writer.write<double>(tracker.getExpectedServiceRate());
+        writer.write<int32_t>(tracker.getServiceCount());
+        writer.write<double>(tracker.getCurrentThroughput());
+        writer.write<int64_t>(tracker.getSessionTimeMillis());
+        writer.write<int32_t>(tracker.getArrivalCount());
+        writer.write<int32_t>(tracker.getAbandonmentCount());
+        writer.write<int32_t>(tracker.getServerCount());
+        writer.write<int64_t>(tracker.getStaffedServerMillis());
+        writer.write<uint8_t>(m_lineClassMasks[i]);
+        for (int c = 0; c < CUSTOMER_CLASS_COUNT; ++c)
+        {
+            writer.write<int32_t>(tracker.getClassServiceCount(static_cast<CustomerClass>(c)));
+            writer.write<double>(tracker.getClassServiceSeconds(static_cast<CustomerClass>(c)));
+        }
+        writer.write<int32_t>(tracker.getDemandServiceCount());
+        writer.write<double>(tracker.getCompletedDemand());
+
+        // Abandoned entries still stored in the line are left out
+        writer.write<uint32_t>(static_cast<uint32_t>(activeCount(i)));
+        forEachPersonInLine(i + 1, [&writer](const Person &person)
+                            {
+                                writePerson(writer, person);
+                            });
+    }
+
+    // Last-hour history (offline backlog)
+    writer.write<uint32_t>(static_cast<uint32_t>(m_lastHourHistory.size()));
+    for (const Person &person : m_lastHourHistory)
+    {
+        writePerson(writer, person);
+    }
+
+    writer.write<uint32_t>(fnv1aChecksum(blob.data(), blob.size()));
+    return blob;
+}
+
+bool QueueManager::loadSnapshot(const uint8_t *data, size_t size)
+{
+    // Integrity check over everything but the trailing checksum
+    uint32_t storedChecksum = 0;
+    if (!data || size < sizeof(storedChecksum))
+    {
+        std::cerr << "❌ Snapshot rejected: empty or truncated" << std::endl;
+        return false;
+    }
+    size_t payloadSize = size - sizeof(storedChecksum);
+    std::memcpy(&storedChecksum, data + payloadSize, sizeof(storedChecksum));
+    if (fnv1aChecksum(data, payloadSize) != storedChecksum)
+    {
+        std::cerr << "❌ Snapshot rejected: checksum mismatch" << std::endl;
+        return false;
+    }
+
+    BinaryReader reader(data, payloadSize);
+    uint32_t magic = 0;
+    uint16_t formatVersion = 0, reserved = 0;
+    int32_t numberOfLines = 0, maxSize = 0;
+    int64_t simulationStartMillis = 0;
+    reader.read(magic);
+    reader.read(formatVersion);
+    reader.read(reserved);
+    reader.read(numberOfLines);
+    reader.read(maxSize);
+    reader.read(simulationStartMillis);
+    if (!reader.ok() || magic != SNAPSHOT_MAGIC || formatVersion != SNAPSHOT_FORMAT_VERSION)
+    {
+        std::cerr << "❌ Snapshot rejected: unknown format" << std::endl;
+        return false;
+    }
+    if (numberOfLines != m_numberOfLines)
+    {
+        std::cerr << "❌ Snapshot rejected: saved for " << numberOfLines << " lines, this manager has "
+                  << m_numberOfLines << std::endl;
+        return false;
+    }
+
+    int32_t nextPersonId = 0, totalPeopleEver = 0, completedPeopleEver = 0, abandonedPeopleEver = 0;
+    double totalExpectedWaitTime = 0.0, totalActualWaitTime = 0.0, arrivalRate = 0.0;
+    reader.read(nextPersonId);
+    reader.read(totalPeopleEver);
+    reader.read(completedPeopleEver);
+    reader.read(abandonedPeopleEver);
+    reader.read(totalExpectedWaitTime);
+    reader.read(totalActualWaitTime);
+    reader.read(arrivalRate);
+
+    // Decode into fresh containers first so a bad blob leaves the current state intact
+    std::vector<CopyOnWrite<RingBuffer<Person>>> lines;
+    std::vector<ThroughputTracker> trackers;
+    std::vector<bool> availability(m_numberOfLines, true);
+    std::vector<uint8_t> classMasks(m_numberOfLines, ALL_CUSTOMER_CLASSES);
+    lines.reserve(m_numberOfLines);
+    trackers.reserve(m_numberOfLines);
+    int totalPeople = 0;
+
+    for (int i = 0; i < m_numberOfLines; ++i)
+    {
+        uint8_t available = 1;
+        double expectedRate = 0.0, throughput = 0.0;
+        int32_t serviceCount = 0, arrivals = 0, abandonments = 0, servers = 1;
+        int64_t sessionMillis = 0, staffedMillis = 0;
+        uint8_t classMask = ALL_CUSTOMER_CLASSES;
+        int32_t classServiceCounts[CUSTOMER_CLASS_COUNT] = {};
+        double classServiceSeconds[CUSTOMER_CLASS_COUNT] = {};
+        int32_t demandServiceCount = 0;
+        double completedDemand = 0.0;
+        uint32_t peopleInLine = 0;
+        reader.read(available);
+        reader.read(expectedRate);
+        reader.read(serviceCount);
+        reader.read(throughput);
+        reader.read(sessionMillis);
+        reader.read(arrivals);
+        reader.read(abandonments);
+        reader.read(servers);
+        reader.read(staffedMillis);
+        reader.read(classMask);
+        for (int c = 0; c < CUSTOMER_CLASS_COUNT; ++c)
+        {
+            reader.read(classServiceCounts[c]);
+            reader.read(classServiceSeconds[c]);
+        }
+        reader.read(demandServiceCount);
+        reader.read(completedDemand);
+        reader.read(peopleInLine);
+        if (!reader.ok() || peopleInLine > reader.remaining() / SNAPSHOT_PERSON_BYTES)
+        {
+            std::cerr << "❌ Snapshot rejected: truncated line " << (i + 1) << std::endl;
+            return false;
+        }
+
+        availability[i] = available != 0;
+        classMasks[i] = (classMask & ALL_CUSTOMER_CLASSES) != 0 ? static_cast<uint8_t>(classMask & ALL_CUSTOMER_CLASSES)
+                                                                : ALL_CUSTOMER_CLASSES;
+        trackers.emplace_back(expectedRate);
+        trackers.back().restore(serviceCount, throughput, sessionMillis);
+        trackers.back().restoreAbandonment(arrivals, abandonments);
+        trackers.back().restoreStaffing(servers, staffedMillis);
+        for (int c = 0; c < CUSTOMER_CLASS_COUNT; ++c)
+        {
+            trackers.back().restoreClassService(static_cast<CustomerClass>(c), classServiceCounts[c], classServiceSeconds[c]);
+        }
+        trackers.back().restoreServiceDemand(demandServiceCount, completedDemand);
+
+        RingBuffer<Person> people(m_linePool);
+        people.reserve(peopleInLine);
+        Person person;
+        for (uint32_t p = 0; p < peopleInLine; ++p)
+        {
+            if (!readPerson(reader, person))
+            {
+                std::cerr << "❌ Snapshot rejected: truncated line " << (i + 1) << std::endl;
+                return false;
+            }
+            people.push_back(person);
+        }
+        lines.emplace_back(std::move(people));
+        totalPeople += static_cast<int>(peopleInLine);
+    }
+
+    uint32_t historyCount = 0;
+    reader.read(historyCount);
+    if (!reader.ok() || historyCount > reader.remaining() / SNAPSHOT_PERSON_BYTES)
+    {
+        std::cerr << "❌ Snapshot rejected: truncated history" << std::endl;
+        return false;
+    }
+    RingBuffer<Person> history(m_linePool);
+    history.reserve(std::min<size_t>(historyCount, MAX_HISTORY_ENTRIES));
+    Person person;
+    for (uint32_t h = 0; h < historyCount; ++h)
+    {
+        if (!readPerson(reader, person))
+        {
+            std::cerr << "❌ Snapshot rejected: truncated history" << std::endl;
+            return false;
+        }
+        if (static_cast<int>(history.size()) >= MAX_HISTORY_ENTRIES)
+        {
+            history.pop_front();
+        }
+        history.push_back(person);
+    }
+
+    // Everything decoded: commit
+    if (simulationStartMillis != 0)
+    {
+        Person::setSimulationStartTime(simulationStartMillis);
+    }
+    m_lines.swap(lines);
+    m_throughputTrackers.swap(trackers);
+    m_lineAvailability.swap(availability);
+    m_lineClassMasks.swap(classMasks);
+    m_lastHourHistory.swap(history);
+    m_completedArchive.clear();
+    m_totalPeople = totalPeople;
+    m_nextPersonId = nextPersonId;
+    m_totalPeopleEver = totalPeopleEver;
+    m_completedPeopleEver = completedPeopleEver;
+    m_abandonedPeopleEver = abandonedPeopleEver;
+    m_totalExpectedWaitTime = totalExpectedWaitTime;
+    m_totalActualWaitTime = totalActualWaitTime;
+    m_currentArrivalRate = arrivalRate;
+    for (int i = 0; i < m_numberOfLines; ++i)
+    {
+        m_expectedServiceRates[i] = m_throughputTrackers[i].getExpectedServiceRate();
+    }
+    // The index first: line estimates count people net of its tombstones, which must not be the old state's
+    rebuildPersonIndex();
+    rebuildLineSelection();
+
+    std::cout << "♻️  Restored snapshot: " << m_totalPeople << " people in line, "
+              << m_lastHourHistory.size() << " history entries, " << m_completedPeopleEver
+              << " completed" << std::endl;
+
+    // Republish the restored state (no-op without a cloud client)
+    writeToFirebase();
+    return true;
+}
+
+bool QueueManager::saveSnapshotToFile(const std::string &path) const
+{
+    std::vector<uint8_t> blob = saveSnapshot();
+    std::string tempPath = path + ".tmp";
+
+    FILE *file = std::fopen(tempPath.c_str(), "wb");
+    if (!file)
+    {
+        std::cerr << "❌ Cannot write snapshot " << tempPath << std::endl;
+        return false;
+    }
+    bool written = std::fwrite(blob.data(), 1, blob.size(), file) == blob.size();
+    written = (std::fclose(file) == 0) && written;
+
+    // Replace the previous snapshot only once the new one is complete
+    bool renamed = written && std::rename(tempPath.c_str(), path.c_str()) == 0;
+    if (written && !renamed)
+    {
+        std::remove(path.c_str()); // Some platforms do not rename over an existing file
+        renamed = std::rename(tempPath.c_str(), path.c_str()) == 0;
+    }
+    if (!renamed)
+    {
+        std::cerr << "❌ Failed to store snapshot " << path << std::endl;
+        std::remove(tempPath.c_str());
+        return false;
+    }
+    return true;
+}
+
+bool QueueManager::loadSnapshotFromFile(const std::string &path)
+{
+    FILE *file = std::fopen(path.c_str(), "rb");
+    if (!file)
+    {
+        return false; // No snapshot yet - normal on first start
+    }
+
+    std::vector<uint8_t> blob;
+    uint8_t chunk[512];
+    size_t bytesRead;
+    while ((bytesRead = std::fread(chunk, 1, sizeof(chunk), file)) > 0)
+    {
+        blob.insert(blob.end(), chunk, chunk + bytesRead);
+    }
+    std::fclose(file);
+
+    return loadSnapshot(blob.data(), blob.size());
+}
+
+int QueueManager::size() const
+{
+    return m_totalPeople;
+}
+
+bool QueueManager::isEmpty() const
+{
+    return m_totalPeople == 0;
+}
+
+int QueueManager::getNextLineNumber(LineSelectionStrategy strategy, CustomerClass customerClass) const
+{
+    if (m_numberOfLines == 0)
+    {
+        return -1;
+    }
+
+    int strategyIndex = static_cast<int>(strategy);
+    if (strategyIndex < 0 || strategyIndex >= static_cast<int>(m_strategies.size()))
+    {
+        strategyIndex = static_cast<int>(LineSelectionStrategy::SHORTEST_WAIT_TIME);
+    }
+
+    // Strategies keep lines at capacity or unavailable (sensor failed) out of their ranking, and a
+    // class's own ranking also keeps out lines that do not serve it
+    int lineIndex = strategiesFor(customerClass)[strategyIndex]->select();
+    return lineIndex < 0 ? -1 : lineIndex + 1;
+}
+
+int QueueManager::recommendLine(LineSelectionStrategy strategy, CustomerClass customerClass)
+{
+    expireRecommendations(Person::getCurrentTimestamp());
+
+    int lineNumber = getNextLineNumber(strategy, customerClass);
+    if (lineNumber == -1)
+    {
+        return -1;
+    }
+
+    int lineIndex = lineNumber - 1;
+    m_recommendations.push_back(PendingRecommendation{lineIndex, Person::getCurrentTimestamp()});
+    m_pendingCounts[lineIndex]++;
+    refreshLineSelection(lineIndex, LineChange::RECOMMENDATION);
+    return lineNumber;
+}
+
+int QueueManager::getPendingRecommendations(int lineNumber) const
+{
+    if (!isValidLineNumber(lineNumber))
+    {
+        return -1;
+    }
+
+    return m_pendingCounts[lineNumber - 1];
+}
+
+void QueueManager::setRecommendationTimeout(int seconds)
+{
+    m_recommendationTimeout = std::max(0, seconds);
+}
+
+void QueueManager::expireRecommendations(long long now)
+{
+    while (!m_recommendations.empty() && m_recommendations.front().issuedAt + m_recommendationTimeout <= now)
+    {
+        int lineIndex = m_recommendations.front().lineIndex;
+        m_recommendations.pop_front();
+
+        // Arrivals consume the oldest entries of their line, so the oldest stored entry of a line is
+        // an arrived one while any are left
+        if (m_arrivedUnexpired[lineIndex] > 0)
+        {
+            m_arrivedUnexpired[lineIndex]--;
+        }
+        else if (m_pendingCounts[lineIndex] > 0)
+        {
+            m_pendingCounts[lineIndex]--;
+            refreshLineSelection(lineIndex, LineChange::RECOMMENDATION);
+        }
+    }
+}
+
+bool QueueManager::addStrategy(std::unique_ptr<SelectionStrategy> strategy, LineSelectionStrategy *id)
+{
+    if (!strategy)
+    {
+        std::cerr << "❌ addStrategy: strategy is null" << std::endl;
+        return false;
+    }
+    if (static_cast<int>(m_strategies.size()) >= MAX_STRATEGIES)
+    {
+        std::cerr << "❌ addStrategy: at most " << MAX_STRATEGIES << " strategies per QueueManager" << std::endl;
+        return false;
+    }
+
+    for (int i = 0; i < m_numberOfLines; ++i)
+    {
+        m_lineStatusScratch[i] = lineStatus(i);
+    }
+    strategy->reset(m_lineStatusScratch.data(), m_numberOfLines);
+    m_strategies.push_back(std::move(strategy));
+    rebuildClassRankings(); // Classes with their own ranking get a clone with their eligible lines
+    if (id)
+    {
+        *id = static_cast<LineSelectionStrategy>(m_strategies.size() - 1);
+    }
+    return true;
+}
+
+bool QueueManager::addStrategy(const std::string &registeredName, LineSelectionStrategy *id)
+{
+    std::unique_ptr<SelectionStrategy> strategy = StrategyRegistry::create(registeredName);
+    if (!strategy)
+    {
+        std::cerr << "❌ addStrategy: no strategy registered as '" << registeredName << "'" << std::endl;
+        return false;
+    }
+    return addStrategy(std::move(strategy), id);
+}
+
+bool QueueManager::findStrategy(const std::string &name, LineSelectionStrategy &id) const
+{
+    for (size_t i = 0; i < m_strategies.size(); ++i)
+    {
+        if (name == m_strategies[i]->getName())
+        {
+            id = static_cast<LineSelectionStrategy>(i);
+            return true;
+        }
+    }
+    return false;
+}
+
+const SelectionStrategy *QueueManager::getStrategy(LineSelectionStrategy strategy) const
+{
+    int strategyIndex = static_cast<int>(strategy);
+    if (strategyIndex < 0 || strategyIndex >= static_cast<int>(m_strategies.size()))
+    {
+        return nullptr;
+    }
+    return m_strategies[strategyIndex].get();
+}
+
+int QueueManager::getStrategyCount() const
+{
+    return static_cast<int>(m_strategies.size());
+}
+
+LineSelectionStrategy QueueManager::getEffectiveStrategy(LineSelectionStrategy strategy) const
+{
+    if (strategy != LineSelectionStrategy::ADAPTIVE)
+    {
+        return strategy;
+    }
+    const auto *adaptive = static_cast<const AdaptiveStrategy *>(m_strategies[static_cast<int>(strategy)].get());
+    return adaptive->getActiveStrategy();
+}
+
+uint64_t QueueManager::getStateVersion() const
+{
+    return m_stateVersion;
+}
+
+int QueueManager::getLineCount(int lineNumber) const
+{
+    if (!isValidLineNumber(lineNumber))
+    {
+        return -1;
+    }
+
+    return activeCount(lineNumber - 1);
+}
+
+int QueueManager::getLineCount(int lineNumber, CustomerClass customerClass) const
+{
+    if (!isValidLineNumber(lineNumber))
+    {
+        return -1;
+    }
+
+    return m_classCounts[lineNumber - 1][static_cast<int>(customerClass)];
+}
+
+double QueueManager::getOutstandingWork(int lineNumber) const
+{
+    if (!isValidLineNumber(lineNumber))
+    {
+        return -1.0;
+    }
+
+    return m_outstandingWork[lineNumber - 1];
+}
+
+bool QueueManager::isValidLineNumber(int lineNumber) const
+{
+    return lineNumber >= 1 && lineNumber <= m_numberOfLines;
+}
+
+bool QueueManager::isLineAtCapacity(int lineIndex) const
+{
+    return m_maxSize > 0 && activeCount(lineIndex) >= m_maxSize;
+}
+
+bool QueueManager::hasRoomFor(int lineIndex, int people) const
+{
+    return m_maxSize <= 0 || activeCount(lineIndex) + people <= m_maxSize;
+}
+
+int QueueManager::findLineWithRoomFor(int people, CustomerClass customerClass) const
+{
+    int best = -1;
+    for (int i = 0; i < m_numberOfLines; ++i)
+    {
+        if (!m_lineAvailability[i] || !(m_lineClassMasks[i] & customerClassBit(customerClass)) || !hasRoomFor(i, people))
+        {
+            continue;
+        }
+        if (best < 0 || m_waitEstimates[i] < m_waitEstimates[best])
+        {
+            best = i;
+        }
+    }
+    return best < 0 ? -1 : best + 1;
+}
+
+LineStatus QueueManager::lineStatus(int lineIndex) const
+{
+    LineStatus status;
+    status.lineIndex = lineIndex;
+    status.people = activeCount(lineIndex);
+    status.waitEstimate = m_waitEstimates[lineIndex];
+    status.serviceRate = m_throughputTrackers[lineIndex].getCurrentThroughput();
+    status.expectedServiceRate = m_expectedServiceRates[lineIndex] * m_throughputTrackers[lineIndex].getServerCount();
+    status.outstandingWork = m_outstandingWork[lineIndex];
+    status.workRate = m_throughputTrackers[lineIndex].getWorkThroughput();
+    status.pending = m_pendingCounts[lineIndex];
+    status.arrivalForecast = m_numberOfLines > 0 ? m_currentArrivalRate / m_numberOfLines : 0.0;
+    status.walkSeconds = m_walkSeconds[lineIndex];
+    status.eligible = !isLineAtCapacity(lineIndex) && m_lineAvailability[lineIndex];
+    status.reliable = m_throughputTrackers[lineIndex].hasReliableData();
+    return status;
+}
+
+void QueueManager::refreshLineSelection(int lineIndex, LineChange change)
+{
+    // Only this line's occupancy, throughput or availability changed: re-estimate it alone
+    m_waitEstimates[lineIndex] = computeWaitEstimate(lineIndex);
+    m_stateVersion++;
+    m_lineVersions[lineIndex] = m_stateVersion;
+
+    auto notify = [change](std::vector<std::unique_ptr<SelectionStrategy>> &strategies, const LineStatus &status)
+    {
+        for (auto &strategy : strategies)
+        {
+            switch (change)
+            {
+            case LineChange::ARRIVAL:
+                strategy->onArrival(status);
+                break;
+            case LineChange::SERVICE:
+                strategy->onService(status);
+                break;
+            case LineChange::ABANDONMENT:
+                strategy->onAbandonment(status);
+                break;
+            case LineChange::AVAILABILITY:
+                strategy->onAvailabilityChange(status);
+                break;
+            case LineChange::ESTIMATE:
+            case LineChange::RECOMMENDATION:
+                strategy->onLineChanged(status);
+                break;
+            }
+        }
+    };
+
+    LineStatus status = lineStatus(lineIndex);
+    notify(m_strategies, status);
+
+    // Classes some line refuses keep their own ranking, where a line not serving them is never eligible
+    for (int c = 0; c < CUSTOMER_CLASS_COUNT; ++c)
+    {
+        if (!m_classStrategies[c].empty())
+        {
+            LineStatus classStatus = status;
+            classStatus.eligible = status.eligible && (m_lineClassMasks[lineIndex] & customerClassBit(static_cast<CustomerClass>(c)));
+            notify(m_classStrategies[c], classStatus);
+        }
+    }
+
+    if (m_rebalanceThreshold > 0.0)
+    {
+        refreshRebalanceHeaps(lineIndex);
+        updateRebalanceRecommendation();
+    }
+}
+
+void QueueManager::rebuildLineSelection()
+{
+    // Only lines rebuilt from scratch (construction, snapshot, replay) get here: nobody is on their way
+    m_recommendations.clear();
+    m_pendingCounts.assign(m_numberOfLines, 0);
+    m_arrivedUnexpired.assign(m_numberOfLines, 0);
+    m_outstandingWork.assign(m_numberOfLines, 0.0);
+    m_classCounts.assign(m_numberOfLines, std::array<int, CUSTOMER_CLASS_COUNT>());
+    for (int i = 0; i < m_numberOfLines; ++i)
+    {
+        for (const Person &person : *m_lines[i])
+        {
+            if (!person.hasAbandoned())
+            {
+                m_outstandingWork[i] += person.getServiceDemand();
+                m_classCounts[i][static_cast<int>(person.getCustomerClass())]++;
+            }
+        }
+    }
+    m_waitEstimates.assign(m_numberOfLines, 0.0);
+    m_lineVersions.assign(m_numberOfLines, 0);
+    m_publishedLineVersions.resize(m_numberOfLines, 0); // Every line gets a new version below, so all are republished
+    m_lineStatusScratch.resize(m_numberOfLines);
+    m_stateVersion++;
+    for (int i = 0; i < m_numberOfLines; ++i)
+    {
+        m_waitEstimates[i] = computeWaitEstimate(i);
+        m_lineVersions[i] = m_stateVersion;
+        m_lineStatusScratch[i] = lineStatus(i);
+    }
+    for (auto &strategy : m_strategies)
+    {
+        strategy->reset(m_lineStatusScratch.data(), m_numberOfLines);
+    }
+    rebuildClassRankings();
 
-    // If this person is first in line, set their exit timestamp immediately
-    if (line.size() == 1)
+    if (m_rebalanceThreshold > 0.0)
     {
-        line.front().recordExit();
-        // Update completion statistics
-        m_completedPeopleEver++;
-        m_totalActualWaitTime += line.front().getActualWaitTime();
+        rebuildRebalanceHeaps();
+        updateRebalanceRecommendation();
     }
-
-    // Automatically write to Firebase after state change
-    writeToFirebase();
-
-    return true;
 }
 
-int QueueManager::size() const
+void QueueManager::rebuildClassRankings()
 {
-    return m_totalPeople;
-}
+    for (int c = 0; c < CUSTOMER_CLASS_COUNT; ++c)
+    {
+        uint8_t classBit = customerClassBit(static_cast<CustomerClass>(c));
+        m_classStrategies[c].clear();
+        bool servedEverywhere = true;
+        for (int i = 0; i < m_numberOfLines; ++i)
+        {
+            servedEverywhere = servedEverywhere && (m_lineClassMasks[i] & classBit);
+        }
+        if (servedEverywhere)
+        {
+            continue; // The shared ranking already is this class's ranking
+        }
 
-bool QueueManager::isEmpty() const
-{
-    return m_totalPeople == 0;
+        for (int i = 0; i < m_numberOfLines; ++i)
+        {
+            m_lineStatusScratch[i] = lineStatus(i);
+            m_lineStatusScratch[i].eligible = m_lineStatusScratch[i].eligible && (m_lineClassMasks[i] & classBit);
+        }
+        m_classStrategies[c].reserve(m_strategies.size());
+        for (const auto &strategy : m_strategies)
+        {
+            m_classStrategies[c].push_back(strategy->clone());
+            m_classStrategies[c].back()->reset(m_lineStatusScratch.data(), m_numberOfLines);
+        }
+    }
 }
 
-int QueueManager::getNextLineNumber(LineSelectionStrategy strategy) const
+void QueueManager::refreshRebalanceHeaps(int lineIndex)
 {
-    if (m_numberOfLines == 0)
+    // Someone not yet at a register could move; the wait of the last of them is the line's worst
+    int people = activeCount(lineIndex);
+    if (m_lineAvailability[lineIndex] && people > m_throughputTrackers[lineIndex].getServerCount())
     {
-        return -1;
+        m_longestTails.update(static_cast<size_t>(lineIndex), -remainingWaitAt(lineIndex, people));
     }
-
-    // Check if a line is at capacity OR unavailable (sensor failed)
-    auto isLineAtCapacity = [this](int lineIndex) -> bool
+    else
     {
-        return m_maxSize > 0 && static_cast<int>(m_lines[lineIndex].size()) >= m_maxSize;
-    };
-
+        m_longestTails.remove(static_cast<size_t>(lineIndex));
+    }
 
-    switch (strategy)
+    // People already sent to a line are ahead of anyone moving there now
+    if (m_lineAvailability[lineIndex] && !isLineAtCapacity(lineIndex))
     {
-    case LineSelectionStrategy::SHORTEST_WAIT_TIME:
+        m_shortestWaits.update(static_cast<size_t>(lineIndex),
+                               remainingWaitAt(lineIndex, people + m_pendingCounts[lineIndex] + 1));
+    }
+    else
     {
-        double minWaitTime = std::numeric_limits<double>::max();
-        int bestLine = -1;
-
-        for (int i = 1; i <= m_numberOfLines; i++)
-        {
-            if (isLineAtCapacity(i - 1) || !isLineAvailable(i))
-                continue;
-            double waitTime = getEstimatedWaitTimeForNewPerson(i);
-            if (waitTime < minWaitTime)
-            {
-                minWaitTime = waitTime;
-                bestLine = i;
-            }
-        }
-        return bestLine;
+        m_shortestWaits.remove(static_cast<size_t>(lineIndex));
     }
+}
 
-    case LineSelectionStrategy::FEWEST_PEOPLE:
+void QueueManager::rebuildRebalanceHeaps()
+{
+    m_longestTails.resize(static_cast<size_t>(m_numberOfLines));
+    m_shortestWaits.resize(static_cast<size_t>(m_numberOfLines));
+    for (int i = 0; i < m_numberOfLines; ++i)
     {
-        int minPeople = std::numeric_limits<int>::max();
-        int bestLine = -1;
-
-        for (int i = 0; i < m_numberOfLines; i++)
-        {
-            if (isLineAtCapacity(i) || !isLineAvailable(i + 1))
-                continue;
-            int peopleCount = static_cast<int>(m_lines[i].size());
-            if (peopleCount < minPeople)
-            {
-                minPeople = peopleCount;
-                bestLine = i + 1;
-            }
-        }
-        return bestLine;
+        refreshRebalanceHeaps(i);
     }
+}
 
-    case LineSelectionStrategy::FARTHEST_FROM_ENTRANCE:
+void QueueManager::updateRebalanceRecommendation()
+{
+    RebalanceMove move;
+    if (m_rebalanceThreshold > 0.0 && !m_longestTails.empty() && !m_shortestWaits.empty())
     {
-        int bestLine = -1;
+        int from = static_cast<int>(m_longestTails.top());
+        int to = static_cast<int>(m_shortestWaits.top());
 
-        // Find the farthest line that's not at capacity and is available
-        for (int i = m_numberOfLines; i >= 1; i--)
+        // Lines are reached from the same hostess station, so the walk between two of them is at
+        // least the difference of their walks from it
+        double walkBetween = std::fabs(m_walkSeconds[from] - m_walkSeconds[to]);
+        if (from != to && -m_longestTails.topKey() - m_shortestWaits.topKey() - walkBetween >= m_rebalanceThreshold)
         {
-            if (!isLineAtCapacity(i - 1) && isLineAvailable(i))
+            // Take people from the tail while each still saves enough: the next one forward has less
+            // left to wait here and would stand one place further back there
+            const RingBuffer<Person> &line = *m_lines[from];
+            int servers = m_throughputTrackers[from].getServerCount();
+            int position = activeCount(from);
+            int aheadThere = activeCount(to) + m_pendingCounts[to];
+            for (size_t i = line.size(); i-- > 0 && position > servers;)
             {
-                bestLine = i;
-                break;
+                const Person &person = line[i];
+                if (person.hasAbandoned())
+                {
+                    continue;
+                }
+                if (!(m_lineClassMasks[to] & customerClassBit(person.getCustomerClass())) || !hasRoomFor(to, move.people + 1))
+                {
+                    break; // Moving anyone further forward would mean skipping past this person
+                }
+                double gain = remainingWaitAt(from, position) - remainingWaitAt(to, aheadThere + move.people + 1) - walkBetween;
+                if (gain < m_rebalanceThreshold)
+                {
+                    break;
+                }
+                move.people++;
+                move.firstPosition = position;
+                move.firstPersonId = person.getPersonId();
+                move.gainSeconds += gain;
+                position--;
+            }
+            if (move.people > 0)
+            {
+                move.fromLine = from + 1;
+                move.toLine = to + 1;
             }
         }
-        return bestLine;
     }
 
-    case LineSelectionStrategy::NEAREST_TO_ENTRANCE:
+    // Only changes are events: people served at the front shift positions but not the advice
+    if (m_rebalanceStanding)
     {
-        // Find the nearest line (line 1) that's available and not at capacity
-        for (int i = 1; i <= m_numberOfLines; i++)
+        const RebalanceMove &standing = m_rebalanceMoves.back();
+        if (move.fromLine == standing.fromLine && move.toLine == standing.toLine && move.people == standing.people)
         {
-            if (!isLineAtCapacity(i - 1) && isLineAvailable(i))
-            {
-                return i;
-            }
+            return;
         }
-        return -1; // No available lines
     }
-
-    default:
-        return getNextLineNumber(LineSelectionStrategy::SHORTEST_WAIT_TIME);
+    else if (move.people == 0)
+    {
+        return;
     }
-}
 
-int QueueManager::getLineCount(int lineNumber) const
-{
-    if (!isValidLineNumber(lineNumber))
+    move.sequence = ++m_rebalanceSequence;
+    move.issuedAt = Person::getCurrentTimestamp();
+    if (m_rebalanceMoves.size() >= static_cast<size_t>(REBALANCE_HISTORY))
     {
-        return -1;
+        m_rebalanceMoves.pop_front();
     }
-
-    return static_cast<int>(m_lines[lineNumber - 1].size());
+    m_rebalanceMoves.push_back(move);
+    m_rebalanceStanding = move.people > 0;
 }
 
-bool QueueManager::isValidLineNumber(int lineNumber) const
+const std::vector<std::unique_ptr<SelectionStrategy>> &QueueManager::strategiesFor(CustomerClass customerClass) const
 {
-    return lineNumber >= 1 && lineNumber <= m_numberOfLines;
+    const auto &classStrategies = m_classStrategies[static_cast<int>(customerClass)];
+    return classStrategies.empty() ? m_strategies : classStrategies;
 }
 
 double QueueManager::getEstimatedWaitTime(int lineNumber) const
@@ -404,13 +1764,17 @@ double QueueManager::getEstimatedWaitTime(int lineNumber) const
         return 999.0; // Return high wait time for invalid lines
     }
 
-    int peopleInLine = static_cast<int>(m_lines[lineNumber - 1].size());
+    return m_waitEstimates[lineNumber - 1];
+}
 
-    // Use enhanced throughput tracker with M/M/1 queue theory
-    const auto &tracker = m_throughputTrackers[lineNumber - 1];
+double QueueManager::getEstimatedWaitTime(int lineNumber, CustomerClass customerClass) const
+{
+    if (!isValidLineNumber(lineNumber) || !(m_lineClassMasks[lineNumber - 1] & customerClassBit(customerClass)))
+    {
+        return 999.0; // Same as an invalid line: never the better choice
+    }
 
-    // Get estimated wait time using M/M/1 queue theory
-    return tracker.getEstimatedWaitTime(peopleInLine, m_currentArrivalRate);
+    return m_waitEstimates[lineNumber - 1];
 }
 
 double QueueManager::getEstimatedWaitTimeForNewPerson(int lineNumber) const
@@ -420,14 +1784,28 @@ double QueueManager::getEstimatedWaitTimeForNewPerson(int lineNumber) const
         return 999.0; // Return high wait time for invalid lines
     }
 
-    int peopleInLine = static_cast<int>(m_lines[lineNumber - 1].size());
-
-    // Use enhanced throughput tracker with M/M/1 queue theory
-    const auto &tracker = m_throughputTrackers[lineNumber - 1];
-
     // Expected wait time for new person = time until they become first in line
     // This accounts for people currently ahead of them
-    return tracker.getEstimatedWaitTime(peopleInLine, m_currentArrivalRate);
+    return m_waitEstimates[lineNumber - 1];
+}
+
+double QueueManager::computeWaitEstimate(int lineIndex) const
+{
+    int peopleInLine = activeCount(lineIndex);
+
+    // Use enhanced throughput tracker with M/M/c queue theory, scaled by how quickly the classes
+    // waiting are served compared with the line's usual mix (1.0 while everyone is STANDARD)
+    const auto &tracker = m_throughputTrackers[lineIndex];
+    return tracker.getEstimatedWaitTime(peopleInLine) *
+           tracker.getClassMixFactor(m_classCounts[lineIndex].data());
+}
+
+double QueueManager::remainingWaitAt(int lineIndex, int position) const
+{
+    // Same model as a new arrival, counting only the people ahead
+    const auto &tracker = m_throughputTrackers[lineIndex];
+    return tracker.getEstimatedWaitTime(position - 1) *
+           tracker.getClassMixFactor(m_classCounts[lineIndex].data());
 }
 
 // Cloud integration methods
@@ -445,8 +1823,7 @@ void QueueManager::clearCloudData()
         // Clear all queue line data
         for (int i = 1; i <= m_numberOfLines; ++i)
         {
-            std::string queuePath = "simulation" + m_strategyPrefix + "/queues/line" + std::to_string(i);
-            if (m_firebaseClient->deleteData(queuePath))
+            if (m_firebaseClient->deleteData(m_lineCloudPaths[i - 1]))
             {
                 std::cout << "✅ Successfully cleared existing queue data for "
                           << (m_strategyPrefix.empty() ? "" : m_strategyPrefix.substr(1) + " ")
@@ -461,8 +1838,7 @@ void QueueManager::clearCloudData()
         }
 
         // Clear the recommended choice data
-        std::string aggPath = "simulation" + m_strategyPrefix + "/recommendedChoice";
-        if (m_firebaseClient->deleteData(aggPath))
+        if (m_firebaseClient->deleteData(m_recommendedChoicePath))
         {
             std::cout << "✅ Successfully cleared recommended choice data" << std::endl;
         }
@@ -472,8 +1848,7 @@ void QueueManager::clearCloudData()
         }
 
         // Optional: Also clear the entire simulation node to ensure a fresh start
-        std::string simulationPath = "simulation" + m_strategyPrefix;
-        if (m_firebaseClient->deleteData(simulationPath))
+        if (m_firebaseClient->deleteData(m_cloudRootPath))
         {
             std::cout << "✅ Successfully cleared all "
                       << (m_strategyPrefix.empty() ? "" : m_strategyPrefix.substr(1) + " ")
@@ -497,16 +1872,17 @@ void QueueManager::clearCloudData()
 
 bool QueueManager::writeToFirebase(LineSelectionStrategy strategy)
 {
-    if (!m_firebaseClient)
+    if (!m_firebaseClient || !m_cloudPublishingEnabled)
     {
-        // No Firebase client configured - this is optional functionality
+        // No Firebase client configured or publishing paused - this is optional functionality
         return false;
     }
 
     try
     {
         // Collect data for all lines
-        std::vector<FirebaseStructureBuilder::LineData> allLinesData;
+        std::vector<FirebaseStructureBuilder::LineData> &allLinesData = m_lineDataScratch;
+        allLinesData.clear();
         int totalPeople = 0;
 
         for (int line = 1; line <= m_numberOfLines; ++line)
@@ -528,9 +1904,8 @@ bool QueueManager::writeToFirebase(LineSelectionStrategy strategy)
 
             // Generate JSON and write to Firebase for this specific line
             std::string json = FirebaseStructureBuilder::generateLineDataJson(lineData);
-            std::string queuePath = "simulation" + m_strategyPrefix + "/queues/line" + std::to_string(line);
 
-            if (m_firebaseClient->updateData(queuePath, json))
+            if (m_firebaseClient->updateData(m_lineCloudPaths[line - 1], json))
             {
                 std::cout << "✅ " << (m_strategyPrefix.empty() ? "" : m_strategyPrefix.substr(1) + " ")
                           << "Line " << line << " updated - Occupancy: " << currentOccupancy
@@ -557,9 +1932,8 @@ bool QueueManager::writeToFirebase(LineSelectionStrategy strategy)
                 FirebaseStructureBuilder::createAggregatedData(allLinesData.data(), totalPeople, static_cast<int>(allLinesData.size()), currentRecommendation);
 
             std::string aggJson = FirebaseStructureBuilder::generateAggregatedDataJson(aggData);
-            std::string aggPath = "simulation" + m_strategyPrefix + "/recommendedChoice";
 
-            if (m_firebaseClient->updateData(aggPath, aggJson))
+            if (m_firebaseClient->updateData(m_recommendedChoicePath, aggJson))
             {
                 std::cout << "✅ Recommended choice " << (m_strategyPrefix.empty() ? "" : m_strategyPrefix.substr(1) + " ")
                           << "updated (simulation" << m_strategyPrefix << "/recommendedChoice) totalPeople=" << totalPeople
@@ -576,17 +1950,30 @@ bool QueueManager::writeToFirebase(LineSelectionStrategy strategy)
             }
         }
 
-        // Write individual people data to Firebase
-        std::vector<Person> allPeople = getAllPeople();
+        // Latest rebalancing advice, when it changed (people = 0 withdraws the previous one)
+        if (m_rebalanceSequence > m_publishedRebalanceSequence && !m_rebalanceMoves.empty())
+        {
+            const RebalanceMove &move = m_rebalanceMoves.back();
+            FirebaseStructureBuilder::RebalanceData rebalanceData(move.fromLine, move.toLine, move.people,
+                                                                  move.firstPosition, move.gainSeconds);
+            if (m_firebaseClient->updateData(m_rebalancePath, FirebaseStructureBuilder::generateRebalanceJson(rebalanceData)))
+            {
+                m_publishedRebalanceSequence = move.sequence;
+                std::cout << "✅ Rebalance advice updated: move " << move.people << " from line " << move.fromLine
+                          << " to line " << move.toLine << std::endl;
+            }
+            else
+            {
+                std::cerr << "❌ Failed to update rebalance advice" << std::endl;
+            }
+        }
 
         // Write cumulative people summary (includes all people from entire simulation)
         FirebasePeopleStructureBuilder::PeopleSummary summary = getCumulativePeopleSummary();
 
         std::string summaryJson = FirebasePeopleStructureBuilder::generatePeopleSummaryJson(summary);
-        std::string summaryPath = "simulation" + m_strategyPrefix + "/" +
-                                  FirebasePeopleStructureBuilder::getPeopleSummaryPath();
 
-        if (m_firebaseClient->updateData(summaryPath, summaryJson))
+        if (m_firebaseClient->updateData(m_peopleSummaryPath, summaryJson))
         {
             std::cout << "✅ Overall stats updated: " << summary.totalPeople
                       << " total, " << summary.activePeople << " active, "
@@ -597,26 +1984,70 @@ bool QueueManager::writeToFirebase(LineSelectionStrategy strategy)
             std::cerr << "❌ Failed to update overall stats" << std::endl;
         }
 
-        // Write individual people data (limit to recent people to avoid overwhelming Firebase)
+        // Write individual people data with their live ETA, only for lines that changed since they
+        // were last published (limited per publish to avoid overwhelming Firebase). A publish cut
+        // short resumes where it stopped, and lines take turns so busy lines cannot starve the rest.
         int peopleWritten = 0;
         const int MAX_PEOPLE_TO_WRITE = 50; // Limit to avoid Firebase quota issues
+        bool writeFailed = false;
 
-        for (const auto &person : allPeople)
+        for (int step = 0; step < m_numberOfLines && !writeFailed; ++step)
         {
-            if (peopleWritten >= MAX_PEOPLE_TO_WRITE)
-                break;
-
-            FirebasePeopleStructureBuilder::PersonData personData(person);
-            std::string personJson = FirebasePeopleStructureBuilder::generatePersonDataJson(personData);
-            std::string personPath = "simulation" + m_strategyPrefix + "/" +
-                                     FirebasePeopleStructureBuilder::getPersonDataPath(person.getId());
+            int lineIndex = (m_etaCursorLine + step) % m_numberOfLines;
+            uint64_t lineVersion = m_lineVersions[lineIndex];
+            if (lineVersion <= m_publishedLineVersions[lineIndex])
+            {
+                continue;
+            }
 
-            if (m_firebaseClient->updateData(personPath, personJson))
+            // People already written for this version of the line are skipped
+            int skip = lineIndex == m_etaCursorLine && m_etaCursorVersion == lineVersion ? m_etaCursorPosition : 0;
+            int position = 0;
+            bool complete = true;
+            forEachPersonInLine(lineIndex + 1, [&](const Person &person)
+                                {
+                                    if (!complete || ++position <= skip)
+                                    {
+                                        return;
+                                    }
+                                    if (peopleWritten == MAX_PEOPLE_TO_WRITE)
+                                    {
+                                        complete = false;
+                                        return;
+                                    }
+                                    FirebasePeopleStructureBuilder::PersonData personData(person, position, remainingWaitAt(lineIndex, position));
+                                    std::string personJson = FirebasePeopleStructureBuilder::generatePersonDataJson(personData);
+                                    std::string personPath = m_cloudRootPath + "/" +
+                                                             FirebasePeopleStructureBuilder::getPersonDataPath(person.getId());
+
+                                    if (m_firebaseClient->updateData(personPath, personJson))
+                                    {
+                                        peopleWritten++;
+                                    }
+                                    else
+                                    {
+                                        writeFailed = true;
+                                        complete = false;
+                                    }
+                                });
+
+            if (!complete)
             {
-                peopleWritten++;
+                // Retry from the first person not written
+                m_etaCursorLine = lineIndex;
+                m_etaCursorVersion = lineVersion;
+                m_etaCursorPosition = position - 1;
+                break;
             }
+            m_publishedLineVersions[lineIndex] = lineVersion;
+            m_etaCursorLine = (lineIndex + 1) % m_numberOfLines;
+            m_etaCursorPosition = 0;
         }
 
+        if (writeFailed)
+        {
+            std::cerr << "❌ Failed to update individual people records" << std::endl;
+        }
         if (peopleWritten > 0)
         {
             std::cout << "✅ Updated " << peopleWritten << " individual people records" << std::endl;
@@ -634,14 +2065,12 @@ bool QueueManager::writeToFirebase(LineSelectionStrategy strategy)
 std::vector<Person> QueueManager::getAllPeople() const
 {
     std::vector<Person> allPeople;
+    allPeople.reserve(m_totalPeople);
 
-    for (const auto &line : m_lines)
-    {
-        for (const auto &person : line)
-        {
-            allPeople.push_back(person);
-        }
-    }
+    forEachPerson([&allPeople](const Person &person)
+                  {
+                      allPeople.push_back(person);
+                  });
 
     return allPeople;
 }
@@ -649,19 +2078,51 @@ std::vector<Person> QueueManager::getAllPeople() const
 std::vector<Person> QueueManager::getPeopleInLine(int lineNumber) const
 {
     std::vector<Person> people;
+    forEachPersonInLine(lineNumber, [&people](const Person &person) // Nothing for an invalid line
+                        {
+                            people.push_back(person);
+                        });
+    return people;
+}
 
-    if (!isValidLineNumber(lineNumber))
+int QueueManager::getLineNumberOfPerson(int personId) const
+{
+    return m_personIndex->lineIndexOf(personId) + 1; // -1 (not waiting) maps to 0
+}
+
+int QueueManager::getPosition(int personId) const
+{
+    return m_personIndex->positionOf(personId);
+}
+
+double QueueManager::getRemainingWait(int personId) const
+{
+    int position = m_personIndex->positionOf(personId);
+    if (position == 0)
     {
-        return people; // Return empty vector for invalid line
+        return -1.0;
     }
 
-    const auto &line = m_lines[lineNumber - 1];
-    for (const auto &person : line)
+    return remainingWaitAt(m_personIndex->lineIndexOf(personId), position);
+}
+
+const Person *QueueManager::peekFront(int lineNumber) const
+{
+    if (!isValidLineNumber(lineNumber) || m_lines[lineNumber - 1]->empty())
     {
-        people.push_back(person);
+        return nullptr;
     }
+    return &m_lines[lineNumber - 1]->front();
+}
 
-    return people;
+QueueManager::LineView QueueManager::getLineView(int lineNumber, int limit) const
+{
+    if (!isValidLineNumber(lineNumber))
+    {
+        return LineView();
+    }
+    const auto &line = *m_lines[lineNumber - 1];
+    return line.view(limit < 0 ? line.size() : static_cast<size_t>(limit));
 }
 
 FirebasePeopleStructureBuilder::PeopleSummary QueueManager::getCumulativePeopleSummary() const
@@ -674,47 +2135,58 @@ FirebasePeopleStructureBuilder::PeopleSummary QueueManager::getCumulativePeopleS
     double averageActualWait = completedPeople > 0 ? m_totalActualWaitTime / completedPeople : 0.0;
 
     return FirebasePeopleStructureBuilder::PeopleSummary(
-        totalPeople, activePeople, completedPeople, averageExpectedWait, averageActualWait);
+        totalPeople, activePeople, completedPeople, averageExpectedWait, averageActualWait, m_abandonedPeopleEver);
 }
 
 // History management methods for offline functionality
 void QueueManager::addPersonToHistory(const Person &person)
 {
+    if (m_isFork)
+    {
+        return; // What-if forks have nothing to upload later
+    }
+
     // Clean old entries before adding new one
     cleanOldHistoryEntries();
 
+    // Bounded backlog: drop the oldest entry rather than growing without limit while offline
+    if (static_cast<int>(m_lastHourHistory.size()) >= MAX_HISTORY_ENTRIES)
+    {
+        m_lastHourHistory.pop_front();
+    }
+
     // Add the new person to history
     m_lastHourHistory.push_back(person);
 }
 
 void QueueManager::cleanOldHistoryEntries()
 {
-    long long currentTime = std::chrono::duration_cast<std::chrono::milliseconds>(
-                                std::chrono::system_clock::now().time_since_epoch())
-                                .count();
-
-    long long oneHourAgo = currentTime - ONE_HOUR_MS;
+    // Entries are in arrival order, so everything older than one hour sits at the front
+    long long oneHourAgo = Person::getCurrentTimestamp() - ONE_HOUR_SECONDS;
 
-    // Remove entries older than one hour
-    m_lastHourHistory.erase(
-        std::remove_if(m_lastHourHistory.begin(), m_lastHourHistory.end(),
-                       [oneHourAgo](const Person &person)
-                       {
-                           return person.getEnteringTimestamp() < oneHourAgo;
-                       }),
-        m_lastHourHistory.end());
+    while (!m_lastHourHistory.empty() && m_lastHourHistory.front().getEnteringTimestamp() < oneHourAgo)
+    {
+        m_lastHourHistory.pop_front();
+    }
 }
 
 void QueueManager::updatePersonInHistory(const Person &completedPerson)
 {
-    // Find the person in history by their person ID and update their exit information
-    for (auto &historyPerson : m_lastHourHistory)
+    if (m_isFork || m_lastHourHistory.empty())
     {
+        return;
+    }
+
+    // IDs are assigned consecutively and history is only trimmed from the front,
+    // so the person's slot is their ID offset from the oldest entry
+    long long offset = static_cast<long long>(completedPerson.getPersonId()) - m_lastHourHistory.front().getPersonId();
+    if (offset >= 0 && offset < static_cast<long long>(m_lastHourHistory.size()))
+    {
+        Person &historyPerson = m_lastHourHistory[static_cast<size_t>(offset)];
         if (historyPerson.getPersonId() == completedPerson.getPersonId())
         {
             // Update the person in history with the completed person's exit information
             historyPerson = completedPerson;
-            break;
         }
     }
 }
@@ -722,7 +2194,7 @@ void QueueManager::updatePersonInHistory(const Person &completedPerson)
 std::vector<Person> QueueManager::getPeopleFromLastHour() const
 {
     // Return a copy of the last hour history
-    return m_lastHourHistory;
+    return std::vector<Person>(m_lastHourHistory.begin(), m_lastHourHistory.end());
 }
 
 bool QueueManager::writeHistoryToFirebase()
@@ -745,7 +2217,7 @@ bool QueueManager::writeHistoryToFirebase()
         {
             FirebasePeopleStructureBuilder::PersonData personData(person);
             std::string personJson = FirebasePeopleStructureBuilder::generatePersonDataJson(personData);
-            std::string personPath = "simulation" + m_strategyPrefix + "/" +
+            std::string personPath = m_cloudRootPath + "/" +
                                      FirebasePeopleStructureBuilder::getPersonDataPath(person.getId());
 
             if (m_firebaseClient->updateData(personPath, personJson))
@@ -761,10 +2233,8 @@ bool QueueManager::writeHistoryToFirebase()
         // Update summary with historical data
         FirebasePeopleStructureBuilder::PeopleSummary summary = getCumulativePeopleSummary();
         std::string summaryJson = FirebasePeopleStructureBuilder::generatePeopleSummaryJson(summary);
-        std::string summaryPath = "simulation" + m_strategyPrefix + "/" +
-                                  FirebasePeopleStructureBuilder::getPeopleSummaryPath();
 
-        bool summarySuccess = m_firebaseClient->updateData(summaryPath, summaryJson);
+        bool summarySuccess = m_firebaseClient->updateData(m_peopleSummaryPath, summaryJson);
 
         if (summarySuccess)
         {
@@ -881,9 +2351,49 @@ std::vector<double> QueueManager::getDefaultServiceRates(int numberOfLines) cons
     return defaults;
 }
 
+void QueueManager::setRebalanceThreshold(double minimumGainSeconds)
+{
+    m_rebalanceThreshold = std::isfinite(minimumGainSeconds) ? std::max(0.0, minimumGainSeconds) : 0.0;
+    if (m_rebalanceThreshold > 0.0)
+    {
+        rebuildRebalanceHeaps();
+    }
+    else
+    {
+        m_longestTails.resize(0);
+        m_shortestWaits.resize(0);
+    }
+    updateRebalanceRecommendation(); // Withdraws a standing recommendation when turned off
+}
+
+double QueueManager::getRebalanceThreshold() const
+{
+    return m_rebalanceThreshold;
+}
+
+bool QueueManager::getRebalanceRecommendation(RebalanceMove &move) const
+{
+    if (!m_rebalanceStanding)
+    {
+        return false;
+    }
+
+    move = m_rebalanceMoves.back();
+    return true;
+}
+
 void QueueManager::setArrivalRate(double arrivalRate)
 {
     m_currentArrivalRate = std::max(0.0, arrivalRate);
+
+    // Wait estimates count the people in line, but every line's arrival forecast (LOOKAHEAD,
+    // WALK_AND_WAIT) follows the rate: re-rank them all
+    for (int i = 0; i < m_numberOfLines; ++i)
+    {
+        refreshLineSelection(i, LineChange::ESTIMATE);
+    }
+
+    logEvent(EventLogRecordType::ARRIVAL_RATE_CHANGE, 0, 0, Person::getCurrentTimestamp(), m_currentArrivalRate);
 }
 
 double QueueManager::getArrivalRate() const
@@ -899,8 +2409,19 @@ void QueueManager::setLineAvailability(int lineNumber, bool available)
         return;
     }
 
+    // One publish for the line and everyone who moved off it
+    if (changeLineAvailability(lineNumber, available) > 0)
+    {
+        writeToFirebase();
+    }
+}
+
+int QueueManager::changeLineAvailability(int lineNumber, bool available)
+{
     bool wasAvailable = m_lineAvailability[lineNumber - 1];
     m_lineAvailability[lineNumber - 1] = available;
+    refreshLineSelection(lineNumber - 1, LineChange::AVAILABILITY);
+    logEvent(EventLogRecordType::AVAILABILITY_CHANGE, lineNumber, 0, Person::getCurrentTimestamp(), 0.0, available);
 
     // Log availability changes
     if (wasAvailable != available)
@@ -914,6 +2435,164 @@ void QueueManager::setLineAvailability(int lineNumber, bool available)
             std::cout << "❌ Line " << lineNumber << " sensor failed - line now UNAVAILABLE" << std::endl;
         }
     }
+
+    if (!m_failoverEnabled || !wasAvailable || available)
+    {
+        return 0;
+    }
+
+    int moved = redistributeLine(lineNumber - 1, Person::getCurrentTimestamp());
+    if (moved > 0)
+    {
+        std::cout << "🔀 Failover: moved " << moved << " people from line " << lineNumber << " to other lines" << std::endl;
+    }
+    return moved;
+}
+
+int QueueManager::redistributeLine(int lineIndex, long long timestamp)
+{
+    // Front first: whoever has waited longest chooses while the other lines are still shortest.
+    // The first `servers` people are at a register (as in startFreeRegisters) and stay, so the
+    // front entry is never left a tombstone
+    int servers = m_throughputTrackers[lineIndex].getServerCount();
+    int atRegister = 0;
+    int moved = 0;
+    for (size_t offset = 0; offset < m_lines[lineIndex]->size(); ++offset)
+    {
+        const Person &person = (*m_lines[lineIndex])[offset];
+        if (person.hasAbandoned())
+        {
+            continue;
+        }
+        if (atRegister < servers)
+        {
+            atRegister++;
+            continue;
+        }
+
+        int personId = person.getPersonId();
+        long long waited = timestamp - person.getEnteringTimestamp();
+        int lineNumber = getNextLineNumber(LineSelectionStrategy::SHORTEST_WAIT_TIME, person.getCustomerClass());
+        if (lineNumber == -1)
+        {
+            continue; // No line takes this class right now; others may still have room
+        }
+
+        // Expected wait stays measured from entering, so it can still be compared with the actual wait
+        double expectedWaitTime = static_cast<double>(waited) + getEstimatedWaitTimeForNewPerson(lineNumber);
+        movePerson(personId, lineNumber - 1, expectedWaitTime, timestamp);
+        startFreeRegisters(lineNumber - 1, timestamp);
+        moved++;
+    }
+    return moved;
+}
+
+void QueueManager::setFailoverEnabled(bool enabled)
+{
+    m_failoverEnabled = enabled;
+}
+
+bool QueueManager::isFailoverEnabled() const
+{
+    return m_failoverEnabled;
+}
+
+bool QueueManager::setServerCount(int lineNumber, int servers)
+{
+    if (!isValidLineNumber(lineNumber) || servers < 1)
+    {
+        std::cerr << "❌ Invalid server count " << servers << " for line " << lineNumber << std::endl;
+        return false;
+    }
+
+    int lineIndex = lineNumber - 1;
+    ThroughputTracker &tracker = m_throughputTrackers[lineIndex];
+    int previousServers = tracker.getServerCount();
+    long long sessionMillis = tracker.getSessionTimeMillis();
+    long long now = Person::getCurrentTimestamp();
+    tracker.setServerCountAt(servers, sessionMillis);
+    logEvent(EventLogRecordType::SERVER_COUNT_CHANGE, lineNumber, servers, now, static_cast<double>(sessionMillis));
+
+    // Opened registers take the next people waiting
+    startFreeRegisters(lineIndex, now);
+    refreshLineSelection(lineIndex, LineChange::ESTIMATE);
+
+    if (previousServers != servers)
+    {
+        std::cout << "🧑‍💼 Line " << lineNumber << " now staffed with " << servers
+                  << (servers == 1 ? " register" : " registers") << std::endl;
+    }
+    return true;
+}
+
+bool QueueManager::setLineClasses(int lineNumber, uint8_t classMask)
+{
+    classMask &= ALL_CUSTOMER_CLASSES;
+    if (!isValidLineNumber(lineNumber) || classMask == 0)
+    {
+        std::cerr << "❌ Invalid customer classes " << static_cast<int>(classMask) << " for line " << lineNumber << std::endl;
+        return false;
+    }
+
+    int lineIndex = lineNumber - 1;
+    bool changed = m_lineClassMasks[lineIndex] != classMask;
+    m_lineClassMasks[lineIndex] = classMask;
+    logEvent(EventLogRecordType::LINE_CLASSES_CHANGE, lineNumber, 0, Person::getCurrentTimestamp(), classMask);
+    if (!changed)
+    {
+        return true;
+    }
+
+    // Rare configuration change: rebuild the per-class rankings from scratch
+    rebuildClassRankings();
+    m_stateVersion++;
+    std::cout << "🏷️  Line " << lineNumber << " now serves customer classes 0x" << std::hex
+              << static_cast<int>(classMask) << std::dec << std::endl;
+    return true;
+}
+
+uint8_t QueueManager::getLineClasses(int lineNumber) const
+{
+    if (!isValidLineNumber(lineNumber))
+    {
+        return 0;
+    }
+    return m_lineClassMasks[lineNumber - 1];
+}
+
+int QueueManager::getServerCount(int lineNumber) const
+{
+    if (!isValidLineNumber(lineNumber))
+    {
+        return -1;
+    }
+    return m_throughputTrackers[lineNumber - 1].getServerCount();
+}
+
+bool QueueManager::setVenueLayout(const VenueLayout &layout)
+{
+    if (layout.getNumberOfLines() != m_numberOfLines)
+    {
+        std::cerr << "❌ Venue layout describes " << layout.getNumberOfLines() << " lines, this manager has "
+                  << m_numberOfLines << std::endl;
+        return false;
+    }
+
+    for (int i = 0; i < m_numberOfLines; ++i)
+    {
+        m_walkSeconds[i] = layout.getWalkSeconds(i + 1);
+        refreshLineSelection(i, LineChange::ESTIMATE);
+    }
+    return true;
+}
+
+double QueueManager::getWalkSeconds(int lineNumber) const
+{
+    if (!isValidLineNumber(lineNumber))
+    {
+        return -1.0;
+    }
+    return m_walkSeconds[lineNumber - 1];
 }
 
 bool QueueManager::isLineAvailable(int lineNumber) const
@@ -928,4 +2607,28 @@ bool QueueManager::isLineAvailable(int lineNumber) const
 std::vector<bool> QueueManager::getAllLineAvailability() const
 {
     return m_lineAvailability;
+}
+
+void QueueManager::setCloudPublishingEnabled(bool enabled)
+{
+    m_cloudPublishingEnabled = enabled;
+}
+
+void QueueManager::reserveCapacity(int peoplePerLine, size_t archivedPeople)
+{
+    if (!m_isFork && archivedPeople > 0)
+    {
+        m_completedArchive.reserve(archivedPeople);
+    }
+    if (peoplePerLine <= 0)
+    {
+        return;
+    }
+
+    for (int i = 0; i < m_numberOfLines; ++i)
+    {
+        mutableLine(i).reserve(static_cast<size_t>(peoplePerLine));
+    }
+    mutablePersonIndex().reserve(static_cast<size_t>(peoplePerLine) * m_numberOfLines);
+    m_lastHourHistory.reserve(MAX_HISTORY_ENTRIES);
 }
\ No newline at end of file
@@ -1,22 +1,26 @@
 #pragma once
 
 #include <algorithm>
+#include <array>
+#include <cstdint>
 #include <vector>
 #include <memory>
-#include <list>
 #include "FirebaseClient.h"
 #include "FirebasePeopleStructureBuilder.h"
+#include "FirebaseStructureBuilder.h"
+#include "IndexedMinHeap.h"
 #include "ThroughputTracker.h"
 #include "Person.h"
-
-/// Line selection strategies for queue management
-enum class LineSelectionStrategy
-{
-    SHORTEST_WAIT_TIME,     ///< Selects line with shortest estimated wait time (considers queue length + throughput)
-    FEWEST_PEOPLE,          ///< Simply chooses line with fewest people (ignores throughput differences)
-    FARTHEST_FROM_ENTRANCE, ///< Chooses line where last person is farthest from entrance (assumes higher line numbers = farther)
-    NEAREST_TO_ENTRANCE     ///< Chooses line where last person is nearest to entrance (assumes lower line numbers = nearer)
-};
+#include "RingBuffer.h"
+#include "CopyOnWrite.h"
+#include "PersonLocationIndex.h"
+#include "QueueEvent.h"
+#include "QueueTicket.h"
+#include "CompletedPeopleArchive.h"
+#include "EventLog.h"
+#include "LineSelectionStrategy.h"
+#include "SelectionStrategy.h"
+#include "VenueLayout.h"
 
 /**
  * @brief Shared QueueManager implementation for ESP32 and simulation environments
@@ -27,10 +31,12 @@ enum class LineSelectionStrategy
  *
  * Features:
  * - Multiple line selection strategies (shortest wait, fewest people, farthest from entrance)
+ * - Incrementally maintained per-strategy line ranking (O(log n) updates, O(1) selection)
  * - Real-time throughput tracking and wait time estimation
  * - Firebase cloud integration with automatic data synchronization
- * - Thread-safe design suitable for embedded and simulation environments
  *
+ * @note Not synchronized: use from one thread only. Multi-threaded producers should go
+ *       through ConcurrentQueueManager, which owns a QueueManager on its applier thread.
  * @note Uses 1-based line numbering for external API, 0-based internally
  * @note Firebase integration is optional and fails gracefully if unavailable
  */
@@ -40,34 +46,55 @@ public:
     /**
      * @brief Constructs a QueueManager with optional Firebase integration
      * @param maxSize Maximum people per individual line (0 = unlimited)
-     * @param numberOfLines Number of queue lines to manage (1-10)
+     * @param numberOfLines Number of queue lines to manage (no upper limit)
      * @param strategyPrefix Firebase path prefix for data organization (e.g., "_shortest", "_farthest")
-     * @param appName Firebase application name for cloud integration
+     * @param appName Firebase application name for cloud integration (empty = run without cloud)
      * @param serviceRates Expected service rates for each line (people/second). If empty, uses defaults.
+     * @param clearCloudOnStart true to wipe this prefix's cloud data on startup; pass false when
+     *        the state is about to be restored with loadSnapshot()
      */
     QueueManager(int maxSize, int numberOfLines, const std::string &strategyPrefix = "",
                  const std::string &appName = "iot-queue-management",
-                 const std::vector<double> &serviceRates = {});
+                 const std::vector<double> &serviceRates = {},
+                 bool clearCloudOnStart = true);
     ~QueueManager() = default;
 
+    /**
+     * @brief Creates an independent what-if copy of the current state
+     * Lines are shared copy-on-write: the fork costs O(number of lines) regardless of how
+     * many people are waiting, and a line is copied only when either side first changes it.
+     * The fork has no Firebase client, no event log and keeps no offline history or completed-people
+     * archive, so running
+     * scenarios on it (closing a line, opening another, feeding arrivals) never touches the
+     * production instance or the cloud. Once created it may be used from another thread.
+     * @return Fork owning its own copy of the queue state
+     */
+    std::unique_ptr<QueueManager> fork() const;
+
+    /// @return true for managers created by fork()
+    bool isFork() const { return m_isFork; }
+
     // Core queue operations
     /**
      * @brief Adds a person to the optimal line based on the given strategy
      * @param strategy Line selection algorithm to use (SHORTEST_WAIT_TIME, FEWEST_PEOPLE, FARTHEST_FROM_ENTRANCE)
-     * @return true if person was successfully added, false if queue is full
+     * @param serviceDemand Expected service size, e.g. basket or party size (1.0 = average customer)
+     * @param customerClass Kind of customer; only lines serving that class are considered
+     * @return Ticket with the assigned line, position, person ID and predicted wait; false if queue is full
+     *         or serviceDemand is not positive
      */
-    bool enqueue(LineSelectionStrategy strategy = LineSelectionStrategy::SHORTEST_WAIT_TIME);
+    EnqueueResult enqueue(LineSelectionStrategy strategy = LineSelectionStrategy::SHORTEST_WAIT_TIME,
+                          double serviceDemand = 1.0, CustomerClass customerClass = CustomerClass::STANDARD);
 
     /**
-     * @brief Adds a person using automatic strategy selection based on available data
-     * Uses FEWEST_PEOPLE until 30 total services completed, then SHORTEST_WAIT_TIME
-     * @return true if person was successfully added, false if queue is full
+     * @brief Adds a person using automatic strategy selection (enqueue with ADAPTIVE)
+     * Uses FEWEST_PEOPLE until every line has reliable throughput data, then SHORTEST_WAIT_TIME
+     * @return Ticket for the admitted person; false if queue is full
      */
-    bool enqueueAuto();
+    EnqueueResult enqueueAuto(double serviceDemand = 1.0, CustomerClass customerClass = CustomerClass::STANDARD);
 
     /**
-     * @brief Removes a person from the specified line using automatic strategy selection
-     * Uses FEWEST_PEOPLE until 30 total services completed, then SHORTEST_WAIT_TIME
+     * @brief Removes a person from the specified line, publishing the ADAPTIVE recommendation
      * @param lineNumber Line number to remove person from (1-based indexing)
      * @return true if person was successfully removed, false if line is empty or invalid
      */
@@ -84,9 +111,69 @@ public:
     /**
      * @brief Adds a person directly to a specific line, bypassing strategy selection
      * @param lineNumber Target line number (1-based indexing)
-     * @return true if person was successfully added, false if queue is full or line is invalid
+     * @param serviceDemand Expected service size (1.0 = average customer)
+     * @param customerClass Kind of customer (a sensor reports where people are, so the line's
+     *        accepted classes are not enforced here)
+     * @return Ticket for the admitted person; false if queue is full or line is invalid
+     */
+    EnqueueResult enqueueOnLine(int lineNumber, double serviceDemand = 1.0,
+                                CustomerClass customerClass = CustomerClass::STANDARD);
+
+    /**
+     * @brief Adds a party that must share a line (a family) in one operation
+     * All members join the same line back to back, or none does: the line must have room for
+     * the whole party. One selection and one Firebase update for the party instead of one per member.
+     * @param size Number of members
+     * @param serviceDemand Service size of the whole party (1.0 = one average customer), shared
+     *        evenly by the members; 0 to count each member as an average customer. It adds to the
+     *        line's outstanding work; wait estimates count people, so each member adds one person
+     * @param strategy Line selection algorithm; if its line cannot take the whole party, the line
+     *        with the shortest estimated wait that can is used, and the members are archived as
+     *        routed by SHORTEST_WAIT_TIME
+     * @param customerClass Kind of customer, the same for every member
+     * @return Ticket of the party; false if no line has room for it or an argument is invalid
      */
-    bool enqueueOnLine(int lineNumber);
+    GroupEnqueueResult enqueueGroup(int size, double serviceDemand = 0.0,
+                                    LineSelectionStrategy strategy = LineSelectionStrategy::SHORTEST_WAIT_TIME,
+                                    CustomerClass customerClass = CustomerClass::STANDARD);
+
+    /**
+     * @brief Removes a person who left their line before being served (reneging)
+     * O(1) plus an O(log n) index update: the entry is only marked as abandoned and is
+     * dropped lazily once it reaches the front during a normal dequeue. Someone leaving
+     * from the counter is removed at once and the next person starts service. Either
+     * way the departure is counted as an abandonment, not as a service.
+     * @param personId ID assigned when the person entered
+     * @return true if the person was waiting and has been removed
+     */
+    bool abandon(int personId);
+
+    /**
+     * @brief Moves someone waiting to the back of another line (e.g. following a RebalanceMove)
+     * The person keeps their ID and entering time, so the move is neither an abandonment nor a
+     * new arrival: abandonment ratios and the archive are unaffected. Their expected wait becomes
+     * the time already waited plus the new line's estimate. Logged as a MOVE record.
+     * @param personId ID assigned when the person entered
+     * @param lineNumber Line to join (1-based indexing)
+     * @return false if the person is not waiting behind a register, or the line is the same one,
+     *         unavailable, full or does not serve the person's class
+     */
+    bool moveWaitingPerson(int personId, int lineNumber);
+
+    /**
+     * @brief Applies a burst of events, then publishes the resulting state once
+     * All events mutate state first (in order); the recommendation and Firebase update
+     * happen a single time at the end instead of once per event.
+     * @param events Array of events (works with std::vector via .data())
+     * @param count Number of events in the array
+     * @param strategy Line selection strategy for routed arrivals and the published recommendation
+     * @param appliedFlags Optional output array (count entries): true where the event was applied
+     * @param tickets Optional output array (count entries): the ticket of each ARRIVAL event
+     * @return Number of events that were applied (rejected arrivals and empty-line services are skipped)
+     */
+    int applyBatch(const QueueEvent *events, size_t count,
+                   LineSelectionStrategy strategy = LineSelectionStrategy::SHORTEST_WAIT_TIME,
+                   bool *appliedFlags = nullptr, EnqueueResult *tickets = nullptr);
 
     // State queries
     /**
@@ -103,10 +190,79 @@ public:
 
     /**
      * @brief Determines the optimal line number based on the given strategy
+     * Reads the top of the strategy's line ranking, so the cost does not grow with the line count
      * @param strategy Line selection algorithm to use
+     * @param customerClass Kind of customer; lines that do not serve that class are skipped
      * @return Recommended line number (1-based), or -1 if no lines available
      */
-    int getNextLineNumber(LineSelectionStrategy strategy = LineSelectionStrategy::SHORTEST_WAIT_TIME) const;
+    int getNextLineNumber(LineSelectionStrategy strategy = LineSelectionStrategy::SHORTEST_WAIT_TIME,
+                          CustomerClass customerClass = CustomerClass::STANDARD) const;
+
+    /**
+     * @brief Recommends a line to someone who will walk there, and remembers it until they arrive
+     * The recommendation counts as pending on that line (see LineStatus::pending) until the line's
+     * sensor sees the next arrival or it times out, so a burst of people asking at once is spread
+     * over the lines instead of all being sent to the same one.
+     * @param strategy Line selection algorithm to use
+     * @param customerClass Kind of customer; lines that do not serve that class are skipped
+     * @return Recommended line number (1-based), or -1 if no lines available
+     */
+    int recommendLine(LineSelectionStrategy strategy = LineSelectionStrategy::LOOKAHEAD,
+                      CustomerClass customerClass = CustomerClass::STANDARD);
+
+    /**
+     * @brief Gets the recommendations to a line that have not arrived yet
+     * @param lineNumber Line to query (1-based indexing)
+     * @return Pending recommendations, or -1 if line number is invalid
+     */
+    int getPendingRecommendations(int lineNumber) const;
+
+    /**
+     * @brief Sets how long a recommendation stays pending if nobody arrives on its line
+     * @param seconds Timeout in seconds (default 120)
+     */
+    void setRecommendationTimeout(int seconds);
+
+    /**
+     * @brief Attaches a custom line selection strategy
+     * The strategy is reset with the current lines and then kept up to date on every change;
+     * forks get their own clone.
+     * @param strategy Strategy to own
+     * @param id Optional output: value to pass to enqueue/getNextLineNumber to use it
+     * @return false if strategy is null or the manager already has 127 strategies
+     */
+    bool addStrategy(std::unique_ptr<SelectionStrategy> strategy, LineSelectionStrategy *id = nullptr);
+
+    /**
+     * @brief Attaches a new instance of a strategy registered with StrategyRegistry
+     * @return false if no strategy is registered under that name
+     */
+    bool addStrategy(const std::string &registeredName, LineSelectionStrategy *id = nullptr);
+
+    /**
+     * @brief Looks up a strategy by its getName()
+     * @return false if the manager has no strategy with that name
+     */
+    bool findStrategy(const std::string &name, LineSelectionStrategy &id) const;
+
+    /// Strategy behind an id, or nullptr if there is none
+    const SelectionStrategy *getStrategy(LineSelectionStrategy strategy) const;
+
+    /// Number of strategies (built-in plus added), i.e. one past the highest valid id
+    int getStrategyCount() const;
+
+    /**
+     * @brief Strategy that actually ranks lines for the given one
+     * @return The active inner strategy for ADAPTIVE, otherwise strategy itself
+     */
+    LineSelectionStrategy getEffectiveStrategy(LineSelectionStrategy strategy) const;
+
+    /**
+     * @brief Gets the state version, bumped by every change that can move a wait estimate or recommendation
+     * Callers can compare versions to skip recomputing or republishing derived data that has not changed
+     * @return Monotonic counter (arrivals, services, availability and arrival-rate changes)
+     */
+    uint64_t getStateVersion() const;
 
     /**
      * @brief Gets the number of people in a specific line
@@ -115,9 +271,17 @@ public:
      */
     int getLineCount(int lineNumber) const;
 
+    /**
+     * @brief Gets the service demand still waiting in a line (including the person being served)
+     * @param lineNumber Line to query (1-based indexing)
+     * @return Sum of service demands (1.0 = one average customer), or -1 if line number is invalid
+     */
+    double getOutstandingWork(int lineNumber) const;
+
     /**
      * @brief Gets all people currently in the queue system
      * @return Vector containing all people across all lines
+     * @note Copies every person; prefer forEachPerson() or getLineView() for read-only scans
      */
     std::vector<Person> getAllPeople() const;
 
@@ -125,15 +289,101 @@ public:
      * @brief Gets all people in a specific line
      * @param lineNumber Line to query (1-based indexing)
      * @return Vector containing all people in the specified line
+     * @note Copies every person; prefer peekFront() or getLineView() for read-only access
      */
     std::vector<Person> getPeopleInLine(int lineNumber) const;
 
+    // Zero-copy inspection (results are invalidated by the next enqueue/dequeue)
+    using LineView = RingBufferView<Person>;
+
+    /**
+     * @brief Gets the person at the front of a line without copying
+     * @param lineNumber Line to query (1-based indexing)
+     * @return Pointer to the first person, or nullptr if the line is empty or invalid
+     */
+    const Person *peekFront(int lineNumber) const;
+
+    /**
+     * @brief Gets a non-owning view of the people in a line, front to back
+     * The view is the raw line storage: people who abandoned the line stay in it
+     * (Person::hasAbandoned()) until they reach the front. forEachPersonInLine() skips them.
+     * @param lineNumber Line to query (1-based indexing)
+     * @param limit Maximum number of people in the view (-1 = whole line)
+     * @return View over the line, or an empty view if the line number is invalid
+     */
+    LineView getLineView(int lineNumber, int limit = -1) const;
+
+    /**
+     * @brief Calls visitor(const Person &) for people in one line, front to back
+     * @param lineNumber Line to visit (1-based indexing)
+     * @param visitor Callable invoked once per person
+     * @param limit Maximum number of people to visit (-1 = whole line)
+     */
+    template <typename Visitor>
+    void forEachPersonInLine(int lineNumber, Visitor &&visitor, int limit = -1) const
+    {
+        int remaining = limit;
+        for (const Person &person : getLineView(lineNumber))
+        {
+            if (remaining == 0)
+            {
+                return;
+            }
+            if (person.hasAbandoned())
+            {
+                continue;
+            }
+            visitor(person);
+            if (remaining > 0)
+            {
+                remaining--;
+            }
+        }
+    }
+
+    /**
+     * @brief Calls visitor(const Person &) for people across all lines (line 1 first)
+     * @param visitor Callable invoked once per person
+     * @param limit Maximum number of people to visit in total (-1 = everyone)
+     */
+    template <typename Visitor>
+    void forEachPerson(Visitor &&visitor, int limit = -1) const
+    {
+        int remaining = limit;
+        for (int line = 1; line <= m_numberOfLines && remaining != 0; ++line)
+        {
+            forEachPersonInLine(line, [&visitor, &remaining](const Person &person)
+                                {
+                                    visitor(person);
+                                    if (remaining > 0)
+                                    {
+                                        remaining--;
+                                    }
+                                },
+                                remaining);
+        }
+    }
+
     /**
      * @brief Gets cumulative statistics for all people throughout the simulation
      * @return PeopleSummary with cumulative statistics
      */
     FirebasePeopleStructureBuilder::PeopleSummary getCumulativePeopleSummary() const;
 
+    /**
+     * @brief Everyone who was served or abandoned since start, stored by column
+     * For per-line, per-hour and per-strategy breakdowns (CompletedPeopleArchive::Query);
+     * people on lines above CompletedPeopleArchive::MAX_LINES are left out
+     * @return Archive of people in the order they left
+     */
+    const CompletedPeopleArchive &getCompletedArchive() const { return m_completedArchive; }
+
+    /**
+     * @brief Routing tag that people placed by a strategy carry (Person::getRoutingTag)
+     * @param strategy Strategy to filter archive queries by
+     */
+    static uint8_t routingTagOf(LineSelectionStrategy strategy) { return ::routingTagOf(strategy); }
+
     /**
      * @brief Updates cloud with all people data from the last hour and cleans local history
      * This is designed to be called when WiFi reconnects after being offline
@@ -149,21 +399,111 @@ public:
 
     /**
      * @brief Calculates estimated wait time for a specific line
+     * Served from the per-line cache, which is refreshed only when that line's state changes
      * @param lineNumber Line to analyze (1-based indexing)
      * @return Estimated wait time in seconds, based on queue length and throughput
      */
     double getEstimatedWaitTime(int lineNumber) const;
 
+    /**
+     * @brief Calculates estimated wait time on a line for a customer of a given class
+     * Lines are FIFO, so the wait depends on who is ahead (their classes' service times), not on
+     * the newcomer's class; a line that does not serve the class is reported as unusable.
+     * @param lineNumber Line to analyze (1-based indexing)
+     * @param customerClass Kind of customer
+     * @return Estimated wait time in seconds, or 999 if the line is invalid or does not serve the class
+     */
+    double getEstimatedWaitTime(int lineNumber, CustomerClass customerClass) const;
+
     /**
      * @brief Calculates estimated wait time for a new person entering a specific line
-     * This calculates time until becoming first in line (not until leaving)
+     * This calculates time until becoming first in line (not until leaving); O(1), cached per line
      * @param lineNumber Line to analyze (1-based indexing)
      * @return Estimated wait time in seconds until becoming first in line
      */
     double getEstimatedWaitTimeForNewPerson(int lineNumber) const;
 
     /**
-     * @brief Set the current arrival rate for queue theory calculations
+     * @brief Finds the line a waiting person is in
+     * @param personId ID assigned when the person entered
+     * @return Line number (1-based indexing), or 0 if the person is not waiting in any line
+     */
+    int getLineNumberOfPerson(int personId) const;
+
+    /**
+     * @brief Gets a waiting person's place in their line; O(1) through the person index
+     * @param personId ID assigned when the person entered
+     * @return 1-based position (1 = at the counter), or 0 if the person is not waiting
+     */
+    int getPosition(int personId) const;
+
+    /**
+     * @brief Estimates how long a waiting person still has until reaching the counter
+     * Uses the same throughput model as getEstimatedWaitTimeForNewPerson() for the people ahead
+     * @param personId ID assigned when the person entered
+     * @return Remaining wait in seconds (0 at the counter), or -1 if the person is not waiting
+     */
+    double getRemainingWait(int personId) const;
+
+    /**
+     * @brief Calls visitor(const PersonEta &) for waiting people whose ETA may have changed since a state version
+     * Positions and remaining waits only move when their own line changes (arrival behind them,
+     * service, abandonment, availability), so only the lines touched after `sinceVersion` are
+     * visited. An arrival-rate change re-ranks every line and so touches them all, although no
+     * remaining wait depends on the rate. Publishing ETAs this way costs O(people in changed
+     * lines) instead of O(everyone). Pass 0 to visit everybody.
+     * @param sinceVersion getStateVersion() value returned by the previous call
+     * @param visitor Callable invoked once per person, front to back, line 1 first
+     * @param limit Maximum number of people to visit (-1 = no limit)
+     * @return Current state version, to pass as `sinceVersion` next time, if every changed line was
+     *         visited; `sinceVersion` if the limit cut the pass short, so nobody is skipped. A limit
+     *         smaller than the people in changed lines revisits the first lines every time: publish
+     *         with a cursor instead (as writeToFirebase() does)
+     */
+    template <typename Visitor>
+    uint64_t forEachEtaChangedSince(uint64_t sinceVersion, Visitor &&visitor, int limit = -1) const
+    {
+        int remaining = limit;
+        for (int lineIndex = 0; lineIndex < m_numberOfLines; ++lineIndex)
+        {
+            if (m_lineVersions[lineIndex] <= sinceVersion)
+            {
+                continue;
+            }
+            if (remaining == 0)
+            {
+                return sinceVersion;
+            }
+            int position = 0;
+            bool complete = true;
+            forEachPersonInLine(lineIndex + 1, [&](const Person &person)
+                                {
+                                    if (remaining == 0)
+                                    {
+                                        complete = false;
+                                        return;
+                                    }
+                                    position++;
+                                    visitor(PersonEta{&person, person.getPersonId(), lineIndex + 1, position,
+                                                      remainingWaitAt(lineIndex, position)});
+                                    if (remaining > 0)
+                                    {
+                                        remaining--;
+                                    }
+                                },
+                                remaining < 0 ? -1 : remaining + 1); // One more tells whether the line was finished
+            if (!complete)
+            {
+                return sinceVersion;
+            }
+        }
+        return m_stateVersion;
+    }
+
+    /**
+     * @brief Set the current arrival rate of the whole system (status arrival forecast)
+     * Wait estimates do not depend on it (they count the people already in line), but strategies
+     * that forecast joiners do, so every line is re-ranked and the state version bumped
      * @param arrivalRate Arrivals per second
      */
     void setArrivalRate(double arrivalRate);
@@ -181,6 +521,21 @@ public:
      */
     void setLineAvailability(int lineNumber, bool available);
 
+    /**
+     * @brief Turns failover on or off: whether people leave a line that becomes unavailable
+     * Without failover, setLineAvailability(line, false) only stops routing to the line, and the
+     * people in it keep a wait that no longer holds. With it, everyone not yet at a register moves,
+     * front first, to the line with the shortest wait for their class, so whoever waited longest
+     * gets the best place. Each keeps their ID and has their line and expected wait updated; every
+     * move is logged (EventLogRecordType::MOVE) and the new state is published once. People at a
+     * register finish their service there, and anyone no line can take stays.
+     * Failover is configuration: forks keep it, and it is not part of snapshots.
+     */
+    void setFailoverEnabled(bool enabled);
+
+    /// @return true if people leave a line that becomes unavailable
+    bool isFailoverEnabled() const;
+
     /**
      * @brief Get availability status for a specific line
      * @param lineNumber Line to check (1-based indexing)
@@ -188,31 +543,229 @@ public:
      */
     bool isLineAvailable(int lineNumber) const;
 
+    /**
+     * @brief Sets how many registers are staffed on a line (one queue feeding several registers)
+     * Can change at any time as staff come and go. The line's throughput and wait estimates
+     * (M/M/c) follow at once, and newly opened registers take the next people waiting.
+     * People already at a register when one closes finish their service.
+     * @param lineNumber Line to change (1-based indexing)
+     * @param servers Staffed registers, at least 1
+     * @return false if the line number or server count is invalid
+     */
+    bool setServerCount(int lineNumber, int servers);
+
+    /**
+     * @brief Sets which customer classes a line serves (e.g. an express lane)
+     * Routing for a class only considers lines that serve it. Classes refused by some line get
+     * their own line ranking, so a store without restricted lanes pays nothing extra.
+     * @param lineNumber Line to change (1-based indexing)
+     * @param classMask customerClassBit() values or'ed together (ALL_CUSTOMER_CLASSES by default)
+     * @return false if the line number is invalid or the mask accepts no class
+     */
+    bool setLineClasses(int lineNumber, uint8_t classMask);
+
+    /**
+     * @brief Gets which customer classes a line serves
+     * @return customerClassBit() mask, or 0 if line number is invalid
+     */
+    uint8_t getLineClasses(int lineNumber) const;
+
+    /**
+     * @brief Gets the number of people of one class in a line
+     * @return People waiting, or -1 if line number is invalid
+     */
+    int getLineCount(int lineNumber, CustomerClass customerClass) const;
+
+    /**
+     * @brief Describes where the lines are and how long it takes to walk to each of them
+     * The walking times reach every strategy (LineStatus::walkSeconds); WALK_AND_WAIT weighs them
+     * against the predicted wait. The layout is configuration: forks keep it, and it is neither
+     * logged nor part of snapshots.
+     * @param layout One placement per line, in line number order
+     * @return false if the layout does not have exactly one placement per line
+     */
+    bool setVenueLayout(const VenueLayout &layout);
+
+    /**
+     * @brief Gets the walking time from the hostess station to a line
+     * @return Seconds (0 without a venue layout), or -1 if line number is invalid
+     */
+    double getWalkSeconds(int lineNumber) const;
+
+    /**
+     * @brief Turns on rebalancing advice (jockeying) for when lines drift apart
+     * Arrivals can only be steered while they are new; once a fast line drains, people further back
+     * in a slow one keep waiting. Two heaps follow the wait of every line's last person and of a
+     * newcomer (O(log n) per change). When the last person of the worst line would save at least
+     * `minimumGainSeconds` by walking to the best line, a RebalanceMove is issued for as many people
+     * from the tail as each save that much. Recommendations are events (forEachRebalanceSince), and
+     * writeToFirebase publishes the latest one under "rebalance". They are advice and change no state;
+     * they are not logged nor part of snapshots. Whoever follows the advice is moved with
+     * moveWaitingPerson(), taking the last `people` people of the line.
+     * @param minimumGainSeconds Smallest saving worth asking someone to move, walk between the lines
+     *        included; 0 turns rebalancing off
+     */
+    void setRebalanceThreshold(double minimumGainSeconds);
+
+    /// @return Minimum saving per person moved, 0 if rebalancing is off
+    double getRebalanceThreshold() const;
+
+    /**
+     * @brief Gets the recommendation currently standing
+     * @param move Output: the recommendation, when there is one
+     * @return false if rebalancing is off or the lines are balanced
+     */
+    bool getRebalanceRecommendation(RebalanceMove &move) const;
+
+    /**
+     * @brief Calls visitor(const RebalanceMove &) for recommendations issued after a sequence number
+     * The last REBALANCE_HISTORY recommendations are kept, oldest first; withdrawals are included.
+     * @param sinceSequence Value returned by the previous call (0 for everything kept)
+     * @return Sequence number of the latest recommendation, to pass as `sinceSequence` next time
+     */
+    template <typename Visitor>
+    uint64_t forEachRebalanceSince(uint64_t sinceSequence, Visitor &&visitor) const
+    {
+        for (const RebalanceMove &move : m_rebalanceMoves)
+        {
+            if (move.sequence > sinceSequence)
+            {
+                visitor(move);
+            }
+        }
+        return m_rebalanceSequence;
+    }
+
+    static const int REBALANCE_HISTORY = 32; ///< Rebalancing recommendations kept for forEachRebalanceSince
+
+    /**
+     * @brief Gets the number of registers staffed on a line
+     * @param lineNumber Line to query (1-based indexing)
+     * @return Staffed registers, or -1 if line number is invalid
+     */
+    int getServerCount(int lineNumber) const;
+
     /**
      * @brief Get availability status for all lines
      * @return Vector of bool values indicating availability for each line (1-based indexing matches line numbers)
      */
     std::vector<bool> getAllLineAvailability() const;
 
+    /**
+     * @brief Enables or disables the automatic Firebase write after each state change
+     * With publishing disabled (or no Firebase client) enqueue/dequeue do not allocate once
+     * line, history and archive storage have reached their working size (see reserveCapacity).
+     * @param enabled true to publish after every change (default), false to keep state local only
+     */
+    void setCloudPublishingEnabled(bool enabled);
+
+    // Event sourcing
+    /**
+     * @brief Records every subsequent state change in an append-only event log
+     * Arrivals (with their line assignment), became-first, service completions,
+     * availability and arrival-rate changes are appended as fixed-size records.
+     * @param eventLog Open log to append to (nullptr = stop logging); an empty log gets this manager's configuration
+     * @return false (and nothing is logged) if this manager has more than EventLog::MAX_LINES lines
+     */
+    bool attachEventLog(std::shared_ptr<EventLog> eventLog);
+
+    /**
+     * @brief Rebuilds state by applying logged events, without publishing or re-logging them
+     * Intended for a freshly constructed manager with the same line count and service rates
+     * as the writer. Recorded timestamps, person IDs and tracker times are reused as logged,
+     * so the resulting queues, statistics and wait estimates match the original. Each tracker's
+     * session clock then continues from the last session time logged for its line.
+     * For crash recovery, call Person::setSimulationStartTime(log.getSimulationStartMillis())
+     * first so that new timestamps continue the logged timeline.
+     * @param records Array of records (e.g. EventLog::records())
+     * @param count Number of records in the array
+     * @return Number of records applied (records that do not fit the current state are skipped)
+     */
+    size_t replay(const EventLogRecord *records, size_t count);
+
+    /**
+     * @brief Replays a whole event log (see replay(records, count))
+     * @return Number of records applied, 0 if the log was written for a different line count
+     */
+    size_t replay(const EventLog &eventLog);
+
+    // Snapshot / restore
+    /**
+     * @brief Serializes the full in-memory state into a versioned binary blob
+     * Includes every line with its people, the throughput trackers, running totals,
+     * line availability, arrival rate and the last-hour history.
+     * @return Blob for loadSnapshot() (host byte order, with a checksum)
+     */
+    std::vector<uint8_t> saveSnapshot() const;
+
+    /**
+     * @brief Replaces the current state with a blob produced by saveSnapshot()
+     * Throughput trackers resume warm (downtime is not counted as idle service time),
+     * and the simulation clock is set to the saved start so timestamps stay consistent.
+     * The state is left untouched if the blob is corrupt, from another format version,
+     * or was saved for a different number of lines.
+     * Restored state is not written to an attached event log. The completed-people archive
+     * is not part of the snapshot and is cleared.
+     * @param data Blob bytes
+     * @param size Blob length in bytes
+     * @return true if the state was restored
+     */
+    bool loadSnapshot(const uint8_t *data, size_t size);
+
+    /**
+     * @brief Writes saveSnapshot() to a file (written to path + ".tmp", then renamed)
+     * @return true if the file was written completely
+     */
+    bool saveSnapshotToFile(const std::string &path) const;
+
+    /**
+     * @brief Restores state from a file written by saveSnapshotToFile()
+     * @return true if the state was restored, false if the file is missing or invalid
+     */
+    bool loadSnapshotFromFile(const std::string &path);
+
+    /**
+     * @brief Pre-sizes line and history storage so the hot path never grows it later
+     * @param peoplePerLine Expected maximum number of people waiting in any single line
+     * @param archivedPeople Expected number of people leaving over the run (completed-people archive)
+     */
+    void reserveCapacity(int peoplePerLine, size_t archivedPeople = 0);
+
 private:
-    static const int MAX_LINES = 10; // Historical cap; still enforced to avoid runaway usage
+    static const int MAX_STRATEGIES = 127; // Routing tags (id + 1) must fit the snapshot's 7-bit field
+#ifdef ESP32
+    static const int MAX_HISTORY_ENTRIES = 512; // Offline backlog cap (~20KB of Person records)
+#else
+    static const int MAX_HISTORY_ENTRIES = 8192;
+#endif
 
     int m_maxSize;
     int m_numberOfLines;
     int m_totalPeople;
-    std::vector<std::list<Person>> m_lines; // Each line contains a list of Person objects
+    std::shared_ptr<RingBufferPool<Person>> m_linePool; // Storage blocks recycled between lines on growth
+    std::vector<CopyOnWrite<RingBuffer<Person>>> m_lines; // Each line is a contiguous FIFO of Person objects, shared copy-on-write with forks
+    CopyOnWrite<PersonLocationIndex> m_personIndex; // Person ID -> line and position of everyone waiting
 
     // Running statistics for all people throughout simulation
     int m_totalPeopleEver;          // Total people who have ever entered
     int m_completedPeopleEver;      // Total people who have completed (exited)
+    int m_abandonedPeopleEver;      // Total people who left before being served
     double m_totalExpectedWaitTime; // Sum of all expected wait times
     double m_totalActualWaitTime;   // Sum of all actual wait times for completed people
     int m_lastSelectedLine;         // Last line selected by enqueue strategy
     int m_nextPersonId;             // Counter for generating unique person IDs (independent per QueueManager)
 
+    std::shared_ptr<EventLog> m_eventLog; // Optional append-only record of every mutation
+
     // Optional Firebase integration
     std::shared_ptr<FirebaseClient> m_firebaseClient;
+    bool m_cloudPublishingEnabled;                       // Automatic writeToFirebase after state changes
     std::string m_strategyPrefix;                        // e.g., "", "_shortest", "_farthest"
+    std::string m_cloudRootPath;                         // "simulation" + m_strategyPrefix
+    std::string m_recommendedChoicePath;                 // Precomputed so publishing does not rebuild paths
+    std::string m_peopleSummaryPath;
+    std::vector<std::string> m_lineCloudPaths;           // ".../queues/line{n}" per line
+    std::vector<FirebaseStructureBuilder::LineData> m_lineDataScratch; // Reused by writeToFirebase
     std::vector<ThroughputTracker> m_throughputTrackers; // Throughput tracking for each line
 
     // Queue theory enhancements
@@ -221,12 +774,122 @@ private:
 
     // Line availability tracking (sensor health)
     std::vector<bool> m_lineAvailability; // Tracks if each line is available (sensor working)
+    std::vector<double> m_walkSeconds;    // Walk from the hostess station per line (0-based), from setVenueLayout
+    bool m_failoverEnabled;               // Move people off a line that becomes unavailable
+
+    // Line selection strategies indexed by LineSelectionStrategy value (built-ins first, then addStrategy)
+    std::vector<std::unique_ptr<SelectionStrategy>> m_strategies;
+    std::vector<LineStatus> m_lineStatusScratch; // Reused by rebuildLineSelection
+
+    // Customer classes: which classes each line serves, and who is waiting per class
+    std::vector<uint8_t> m_lineClassMasks;                            // customerClassBit() mask per line (0-based)
+    std::vector<std::array<int, CUSTOMER_CLASS_COUNT>> m_classCounts; // People waiting per class per line (0-based)
+    // Rankings for classes some line refuses (clones of m_strategies); empty while every line serves the class
+    std::array<std::vector<std::unique_ptr<SelectionStrategy>>, CUSTOMER_CLASS_COUNT> m_classStrategies;
+    LineSelectionStrategy m_lastAutoStrategy;    // Effective strategy of the last enqueueAuto (logged on switch)
+
+    // Memoized derived state, refreshed by refreshLineSelection on every relevant mutation
+    std::vector<double> m_waitEstimates; // Tracker wait estimate per line (0-based)
+    std::vector<double> m_outstandingWork; // Service demand of everyone waiting per line (0-based), kept incrementally
+
+    // Recommendations handed out by recommendLine whose person has not reached the line yet
+    struct PendingRecommendation
+    {
+        int lineIndex;
+        long long issuedAt; // Seconds since simulation start
+    };
+    RingBuffer<PendingRecommendation> m_recommendations; // In issue order, oldest first (expiry scans the front)
+    std::vector<int> m_pendingCounts;    // Still pending per line (0-based)
+    std::vector<int> m_arrivedUnexpired; // Arrived per line but still stored in m_recommendations
+    long long m_recommendationTimeout;   // Seconds before a pending recommendation is dropped
+    uint64_t m_stateVersion;             // Bumped whenever an estimate or eligibility may have changed
+    std::vector<uint64_t> m_lineVersions; // State version of each line's last change (drives incremental ETA publishing)
+    std::vector<uint64_t> m_publishedLineVersions; // Line version whose ETAs were all published to the cloud
+    int m_etaCursorLine;                 // Line the next per-person publish starts from (0-based)
+    uint64_t m_etaCursorVersion;         // Version of that line when its publish was cut short
+    int m_etaCursorPosition;             // People of that line already published at that version
+
+    // Rebalancing advice (setRebalanceThreshold); heaps are only kept while it is on
+    double m_rebalanceThreshold;           // Minimum saving per person moved (s), 0 = off
+    IndexedMinHeap m_longestTails;         // Available lines with someone waiting, by minus their last person's wait
+    IndexedMinHeap m_shortestWaits;        // Eligible lines by a newcomer's wait (pending recommendations included)
+    RingBuffer<RebalanceMove> m_rebalanceMoves; // Latest recommendations issued, oldest first
+    uint64_t m_rebalanceSequence;          // Sequence of the latest recommendation
+    uint64_t m_publishedRebalanceSequence; // Sequence of the last recommendation published to the cloud
+    bool m_rebalanceStanding;              // m_rebalanceMoves.back() is a recommendation, not a withdrawal
+    std::string m_rebalancePath;
 
     // History tracking for offline functionality
-    std::vector<Person> m_lastHourHistory; // Queue of all people who entered in the last hour
+    RingBuffer<Person> m_lastHourHistory; // People who entered in the last hour, ordered by person ID
+    CompletedPeopleArchive m_completedArchive; // Everyone who left, for analytics (empty in forks)
+    bool m_isFork;                        // Created by fork(): no cloud, no event log, no history
+
+    struct ForkTag
+    {
+    };
+    QueueManager(const QueueManager &source, ForkTag);
+
+    /// Line for modification; copies it first if it is still shared with a fork or the origin
+    RingBuffer<Person> &mutableLine(int lineIndex);
+    /// People in a line, not counting abandoned entries still stored in it
+    int activeCount(int lineIndex) const;
+    /// Removes the front entry plus any abandoned entries that become the front (lazy compaction)
+    Person popFront(int lineIndex);
+    PersonLocationIndex &mutablePersonIndex();
+    void rebuildPersonIndex();
 
     // Helper methods
     bool isValidLineNumber(int lineNumber) const;
+    bool isLineAtCapacity(int lineIndex) const;
+    bool hasRoomFor(int lineIndex, int people) const;
+    /// Available line serving the class with room for a party and the shortest wait, -1 if none
+    int findLineWithRoomFor(int people, CustomerClass customerClass) const;
+
+    // State mutations without publishing (shared by the single-event API and applyBatch)
+    EnqueueResult addPersonToLine(int lineNumber, uint8_t routingTag = Person::NOT_ROUTED, double serviceDemand = 1.0,
+                                  CustomerClass customerClass = CustomerClass::STANDARD);
+    bool removePersonFromLine(int lineNumber);
+    bool removeAbandonedPerson(int personId, long long timestamp);
+    /// Sets availability; with failover, moves the people waiting on a line that became unavailable
+    /// @return Number of people moved
+    int changeLineAvailability(int lineNumber, bool available);
+    int redistributeLine(int lineIndex, long long timestamp);
+
+    // Primitive mutations shared by the live path and event log replay (0-based line index)
+    void admitPerson(const Person &person);
+    void startServiceAt(int lineIndex, int offset, long long timestamp);
+    /// Moves a waiting person, never the front entry, to the back of another line
+    void movePerson(int personId, int toLineIndex, double expectedWaitTime, long long timestamp);
+    void startFreeRegisters(int lineIndex, long long timestamp);
+    void completeServiceOfFront(int lineIndex, long long sessionMillis, long long timestamp);
+    void archiveDeparture(const Person &person, long long timestamp);
+    void expireRecommendations(long long now);
+    void logEvent(EventLogRecordType type, int lineNumber, int personId, long long timestamp,
+                  double value, bool available = true);
+
+    // Line ranking maintenance (0-based line index)
+    double computeWaitEstimate(int lineIndex) const;
+    double remainingWaitAt(int lineIndex, int position) const;
+    /// What changed on a line, so strategies get the matching hook
+    enum class LineChange
+    {
+        ARRIVAL,
+        SERVICE,
+        ABANDONMENT,
+        AVAILABILITY,
+        ESTIMATE,
+        RECOMMENDATION
+    };
+    LineStatus lineStatus(int lineIndex) const;
+    void refreshLineSelection(int lineIndex, LineChange change);
+    void rebuildLineSelection();
+    void rebuildClassRankings();
+    void refreshRebalanceHeaps(int lineIndex);
+    void rebuildRebalanceHeaps();
+    /// Re-derives the advice from the heap tops; issues an event only if it changed
+    void updateRebalanceRecommendation();
+    /// Strategies ranking lines for a class (m_strategies unless some line refuses the class)
+    const std::vector<std::unique_ptr<SelectionStrategy>> &strategiesFor(CustomerClass customerClass) const;
     bool writeToFirebase(LineSelectionStrategy strategy = LineSelectionStrategy::SHORTEST_WAIT_TIME);
     void clearCloudData();
 
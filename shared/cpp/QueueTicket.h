@@ -0,0 +1,78 @@
+#pragma once
+
+#include <cstdint>
+
+/**
+ * @brief Outcome of an arrival, taken from the state right after the person was admitted
+ *
+ * Converts to true when the person was admitted, so `if (qm.enqueue())` keeps working.
+ * Callers should read the line from here instead of asking getNextLineNumber() again,
+ * which answers for the next arrival, not the one that was just placed.
+ */
+struct EnqueueResult
+{
+    bool admitted;        ///< false if every eligible line was full or unavailable
+    int lineNumber;       ///< Assigned line (1-based indexing), -1 if not admitted
+    int position;         ///< Place in the line at admission (1 = at the counter), 0 if not admitted
+    int personId;         ///< ID to use with getPosition()/getRemainingWait()/abandon(), 0 if not admitted
+    double predictedWait; ///< Seconds until reaching the counter as told to the person, 0 if not admitted
+
+    EnqueueResult() : admitted(false), lineNumber(-1), position(0), personId(0), predictedWait(0.0) {}
+
+    EnqueueResult(int line, int linePosition, int id, double wait)
+        : admitted(true), lineNumber(line), position(linePosition), personId(id), predictedWait(wait) {}
+
+    explicit operator bool() const { return admitted; }
+};
+
+/**
+ * @brief Outcome of a party arrival (QueueManager::enqueueGroup)
+ *
+ * The members stand back to back on lineNumber with consecutive IDs, personId (the first
+ * member) to personId + size - 1. position and predictedWait are the first member's: when
+ * the party reaches the counter.
+ */
+struct GroupEnqueueResult : EnqueueResult
+{
+    int size; ///< Members admitted, 0 if not admitted
+
+    GroupEnqueueResult() : size(0) {}
+
+    GroupEnqueueResult(const EnqueueResult &firstMember, int members) : EnqueueResult(firstMember), size(members) {}
+};
+
+class Person;
+
+/**
+ * @brief Current place and remaining wait of one waiting person (see QueueManager::forEachEtaChangedSince)
+ */
+struct PersonEta
+{
+    const Person *person; ///< Entry in the line, valid until the next mutation
+    int personId;
+    int lineNumber;       ///< 1-based indexing
+    int position;         ///< 1 = at the counter
+    double remainingWait; ///< Seconds until reaching the counter (0 at the counter)
+};
+
+/**
+ * @brief Advice to move the last people of a slow line to a faster one (QueueManager::setRebalanceThreshold)
+ *
+ * The people to move are the tail of fromLine, from firstPosition to the end: they still have the
+ * longest to wait there, so they gain the most. people == 0 withdraws the previous recommendation
+ * (the lines are balanced again, or the people have moved).
+ */
+struct RebalanceMove
+{
+    uint64_t sequence;  ///< 1 for the first recommendation issued, then one more for each
+    long long issuedAt; ///< Seconds since simulation start
+    int fromLine;       ///< Line to leave (1-based indexing), 0 when withdrawn
+    int toLine;         ///< Line to join (1-based indexing), 0 when withdrawn
+    int people;         ///< People to move, 0 when withdrawn
+    int firstPosition;  ///< Place in fromLine of the first person to move; everyone behind them moves too
+    int firstPersonId;  ///< ID of that person, 0 when withdrawn
+    double gainSeconds; ///< Wait saved by everyone moved, together
+
+    RebalanceMove()
+        : sequence(0), issuedAt(0), fromLine(0), toLine(0), people(0), firstPosition(0), firstPersonId(0), gainSeconds(0.0) {}
+};
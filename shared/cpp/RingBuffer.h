@@ -0,0 +1,277 @@
+#pragma once
+
+#include <cstddef>
+#include <iterator>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+/**
+ * @brief Free-list of ring buffer storage blocks, bucketed by power-of-two capacity
+ *
+ * When a line outgrows its block, the old block is handed back here and the next
+ * line that needs a block of that size reuses it instead of going to the heap.
+ * Shared by all lines of one QueueManager. Lines shared copy-on-write with a fork may
+ * be released from the fork's thread, so the free lists are guarded by a mutex
+ * (only taken on growth and destruction, never on push/pop).
+ */
+template <typename T>
+class RingBufferPool
+{
+public:
+    /**
+     * @brief Gets a block able to hold `capacity` elements (power of two)
+     * @return Recycled block when one is available, otherwise a fresh allocation
+     */
+    std::unique_ptr<T[]> acquire(size_t capacity)
+    {
+        size_t bucket = bucketFor(capacity);
+        {
+            std::lock_guard<std::mutex> lock(m_mutex);
+            if (bucket < m_freeBlocks.size() && !m_freeBlocks[bucket].empty())
+            {
+                std::unique_ptr<T[]> block = std::move(m_freeBlocks[bucket].back());
+                m_freeBlocks[bucket].pop_back();
+                return block;
+            }
+        }
+        return std::unique_ptr<T[]>(new T[capacity]);
+    }
+
+    /**
+     * @brief Returns a block to the pool for later reuse
+     * @param block Storage previously obtained from acquire()
+     * @param capacity Capacity the block was acquired with
+     */
+    void release(std::unique_ptr<T[]> block, size_t capacity)
+    {
+        if (!block)
+            return;
+        size_t bucket = bucketFor(capacity);
+        std::lock_guard<std::mutex> lock(m_mutex);
+        if (bucket >= m_freeBlocks.size())
+            m_freeBlocks.resize(bucket + 1);
+        m_freeBlocks[bucket].push_back(std::move(block));
+    }
+
+private:
+    static size_t bucketFor(size_t capacity)
+    {
+        size_t bucket = 0;
+        while ((static_cast<size_t>(1) << bucket) < capacity)
+            bucket++;
+        return bucket;
+    }
+
+    std::mutex m_mutex;
+    std::vector<std::vector<std::unique_ptr<T[]>>> m_freeBlocks; ///< Free blocks indexed by log2(capacity)
+};
+
+template <typename T>
+class RingBufferView;
+
+/**
+ * @brief Growable FIFO ring buffer with contiguous, power-of-two sized storage
+ *
+ * Replacement for std::list in the queue lines: push_back/pop_front only move the
+ * head/tail indices, so once a line has reached its working size it never touches
+ * the heap again. Scans walk one contiguous block (wrapping at most once).
+ * Growth doubles the capacity, taking the new block from the shared pool.
+ */
+template <typename T>
+class RingBuffer
+{
+public:
+    class const_iterator
+    {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = T;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const T *;
+        using reference = const T &;
+
+        const_iterator(const RingBuffer *buffer, size_t index) : m_buffer(buffer), m_index(index) {}
+
+        reference operator*() const { return (*m_buffer)[m_index]; }
+        pointer operator->() const { return &(*m_buffer)[m_index]; }
+        const_iterator &operator++()
+        {
+            ++m_index;
+            return *this;
+        }
+        const_iterator operator++(int)
+        {
+            const_iterator previous = *this;
+            ++m_index;
+            return previous;
+        }
+        bool operator==(const const_iterator &other) const { return m_index == other.m_index && m_buffer == other.m_buffer; }
+        bool operator!=(const const_iterator &other) const { return !(*this == other); }
+
+    private:
+        const RingBuffer *m_buffer;
+        size_t m_index;
+    };
+
+    /**
+     * @brief Constructs an empty buffer (no storage is allocated until the first push)
+     * @param pool Optional shared pool used to recycle storage blocks on growth
+     */
+    explicit RingBuffer(std::shared_ptr<RingBufferPool<T>> pool = nullptr)
+        : m_data(), m_capacity(0), m_head(0), m_size(0), m_pool(std::move(pool)) {}
+
+    RingBuffer(const RingBuffer &other)
+        : m_data(), m_capacity(0), m_head(0), m_size(0), m_pool(other.m_pool)
+    {
+        reserve(other.m_size);
+        for (size_t i = 0; i < other.m_size; ++i)
+            push_back(other[i]);
+    }
+
+    RingBuffer(RingBuffer &&other) noexcept
+        : m_data(std::move(other.m_data)), m_capacity(other.m_capacity), m_head(other.m_head),
+          m_size(other.m_size), m_pool(std::move(other.m_pool))
+    {
+        other.m_capacity = 0;
+        other.m_head = 0;
+        other.m_size = 0;
+    }
+
+    RingBuffer &operator=(RingBuffer other) noexcept
+    {
+        swap(other);
+        return *this;
+    }
+
+    ~RingBuffer()
+    {
+        releaseStorage();
+    }
+
+    void swap(RingBuffer &other) noexcept
+    {
+        std::swap(m_data, other.m_data);
+        std::swap(m_capacity, other.m_capacity);
+        std::swap(m_head, other.m_head);
+        std::swap(m_size, other.m_size);
+        std::swap(m_pool, other.m_pool);
+    }
+
+    void push_back(const T &value)
+    {
+        if (m_size == m_capacity)
+            grow(m_size + 1);
+        m_data[(m_head + m_size) & (m_capacity - 1)] = value;
+        m_size++;
+    }
+
+    void pop_front()
+    {
+        if (m_size == 0)
+            return;
+        m_head = (m_head + 1) & (m_capacity - 1);
+        m_size--;
+    }
+
+    T &front() { return m_data[m_head]; }
+    const T &front() const { return m_data[m_head]; }
+    T &back() { return (*this)[m_size - 1]; }
+    const T &back() const { return (*this)[m_size - 1]; }
+
+    /// Logical indexing from the front (0 = oldest element)
+    T &operator[](size_t index) { return m_data[(m_head + index) & (m_capacity - 1)]; }
+    const T &operator[](size_t index) const { return m_data[(m_head + index) & (m_capacity - 1)]; }
+
+    size_t size() const { return m_size; }
+    bool empty() const { return m_size == 0; }
+    size_t capacity() const { return m_capacity; }
+
+    /// Drops all elements but keeps the storage for reuse
+    void clear()
+    {
+        m_head = 0;
+        m_size = 0;
+    }
+
+    /// Ensures room for at least `count` elements without further growth
+    void reserve(size_t count)
+    {
+        if (count > m_capacity)
+            grow(count);
+    }
+
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, m_size); }
+
+    /**
+     * @brief Non-owning view of the first `limit` elements (all elements if limit exceeds size)
+     * The view is invalidated by any mutation of the buffer
+     */
+    RingBufferView<T> view(size_t limit = static_cast<size_t>(-1)) const
+    {
+        return RingBufferView<T>(this, limit < m_size ? limit : m_size);
+    }
+
+private:
+    static constexpr size_t MIN_CAPACITY = 8;
+
+    void grow(size_t required)
+    {
+        size_t newCapacity = m_capacity > 0 ? m_capacity : MIN_CAPACITY;
+        while (newCapacity < required)
+            newCapacity *= 2;
+
+        std::unique_ptr<T[]> newData = m_pool ? m_pool->acquire(newCapacity)
+                                              : std::unique_ptr<T[]>(new T[newCapacity]);
+        for (size_t i = 0; i < m_size; ++i)
+            newData[i] = std::move((*this)[i]);
+
+        releaseStorage();
+        m_data = std::move(newData);
+        m_capacity = newCapacity;
+        m_head = 0;
+    }
+
+    void releaseStorage()
+    {
+        if (m_pool && m_data)
+            m_pool->release(std::move(m_data), m_capacity);
+        m_data.reset();
+    }
+
+    std::unique_ptr<T[]> m_data;              ///< Storage block, m_capacity elements
+    size_t m_capacity;                        ///< Always zero or a power of two
+    size_t m_head;                            ///< Physical index of the front element
+    size_t m_size;                            ///< Number of live elements
+    std::shared_ptr<RingBufferPool<T>> m_pool; ///< Optional block recycler shared between buffers
+};
+
+/**
+ * @brief Read-only window over the front of a RingBuffer, iterated front to back
+ *
+ * Holds only a pointer and a count, so it can be returned by value and walked
+ * without copying elements. A default-constructed view is empty.
+ */
+template <typename T>
+class RingBufferView
+{
+public:
+    using const_iterator = typename RingBuffer<T>::const_iterator;
+
+    RingBufferView() : m_buffer(nullptr), m_count(0) {}
+    RingBufferView(const RingBuffer<T> *buffer, size_t count) : m_buffer(buffer), m_count(count) {}
+
+    const_iterator begin() const { return const_iterator(m_buffer, 0); }
+    const_iterator end() const { return const_iterator(m_buffer, m_count); }
+
+    size_t size() const { return m_count; }
+    bool empty() const { return m_count == 0; }
+    const T &operator[](size_t index) const { return (*m_buffer)[index]; }
+    const T &front() const { return (*m_buffer)[0]; }
+
+private:
+    const RingBuffer<T> *m_buffer;
+    size_t m_count;
+};
@@ -0,0 +1,369 @@
+#include "SelectionStrategy.h"
+#include <algorithm>
+#include <cmath>
+#include <mutex>
+#include <utility>
+
+void ScoredSelectionStrategy::reset(const LineStatus *lines, int numberOfLines)
+{
+    m_ranking = IndexedMinHeap(static_cast<size_t>(numberOfLines));
+    for (int i = 0; i < numberOfLines; ++i)
+    {
+        onLineChanged(lines[i]);
+    }
+}
+
+void ScoredSelectionStrategy::onLineChanged(const LineStatus &line)
+{
+    // Lines at capacity or unavailable are kept out of the heap, so the top is always selectable
+    if (line.eligible)
+    {
+        m_ranking.update(static_cast<size_t>(line.lineIndex), score(line));
+    }
+    else
+    {
+        m_ranking.remove(static_cast<size_t>(line.lineIndex));
+    }
+}
+
+int ScoredSelectionStrategy::select() const
+{
+    return m_ranking.empty() ? -1 : static_cast<int>(m_ranking.top());
+}
+
+std::unique_ptr<SelectionStrategy> ShortestWaitTimeStrategy::clone() const
+{
+    return std::unique_ptr<SelectionStrategy>(new ShortestWaitTimeStrategy(*this));
+}
+
+std::unique_ptr<SelectionStrategy> FewestPeopleStrategy::clone() const
+{
+    return std::unique_ptr<SelectionStrategy>(new FewestPeopleStrategy(*this));
+}
+
+std::unique_ptr<SelectionStrategy> FarthestFromEntranceStrategy::clone() const
+{
+    return std::unique_ptr<SelectionStrategy>(new FarthestFromEntranceStrategy(*this));
+}
+
+std::unique_ptr<SelectionStrategy> NearestToEntranceStrategy::clone() const
+{
+    return std::unique_ptr<SelectionStrategy>(new NearestToEntranceStrategy(*this));
+}
+
+std::unique_ptr<SelectionStrategy> ShortestWorkloadStrategy::clone() const
+{
+    return std::unique_ptr<SelectionStrategy>(new ShortestWorkloadStrategy(*this));
+}
+
+std::unique_ptr<SelectionStrategy> LookaheadStrategy::clone() const
+{
+    return std::unique_ptr<SelectionStrategy>(new LookaheadStrategy(*this));
+}
+
+double LookaheadStrategy::score(const LineStatus &line) const
+{
+    // Observed throughput only counts time spent serving, so it understates a line that has been starved;
+    // projecting with it would starve the line further
+    double serviceRate = std::max(std::max(line.serviceRate, line.expectedServiceRate), 1e-6);
+    double forecastJoiners = line.arrivalForecast * m_horizonSeconds;
+
+    // People ahead when a person sent now reaches the line: whoever is in line now, less what the
+    // line serves meanwhile, plus everyone sent there before (still walking, so not served yet)
+    double ahead = std::max(0.0, line.people - serviceRate * m_horizonSeconds) + line.pending;
+    double ownWait = ahead / serviceRate;
+
+    // Everyone forecast to join behind them waits one more service
+    double delayToOthers = forecastJoiners / serviceRate;
+    return ownWait + delayToOthers;
+}
+
+std::unique_ptr<SelectionStrategy> WalkAndWaitStrategy::clone() const
+{
+    return std::unique_ptr<SelectionStrategy>(new WalkAndWaitStrategy(*this));
+}
+
+double WalkAndWaitStrategy::expectedStillWaiting(int people, double expectedServed)
+{
+    if (people <= 0)
+    {
+        return 0.0;
+    }
+    if (people > MAX_EXACT_PEOPLE || !(expectedServed > 0.0))
+    {
+        return std::max(0.0, people - expectedServed); // Long lines: the count served is close to its mean
+    }
+
+    // Services completed during the walk ~ Poisson(expectedServed): E[max(0, people - served)]
+    double probability = std::exp(-expectedServed);
+    double stillWaiting = 0.0;
+    for (int served = 0; served < people; ++served)
+    {
+        stillWaiting += (people - served) * probability;
+        probability *= expectedServed / (served + 1);
+    }
+    return stillWaiting;
+}
+
+double WalkAndWaitStrategy::score(const LineStatus &line) const
+{
+    // Same drain rate as LookaheadStrategy: observed throughput understates a starved line
+    double serviceRate = std::max(std::max(line.serviceRate, line.expectedServiceRate), 1e-6);
+
+    // The people in line now are served while the person walks, but service times vary, so a short
+    // line is not sure to be empty on arrival; everyone sent there earlier is still ahead of them
+    double ahead = expectedStillWaiting(line.people, serviceRate * line.walkSeconds) + line.pending;
+    double wait = ahead / serviceRate;
+
+    // People joining while they wait and are served each wait one service more; without this, lines
+    // near the station fill up until their wait cancels the walk saved, which is worse for everyone
+    double delayToOthers = line.arrivalForecast * (wait + 1.0 / serviceRate) / serviceRate;
+    return line.walkSeconds + wait + delayToOthers;
+}
+
+std::unique_ptr<SelectionStrategy> AdaptiveStrategy::clone() const
+{
+    return std::unique_ptr<SelectionStrategy>(new AdaptiveStrategy(*this));
+}
+
+void AdaptiveStrategy::reset(const LineStatus *lines, int numberOfLines)
+{
+    m_shortestWait.reset(lines, numberOfLines);
+    m_fewestPeople.reset(lines, numberOfLines);
+    m_reliable.assign(static_cast<size_t>(numberOfLines), false);
+    m_unreliableLines = 0;
+    for (int i = 0; i < numberOfLines; ++i)
+    {
+        m_reliable[i] = lines[i].reliable;
+        m_unreliableLines += lines[i].reliable ? 0 : 1;
+    }
+}
+
+void AdaptiveStrategy::onLineChanged(const LineStatus &line)
+{
+    m_shortestWait.onLineChanged(line);
+    m_fewestPeople.onLineChanged(line);
+    if (m_reliable[line.lineIndex] != line.reliable)
+    {
+        m_reliable[line.lineIndex] = line.reliable;
+        m_unreliableLines += line.reliable ? -1 : 1;
+    }
+}
+
+int AdaptiveStrategy::select() const
+{
+    return m_unreliableLines == 0 ? m_shortestWait.select() : m_fewestPeople.select();
+}
+
+LineSelectionStrategy AdaptiveStrategy::getActiveStrategy() const
+{
+    return m_unreliableLines == 0 ? LineSelectionStrategy::SHORTEST_WAIT_TIME : LineSelectionStrategy::FEWEST_PEOPLE;
+}
+
+PowerOfDStrategy::PowerOfDStrategy(int choices, uint32_t seed)
+    : m_choices(choices < 1 ? 1 : choices), m_rngState(0x9E3779B97F4A7C15ULL ^ seed)
+{
+}
+
+double PowerOfDStrategy::nextUniform() const
+{
+    m_rngState ^= m_rngState >> 12;
+    m_rngState ^= m_rngState << 25;
+    m_rngState ^= m_rngState >> 27;
+    uint64_t bits = m_rngState * 0x2545F4914F6CDD1DULL;
+    return static_cast<double>(bits >> 11) * (1.0 / 9007199254740992.0); // Top 53 bits
+}
+
+void PowerOfDStrategy::rebuildSampler()
+{
+    m_sampler.assign(m_weights.data(), m_weights.size());
+    m_totalWeight = 0.0;
+    for (double weight : m_weights)
+    {
+        m_totalWeight += weight;
+    }
+    m_updatesSinceRebuild = 0;
+}
+
+std::unique_ptr<SelectionStrategy> PowerOfDStrategy::clone() const
+{
+    return std::unique_ptr<SelectionStrategy>(new PowerOfDStrategy(*this));
+}
+
+void PowerOfDStrategy::reset(const LineStatus *lines, int numberOfLines)
+{
+    m_weights.assign(static_cast<size_t>(numberOfLines), 0.0);
+    m_waitEstimates.assign(static_cast<size_t>(numberOfLines), 0.0);
+    for (int i = 0; i < numberOfLines; ++i)
+    {
+        m_weights[i] = weightOf(lines[i]);
+        m_waitEstimates[i] = lines[i].waitEstimate;
+    }
+    m_drawn.clear();
+    m_drawn.reserve(std::min(static_cast<size_t>(m_choices), m_weights.size()));
+    rebuildSampler();
+}
+
+double PowerOfDStrategy::weightOf(const LineStatus &line)
+{
+    return line.eligible ? std::max(line.serviceRate, 1e-6) : 0.0;
+}
+
+void PowerOfDStrategy::onLineChanged(const LineStatus &line)
+{
+    m_waitEstimates[line.lineIndex] = line.waitEstimate;
+
+    double weight = weightOf(line);
+    double delta = weight - m_weights[line.lineIndex];
+    if (delta == 0.0)
+    {
+        return;
+    }
+    m_weights[line.lineIndex] = weight;
+
+    // Incremental floating point updates drift; start from the exact weights now and then
+    if (++m_updatesSinceRebuild >= REBUILD_INTERVAL)
+    {
+        rebuildSampler();
+    }
+    else
+    {
+        m_sampler.add(static_cast<size_t>(line.lineIndex), delta);
+        m_totalWeight += delta;
+    }
+}
+
+int PowerOfDStrategy::select() const
+{
+    if (!(m_totalWeight > 0.0))
+    {
+        return -1; // No eligible line
+    }
+
+    // Draw without replacement: sample the weight not drawn yet, then shift the target past
+    // every drawn line that starts at or below it
+    int best = -1;
+    double remaining = m_totalWeight;
+    size_t draws = std::min(static_cast<size_t>(m_choices), m_weights.size());
+    m_drawn.clear();
+    for (size_t sample = 0; sample < draws && remaining > 0.0; ++sample)
+    {
+        double target = nextUniform() * remaining;
+        for (size_t drawn : m_drawn)
+        {
+            if (target < m_sampler.prefixSum(drawn))
+            {
+                break;
+            }
+            target += m_weights[drawn];
+        }
+        size_t slot = m_sampler.upperBound(target);
+        if (slot >= m_weights.size() || m_weights[slot] == 0.0 ||
+            std::binary_search(m_drawn.begin(), m_drawn.end(), slot))
+        {
+            continue; // Rounding landed past the end, on an ineligible or on a drawn line; this draw is lost
+        }
+        m_drawn.insert(std::lower_bound(m_drawn.begin(), m_drawn.end(), slot), slot);
+        remaining -= m_weights[slot];
+
+        int candidate = static_cast<int>(slot);
+        if (best < 0 || m_waitEstimates[candidate] < m_waitEstimates[best] ||
+            (m_waitEstimates[candidate] == m_waitEstimates[best] && candidate < best))
+        {
+            best = candidate;
+        }
+    }
+    if (best >= 0)
+    {
+        return best;
+    }
+
+    // Every draw was rejected (only possible through rounding): fall back to the first eligible line
+    for (size_t i = 0; i < m_weights.size(); ++i)
+    {
+        if (m_weights[i] > 0.0)
+        {
+            return static_cast<int>(i);
+        }
+    }
+    return -1;
+}
+
+namespace
+{
+    struct RegistryTable
+    {
+        std::mutex mutex;
+        std::vector<std::pair<std::string, StrategyRegistry::Factory>> factories;
+    };
+
+    template <typename Strategy>
+    void addBuiltIn(RegistryTable &table)
+    {
+        Strategy prototype;
+        table.factories.emplace_back(prototype.getName(), []
+                                     { return std::unique_ptr<SelectionStrategy>(new Strategy()); });
+    }
+
+    RegistryTable &registryTable()
+    {
+        static RegistryTable table;
+        static const bool builtInsAdded = [] // Static init is thread-safe
+        {
+            addBuiltIn<ShortestWaitTimeStrategy>(table);
+            addBuiltIn<FewestPeopleStrategy>(table);
+            addBuiltIn<FarthestFromEntranceStrategy>(table);
+            addBuiltIn<NearestToEntranceStrategy>(table);
+            addBuiltIn<AdaptiveStrategy>(table);
+            addBuiltIn<ShortestWorkloadStrategy>(table);
+            addBuiltIn<LookaheadStrategy>(table);
+            addBuiltIn<WalkAndWaitStrategy>(table);
+            addBuiltIn<PowerOfDStrategy>(table);
+            return true;
+        }();
+        (void)builtInsAdded;
+        return table;
+    }
+}
+
+bool StrategyRegistry::add(const std::string &name, Factory factory)
+{
+    RegistryTable &table = registryTable();
+    std::lock_guard<std::mutex> lock(table.mutex);
+    for (const auto &entry : table.factories)
+    {
+        if (entry.first == name)
+        {
+            return false;
+        }
+    }
+    table.factories.emplace_back(name, std::move(factory));
+    return true;
+}
+
+std::unique_ptr<SelectionStrategy> StrategyRegistry::create(const std::string &name)
+{
+    RegistryTable &table = registryTable();
+    std::lock_guard<std::mutex> lock(table.mutex);
+    for (const auto &entry : table.factories)
+    {
+        if (entry.first == name)
+        {
+            return entry.second();
+        }
+    }
+    return nullptr;
+}
+
+std::vector<std::string> StrategyRegistry::names()
+{
+    RegistryTable &table = registryTable();
+    std::lock_guard<std::mutex> lock(table.mutex);
+    std::vector<std::string> result;
+    result.reserve(table.factories.size());
+    for (const auto &entry : table.factories)
+    {
+        result.push_back(entry.first);
+    }
+    return result;
+}
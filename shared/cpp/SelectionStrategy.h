@@ -0,0 +1,308 @@
+#pragma once
+
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <string>
+#include <vector>
+#include "FenwickTree.h"
+#include "IndexedMinHeap.h"
+#include "LineSelectionStrategy.h"
+
+/**
+ * @brief What a selection strategy is told about one line after it changed
+ */
+struct LineStatus
+{
+    int lineIndex;       ///< 0-based line
+    int people;          ///< People waiting (abandoned entries not counted)
+    double waitEstimate; ///< Estimated wait for a new arrival in seconds (cached by QueueManager)
+    double serviceRate;  ///< Current throughput estimate in people/second
+    double expectedServiceRate; ///< Configured service rate of the line in people/second
+    double outstandingWork; ///< Service demand of everyone waiting (1.0 = one average customer)
+    double workRate;     ///< Current throughput in service demand/second (serviceRate × mean demand served)
+    int pending;         ///< Recommended to this line but not yet seen by its sensor (QueueManager::recommendLine)
+    double arrivalForecast; ///< Expected people/second joining this line on their own (system arrival rate / lines)
+    double walkSeconds;  ///< Walk from the hostess station to the line (QueueManager::setVenueLayout), 0 if unknown
+    bool eligible;       ///< Available and below capacity; only eligible lines may be selected
+    bool reliable;       ///< The line's throughput tracker has enough completions to trust its rate
+};
+
+/**
+ * @brief Line selection strategy kept up to date incrementally by QueueManager
+ *
+ * QueueManager calls reset() once with every line, then one hook per change to a single
+ * line, so a strategy can keep its own ranking and answer select() without rescanning.
+ * The event hooks forward to onLineChanged() unless overridden.
+ *
+ * A QueueManager owns one instance per strategy; fork() clones them.
+ */
+class SelectionStrategy
+{
+public:
+    virtual ~SelectionStrategy() = default;
+
+    /// Name used by the registry and in logs
+    virtual const char *getName() const = 0;
+
+    /// Independent copy with the same state (for QueueManager::fork)
+    virtual std::unique_ptr<SelectionStrategy> clone() const = 0;
+
+    /**
+     * @brief Rebuilds the strategy's state from scratch
+     * @param lines Status of every line, indexed by line
+     * @param numberOfLines Number of entries in lines
+     */
+    virtual void reset(const LineStatus *lines, int numberOfLines) = 0;
+
+    virtual void onArrival(const LineStatus &line) { onLineChanged(line); }
+    virtual void onService(const LineStatus &line) { onLineChanged(line); }
+    virtual void onAbandonment(const LineStatus &line) { onLineChanged(line); }
+    virtual void onAvailabilityChange(const LineStatus &line) { onLineChanged(line); }
+
+    /// Any other change to one line (e.g. its estimate moved with the arrival rate)
+    virtual void onLineChanged(const LineStatus &line) = 0;
+
+    /**
+     * @brief Line for the next arrival
+     * @return 0-based line index, or -1 if no line is eligible
+     */
+    virtual int select() const = 0;
+};
+
+/**
+ * @brief Strategy that ranks eligible lines by a per-line score (lowest wins, ties to the lower line)
+ *
+ * Keeps an indexed min-heap, so a change is O(log lines) and select() is O(1).
+ */
+class ScoredSelectionStrategy : public SelectionStrategy
+{
+public:
+    void reset(const LineStatus *lines, int numberOfLines) override;
+    void onLineChanged(const LineStatus &line) override;
+    int select() const override;
+
+protected:
+    /// Score of an eligible line
+    virtual double score(const LineStatus &line) const = 0;
+
+private:
+    IndexedMinHeap m_ranking;
+};
+
+/// Shortest estimated wait (LineSelectionStrategy::SHORTEST_WAIT_TIME)
+class ShortestWaitTimeStrategy : public ScoredSelectionStrategy
+{
+public:
+    const char *getName() const override { return "shortest_wait_time"; }
+    std::unique_ptr<SelectionStrategy> clone() const override;
+
+protected:
+    double score(const LineStatus &line) const override { return line.waitEstimate; }
+};
+
+/// Fewest people waiting (LineSelectionStrategy::FEWEST_PEOPLE)
+class FewestPeopleStrategy : public ScoredSelectionStrategy
+{
+public:
+    const char *getName() const override { return "fewest_people"; }
+    std::unique_ptr<SelectionStrategy> clone() const override;
+
+protected:
+    double score(const LineStatus &line) const override { return static_cast<double>(line.people); }
+};
+
+/// Highest line number (LineSelectionStrategy::FARTHEST_FROM_ENTRANCE)
+class FarthestFromEntranceStrategy : public ScoredSelectionStrategy
+{
+public:
+    const char *getName() const override { return "farthest_from_entrance"; }
+    std::unique_ptr<SelectionStrategy> clone() const override;
+
+protected:
+    double score(const LineStatus &line) const override { return -static_cast<double>(line.lineIndex); }
+};
+
+/// Lowest line number (LineSelectionStrategy::NEAREST_TO_ENTRANCE)
+class NearestToEntranceStrategy : public ScoredSelectionStrategy
+{
+public:
+    const char *getName() const override { return "nearest_to_entrance"; }
+    std::unique_ptr<SelectionStrategy> clone() const override;
+
+protected:
+    double score(const LineStatus &line) const override { return static_cast<double>(line.lineIndex); }
+};
+
+/**
+ * @brief Least outstanding work (LineSelectionStrategy::SHORTEST_WORKLOAD)
+ *
+ * Scores a line by its waiting service demand divided by its throughput in demand per second,
+ * i.e. the seconds of work ahead, so one large basket counts for more than several small ones.
+ * People per second would count a line's small baskets twice: once in the demand, and again
+ * in the extra people it completes.
+ */
+class ShortestWorkloadStrategy : public ScoredSelectionStrategy
+{
+public:
+    const char *getName() const override { return "shortest_workload"; }
+    std::unique_ptr<SelectionStrategy> clone() const override;
+
+protected:
+    double score(const LineStatus &line) const override
+    {
+        return line.workRate > 0.0 ? line.outstandingWork / line.workRate : line.outstandingWork;
+    }
+};
+
+/**
+ * @brief Lookahead routing (LineSelectionStrategy::LOOKAHEAD)
+ *
+ * Projects each line `horizon` seconds ahead, the time a recommended person takes to reach it:
+ * the people waiting now, less what the line serves meanwhile, plus everyone already sent there
+ * (LineStatus::pending). The score is the projected wait of the new person plus the delay their
+ * service adds for the people forecast to join behind them within the horizon, so slow lines pay
+ * for the customers they hold up, not just for the next one. With a zero horizon this is the
+ * wait behind everyone waiting or already sent there.
+ */
+class LookaheadStrategy : public ScoredSelectionStrategy
+{
+public:
+    /// @param horizonSeconds How far ahead lines are projected (typical time to reach a line)
+    explicit LookaheadStrategy(double horizonSeconds = 30.0) : m_horizonSeconds(horizonSeconds) {}
+
+    const char *getName() const override { return "lookahead"; }
+    std::unique_ptr<SelectionStrategy> clone() const override;
+
+    double getHorizonSeconds() const { return m_horizonSeconds; }
+
+protected:
+    double score(const LineStatus &line) const override;
+
+private:
+    double m_horizonSeconds;
+};
+
+/**
+ * @brief Walk plus wait (LineSelectionStrategy::WALK_AND_WAIT)
+ *
+ * Scores a line by the time to walk to it plus the wait predicted for when the person gets
+ * there: the line keeps serving during the walk (with random service times, so a short line may
+ * not be empty yet), and everyone already sent there gets in first. Like LookaheadStrategy it
+ * adds the delay the person's service causes for those joining behind them. A far line only wins
+ * if its shorter wait outweighs the extra walk. Without a venue layout every walk is 0.
+ */
+class WalkAndWaitStrategy : public ScoredSelectionStrategy
+{
+public:
+    const char *getName() const override { return "walk_and_wait"; }
+    std::unique_ptr<SelectionStrategy> clone() const override;
+
+protected:
+    double score(const LineStatus &line) const override;
+
+private:
+    static const int MAX_EXACT_PEOPLE = 64; // Longer lines use the mean number served
+
+    /// Expected people of `people` still waiting after a walk during which `expectedServed` services complete on average
+    static double expectedStillWaiting(int people, double expectedServed);
+};
+
+/**
+ * @brief Fewest people until every line has reliable throughput data, then shortest wait
+ * (LineSelectionStrategy::ADAPTIVE, used by enqueueAuto/dequeueAuto)
+ *
+ * Counts unreliable lines as they change, so the switch costs nothing per call.
+ */
+class AdaptiveStrategy : public SelectionStrategy
+{
+public:
+    const char *getName() const override { return "adaptive"; }
+    std::unique_ptr<SelectionStrategy> clone() const override;
+    void reset(const LineStatus *lines, int numberOfLines) override;
+    void onLineChanged(const LineStatus &line) override;
+    int select() const override;
+
+    /// Strategy select() currently applies (SHORTEST_WAIT_TIME or FEWEST_PEOPLE)
+    LineSelectionStrategy getActiveStrategy() const;
+
+private:
+    ShortestWaitTimeStrategy m_shortestWait;
+    FewestPeopleStrategy m_fewestPeople;
+    std::vector<bool> m_reliable;
+    int m_unreliableLines = 0;
+};
+
+/**
+ * @brief Power-of-d choices (JSQ(d)): samples d eligible lines, joins the one with the shortest estimated wait
+ *
+ * Lines are sampled without replacement with probability proportional to their throughput,
+ * so fast lines are looked at more often but a decision still compares d distinct lines
+ * (every eligible line if there are fewer). Because every call samples afresh, arrivals
+ * acting on the same (possibly stale) recommendation spread over several good lines instead
+ * of all joining the single best one. A change is O(log lines) and select() is
+ * O(d log lines + d^2).
+ *
+ * Registered as "power_of_two_choices" (d = 2); attach other d values with
+ * QueueManager::addStrategy(std::unique_ptr<SelectionStrategy>(new PowerOfDStrategy(d))).
+ */
+class PowerOfDStrategy : public SelectionStrategy
+{
+public:
+    /**
+     * @param choices Lines sampled per decision (d, at least 1)
+     * @param seed Sampling seed; clones continue the same sequence
+     */
+    explicit PowerOfDStrategy(int choices = 2, uint32_t seed = 1);
+
+    const char *getName() const override { return m_choices == 2 ? "power_of_two_choices" : "power_of_d_choices"; }
+    std::unique_ptr<SelectionStrategy> clone() const override;
+    void reset(const LineStatus *lines, int numberOfLines) override;
+    void onLineChanged(const LineStatus &line) override;
+    int select() const override;
+
+    int getChoices() const { return m_choices; }
+
+private:
+    static const int REBUILD_INTERVAL = 4096; // Weight updates between exact rebuilds of the sampling tree
+
+    /// Sampling weight of a line: its throughput (with a floor so a stalled line can still be tried), 0 if ineligible
+    static double weightOf(const LineStatus &line);
+
+    int m_choices;
+    std::vector<double> m_weights;       // Sampling weight per line (0 = not eligible)
+    std::vector<double> m_waitEstimates; // Wait estimate per line
+    BasicFenwickTree<double> m_sampler;  // Running sums of m_weights
+    double m_totalWeight = 0.0;          // Sum of m_weights, kept alongside the tree
+    int m_updatesSinceRebuild = 0;
+    mutable uint64_t m_rngState;         // xorshift64*; select() is logically const, sampling advances it
+    mutable std::vector<size_t> m_drawn; // Lines already drawn by the current select(), ascending
+
+    /// Uniform draw in [0, 1)
+    double nextUniform() const;
+    void rebuildSampler();
+};
+
+/**
+ * @brief Process-wide table of strategy factories by name
+ *
+ * The built-in strategies are registered under their getName(). Register custom
+ * strategies once at startup, then attach them with QueueManager::addStrategy(name).
+ */
+class StrategyRegistry
+{
+public:
+    using Factory = std::function<std::unique_ptr<SelectionStrategy>()>;
+
+    /**
+     * @brief Registers a factory
+     * @return false if the name is already taken
+     */
+    static bool add(const std::string &name, Factory factory);
+
+    /// New instance of a registered strategy, or nullptr if the name is unknown
+    static std::unique_ptr<SelectionStrategy> create(const std::string &name);
+
+    /// Registered names, built-ins first
+    static std::vector<std::string> names();
+};
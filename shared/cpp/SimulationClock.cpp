@@ -0,0 +1,40 @@
+#include "SimulationClock.h"
+#include <atomic>
+#include <chrono>
+
+namespace
+{
+    std::atomic<SimulationClock::Source> s_source{nullptr};
+}
+
+void SimulationClock::setSource(Source source)
+{
+    s_source.store(source, std::memory_order_release);
+}
+
+bool SimulationClock::isSimulated()
+{
+    return s_source.load(std::memory_order_acquire) != nullptr;
+}
+
+long long SimulationClock::systemMillis()
+{
+    if (Source source = s_source.load(std::memory_order_acquire))
+    {
+        return source();
+    }
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+               std::chrono::system_clock::now().time_since_epoch())
+        .count();
+}
+
+long long SimulationClock::steadyMillis()
+{
+    if (Source source = s_source.load(std::memory_order_acquire))
+    {
+        return source();
+    }
+    return std::chrono::duration_cast<std::chrono::milliseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
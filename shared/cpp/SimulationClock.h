@@ -0,0 +1,31 @@
+#pragma once
+
+/**
+ * @brief Time source behind Person timestamps and ThroughputTracker session times
+ *
+ * By default Person reads the system clock and ThroughputTracker the steady clock.
+ * Offline simulators install their own source (a simulated time that advances event
+ * by event) so a whole day of traffic runs in seconds with realistic waits and rates.
+ * Install the source before creating any QueueManager.
+ */
+class SimulationClock
+{
+public:
+    /// Current time in milliseconds; must never go backwards
+    using Source = long long (*)();
+
+    /**
+     * @brief Replaces both clocks with one source
+     * @param source Simulated time, or nullptr to go back to the real clocks
+     */
+    static void setSource(Source source);
+
+    /// true if a simulated source is installed
+    static bool isSimulated();
+
+    /// Wall-clock milliseconds since epoch (or the simulated time)
+    static long long systemMillis();
+
+    /// Monotonic milliseconds for measuring durations (or the simulated time)
+    static long long steadyMillis();
+};
@@ -1,93 +1,214 @@
 #include "ThroughputTracker.h"
+#include "SimulationClock.h"
 #include <algorithm>
 
 ThroughputTracker::ThroughputTracker(double expectedRate)
-    : sessionStartTime(std::chrono::steady_clock::now()),
-      lastServiceTime(sessionStartTime),
+    : sessionStartMillis(SimulationClock::steadyMillis()),
+      lastServiceMillis(sessionStartMillis),
       serviceCompletionCount(0),
       currentThroughput(expectedRate),
+      perServerThroughput(expectedRate),
       hasRecordedService(false),
+      serverCount(1),
+      staffedServerMillis(0),
+      staffingChangeMillis(0),
+      classServiceCounts(),
+      classServiceSeconds(),
+      demandServiceCount(0),
+      completedDemand(0.0),
+      arrivalCount(0),
+      abandonmentCount(0),
       expectedServiceRate(expectedRate)
 {
 }
 
 void ThroughputTracker::recordServiceCompletion()
 {
-    auto currentTime = std::chrono::steady_clock::now();
+    recordServiceCompletionAt(getSessionTimeMillis());
+}
 
+void ThroughputTracker::recordServiceCompletionAt(long long sessionMillis)
+{
     serviceCompletionCount++;
-    lastServiceTime = currentTime;
+    lastServiceMillis = sessionStartMillis + sessionMillis;
     hasRecordedService = true;
 
-    // Calculate throughput using total session time and service count
-    auto totalSessionTime = std::chrono::duration_cast<std::chrono::milliseconds>(
-                                currentTime - sessionStartTime)
-                                .count();
+    // Calculate per-register throughput using staffed register-time and service count
+    long long totalStaffedTime = staffedServerMillis + (sessionMillis - staffingChangeMillis) * serverCount;
 
-    if (totalSessionTime > 0)
+    if (totalStaffedTime > 0)
     {
-        double observedThroughput = static_cast<double>(serviceCompletionCount) / (totalSessionTime / 1000.0);
+        double observedThroughput = static_cast<double>(serviceCompletionCount) / (totalStaffedTime / 1000.0);
 
         if (hasReliableData())
         {
             // Use observed rate when we have enough data
-            currentThroughput = observedThroughput;
+            perServerThroughput = observedThroughput;
         }
         else
         {
             // Blend expected rate with observed rate for early measurements
             double blendFactor = static_cast<double>(serviceCompletionCount) / MIN_SERVICES_FOR_RELIABLE_DATA;
-            currentThroughput = expectedServiceRate * (1.0 - blendFactor) + observedThroughput * blendFactor;
+            perServerThroughput = expectedServiceRate * (1.0 - blendFactor) + observedThroughput * blendFactor;
         }
+        currentThroughput = perServerThroughput * serverCount;
     }
 }
 
-double ThroughputTracker::getEstimatedWaitTime(int queueLength, double arrivalRate) const
+void ThroughputTracker::setServerCount(int servers)
 {
-    if (queueLength == 0)
-        return 0.0;
+    setServerCountAt(servers, getSessionTimeMillis());
+}
 
-    // Basic M/M/1 calculation: Average wait time = n/μ (for people currently in queue)
-    double basicWaitTime = static_cast<double>(queueLength) / currentThroughput;
+void ThroughputTracker::setServerCountAt(int servers, long long sessionMillis)
+{
+    // Close the staffing period that just ended before switching
+    staffedServerMillis += (sessionMillis - staffingChangeMillis) * serverCount;
+    staffingChangeMillis = sessionMillis;
+    serverCount = std::max(1, servers);
+    currentThroughput = perServerThroughput * serverCount;
+}
 
-    // Apply M/M/1 theory if arrival rate is provided and system is not saturated
-    if (arrivalRate > 0.0 && isSystemStable(arrivalRate))
-    {
-        return applyMM1Theory(basicWaitTime, queueLength, arrivalRate);
-    }
+int ThroughputTracker::getServerCount() const
+{
+    return serverCount;
+}
 
-    return basicWaitTime;
+double ThroughputTracker::getPerServerThroughput() const
+{
+    return perServerThroughput;
 }
 
-double ThroughputTracker::applyMM1Theory(double basicWaitTime, int queueLength, double arrivalRate) const
+long long ThroughputTracker::getStaffedServerMillis() const
 {
-    // M/M/1 Queue Theory:
-    // ρ = λ/μ (utilization factor)
-    // W_q = ρ/(μ-λ) = λ/(μ(μ-λ)) (average wait time in queue)
-    // W_s = 1/μ (average service time)
-    // W = W_q + W_s = 1/(μ-λ) (average time in system)
+    return staffedServerMillis + (getSessionTimeMillis() - staffingChangeMillis) * serverCount;
+}
 
-    double rho = arrivalRate / currentThroughput;
+void ThroughputTracker::recordClassService(CustomerClass customerClass, double serviceSeconds)
+{
+    int index = static_cast<int>(customerClass);
+    classServiceCounts[index]++;
+    classServiceSeconds[index] += std::max(0.0, serviceSeconds);
+}
 
-    if (rho >= 0.95) // Safety margin to prevent numerical issues
+double ThroughputTracker::getOverallMeanServiceSeconds() const
+{
+    int count = 0;
+    double seconds = 0.0;
+    for (int i = 0; i < CUSTOMER_CLASS_COUNT; ++i)
     {
-        return basicWaitTime; // Fallback to basic calculation
+        count += classServiceCounts[i];
+        seconds += classServiceSeconds[i];
     }
+    if (count >= MIN_SERVICES_FOR_RELIABLE_DATA && seconds > 0.0)
+        return seconds / count;
+    return 1.0 / perServerThroughput;
+}
 
-    // For M/M/1: Expected wait time in queue = ρ/(μ-λ) * (1/μ)
-    double avgServiceTime = 1.0 / currentThroughput;
-    double avgWaitTimeInQueue = (rho / (1.0 - rho)) * avgServiceTime;
+double ThroughputTracker::getMeanServiceSeconds(CustomerClass customerClass) const
+{
+    int index = static_cast<int>(customerClass);
+    if (classServiceCounts[index] >= MIN_SERVICES_FOR_RELIABLE_DATA && classServiceSeconds[index] > 0.0)
+        return classServiceSeconds[index] / classServiceCounts[index];
+    return getOverallMeanServiceSeconds();
+}
 
-    // Scale by current queue length vs theoretical average queue length
-    double theoreticalAvgQueueLength = rho * rho / (1.0 - rho); // E[Nq] in M/M/1
+int ThroughputTracker::getClassServiceCount(CustomerClass customerClass) const
+{
+    return classServiceCounts[static_cast<int>(customerClass)];
+}
 
-    if (theoreticalAvgQueueLength > 0)
+double ThroughputTracker::getClassServiceSeconds(CustomerClass customerClass) const
+{
+    return classServiceSeconds[static_cast<int>(customerClass)];
+}
+
+double ThroughputTracker::getClassMixFactor(const int *classCounts) const
+{
+    double overallMean = getOverallMeanServiceSeconds();
+    int people = 0;
+    double mixSeconds = 0.0;
+    for (int i = 0; i < CUSTOMER_CLASS_COUNT; ++i)
     {
-        double scaleFactor = static_cast<double>(queueLength) / theoreticalAvgQueueLength;
-        return avgWaitTimeInQueue * scaleFactor;
+        if (classCounts[i] > 0)
+        {
+            people += classCounts[i];
+            mixSeconds += classCounts[i] * getMeanServiceSeconds(static_cast<CustomerClass>(i));
+        }
     }
+    if (people == 0 || !(overallMean > 0.0))
+        return 1.0;
+    return mixSeconds / (people * overallMean);
+}
+
+void ThroughputTracker::recordServiceDemand(double serviceDemand)
+{
+    demandServiceCount++;
+    completedDemand += std::max(0.0, serviceDemand);
+}
+
+double ThroughputTracker::getMeanServiceDemand() const
+{
+    if (demandServiceCount >= MIN_SERVICES_FOR_RELIABLE_DATA && completedDemand > 0.0)
+        return completedDemand / demandServiceCount;
+    return 1.0;
+}
+
+double ThroughputTracker::getWorkThroughput() const
+{
+    return currentThroughput * getMeanServiceDemand();
+}
+
+int ThroughputTracker::getDemandServiceCount() const
+{
+    return demandServiceCount;
+}
+
+double ThroughputTracker::getCompletedDemand() const
+{
+    return completedDemand;
+}
+
+void ThroughputTracker::recordArrival()
+{
+    arrivalCount++;
+}
+
+void ThroughputTracker::recordAbandonment()
+{
+    abandonmentCount++;
+}
+
+double ThroughputTracker::getAbandonmentRatio() const
+{
+    if (arrivalCount < MIN_SERVICES_FOR_RELIABLE_DATA)
+        return 0.0;
+    return std::min(1.0, static_cast<double>(abandonmentCount) / arrivalCount);
+}
+
+int ThroughputTracker::getArrivalCount() const
+{
+    return arrivalCount;
+}
 
-    return basicWaitTime;
+int ThroughputTracker::getAbandonmentCount() const
+{
+    return abandonmentCount;
+}
+
+double ThroughputTracker::getEstimatedWaitTime(int queueLength) const
+{
+    // A free register serves a new arrival at once; otherwise n - c + 1 people must finish first
+    int waitingAhead = queueLength - serverCount + 1;
+    if (queueLength == 0 || waitingAhead <= 0)
+        return 0.0;
+
+    // M/M/c wait given the people already in line: all c registers busy, one frees up every
+    // 1/(cμ) on average (memoryless service), whatever the arrival rate behind them
+    double waitTime = static_cast<double>(waitingAhead) / currentThroughput;
+
+    // Reneging: on average only (1 - ratio) of the people ahead are still there when served
+    return waitTime * (1.0 - getAbandonmentRatio());
 }
 
 double ThroughputTracker::getUtilizationFactor(double arrivalRate) const
@@ -109,20 +230,80 @@ int ThroughputTracker::getServiceCount() const
 
 double ThroughputTracker::getSessionTimeSeconds() const
 {
-    auto currentTime = std::chrono::steady_clock::now();
-    auto totalTime = std::chrono::duration_cast<std::chrono::milliseconds>(
-                         currentTime - sessionStartTime)
-                         .count();
-    return totalTime / 1000.0;
+    return getSessionTimeMillis() / 1000.0;
+}
+
+long long ThroughputTracker::getSessionTimeMillis() const
+{
+    return SimulationClock::steadyMillis() - sessionStartMillis;
+}
+
+double ThroughputTracker::getExpectedServiceRate() const
+{
+    return expectedServiceRate;
+}
+
+void ThroughputTracker::restore(int serviceCount, double throughput, long long sessionMillis)
+{
+    sessionStartMillis = SimulationClock::steadyMillis() - sessionMillis;
+    lastServiceMillis = sessionStartMillis + sessionMillis;
+    serviceCompletionCount = serviceCount;
+    currentThroughput = throughput;
+    perServerThroughput = throughput / serverCount;
+    hasRecordedService = serviceCount > 0;
+    staffingChangeMillis = sessionMillis;
+    staffedServerMillis = sessionMillis * serverCount;
+}
+
+void ThroughputTracker::resumeSessionAt(long long sessionMillis)
+{
+    long long resumedStartMillis = SimulationClock::steadyMillis() - sessionMillis;
+    lastServiceMillis += resumedStartMillis - sessionStartMillis;
+    sessionStartMillis = resumedStartMillis;
+}
+
+void ThroughputTracker::restoreAbandonment(int arrivals, int abandonments)
+{
+    arrivalCount = arrivals;
+    abandonmentCount = abandonments;
+}
+
+void ThroughputTracker::restoreStaffing(int servers, long long staffedMillis)
+{
+    serverCount = std::max(1, servers);
+    perServerThroughput = currentThroughput / serverCount;
+    staffingChangeMillis = getSessionTimeMillis();
+    staffedServerMillis = staffedMillis;
+}
+
+void ThroughputTracker::restoreClassService(CustomerClass customerClass, int serviceCount, double serviceSeconds)
+{
+    classServiceCounts[static_cast<int>(customerClass)] = serviceCount;
+    classServiceSeconds[static_cast<int>(customerClass)] = serviceSeconds;
+}
+
+void ThroughputTracker::restoreServiceDemand(int serviceCount, double serviceDemand)
+{
+    demandServiceCount = serviceCount;
+    completedDemand = serviceDemand;
 }
 
 void ThroughputTracker::reset()
 {
-    sessionStartTime = std::chrono::steady_clock::now();
-    lastServiceTime = sessionStartTime;
+    sessionStartMillis = SimulationClock::steadyMillis();
+    lastServiceMillis = sessionStartMillis;
     serviceCompletionCount = 0;
-    currentThroughput = expectedServiceRate;
+    perServerThroughput = expectedServiceRate;
+    currentThroughput = perServerThroughput * serverCount;
     hasRecordedService = false;
+    staffedServerMillis = 0;
+    staffingChangeMillis = 0;
+    arrivalCount = 0;
+    abandonmentCount = 0;
+    classServiceCounts.fill(0);
+    classServiceSeconds.fill(0.0);
+    demandServiceCount = 0;
+    completedDemand = 0.0;
 }
 
 bool ThroughputTracker::hasReliableData() const
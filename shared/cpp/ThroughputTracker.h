@@ -1,32 +1,58 @@
 #pragma once
 
-#include <chrono>
+#include <array>
 #include <vector>
 #include <cmath>
+#include "CustomerClass.h"
 
 /**
- * Enhanced ThroughputTracker - M/M/1 Queue Theory Implementation
+ * Enhanced ThroughputTracker - M/M/c Queue Theory Implementation
  *
- * This class implements proper M/M/1 queue theory for constant-rate systems:
- * - Tracks service completion events for rate estimation
- * - Applies Little's Law and M/M/1 formulas
- * - Provides stability analysis (ρ < 1)
+ * This class implements M/M/c queue theory (one queue feeding c registers) for constant-rate systems:
+ * - Tracks service completion events for rate estimation, per staffed register
+ * - Estimates the wait of someone with n people ahead as (n - c + 1)/(cμ) (M/M/1 when c = 1)
+ * - Provides stability analysis (ρ = λ/(cμ) < 1) for a line's arrival rate
  * - Optimized for constant service rates (simulation environment)
  *
+ * The number of registers can change at any time as staff come and go. Completions are
+ * divided by staffed register-time, so the per-register rate stays comparable before and
+ * after a change, and the line's throughput is that rate times the registers staffed now.
+ *
+ * Time at the register is also tracked per customer class, so a line whose people are mostly
+ * express customers is estimated to move faster than one with the usual mix (getClassMixFactor).
+ *
  * Used by both QueueSimulator and ESP32 for consistent measurements
  */
 class ThroughputTracker
 {
 private:
-    // Time tracking
-    std::chrono::steady_clock::time_point sessionStartTime;
-    std::chrono::steady_clock::time_point lastServiceTime;
+    // Time tracking (SimulationClock::steadyMillis)
+    long long sessionStartMillis;
+    long long lastServiceMillis;
 
     // Service tracking
     int serviceCompletionCount;
-    double currentThroughput;
+    double currentThroughput;   // Whole line: perServerThroughput * serverCount
+    double perServerThroughput; // One register (μ in M/M/c notation)
     bool hasRecordedService;
 
+    // Staffing: registers serving this line, and register-time staffed so far
+    int serverCount;
+    long long staffedServerMillis; // Register-milliseconds up to staffingChangeMillis
+    long long staffingChangeMillis; // Session time of the last server count change
+
+    // Time at the register per customer class (seconds), for lines serving mixed classes
+    std::array<int, CUSTOMER_CLASS_COUNT> classServiceCounts;
+    std::array<double, CUSTOMER_CLASS_COUNT> classServiceSeconds;
+
+    // Service demand of the people served (1.0 = one average customer), for work-based routing
+    int demandServiceCount;
+    double completedDemand;
+
+    // Reneging tracking: people who joined this line and people who left it before service
+    int arrivalCount;
+    int abandonmentCount;
+
     // Expected service rate for this line (set during initialization)
     double expectedServiceRate;
 
@@ -36,8 +62,8 @@ private:
 
 public:
     /**
-     * Constructor - Initialize tracking for M/M/1 queue
-     * @param expectedRate Expected service rate for this line (μ in M/M/1 notation)
+     * Constructor - Initialize tracking for a line with one register
+     * @param expectedRate Expected service rate of one register (μ in M/M/c notation)
      */
     ThroughputTracker(double expectedRate = DEFAULT_THROUGHPUT);
 
@@ -48,22 +74,119 @@ public:
     void recordServiceCompletion();
 
     /**
-     * Get current measured throughput (people per second)
+     * Record a service completion that happened at a known point of the session
+     * Used when replaying an event log so the rebuilt throughput matches the original
+     * @param sessionMillis Milliseconds since this tracker's session start
+     */
+    void recordServiceCompletionAt(long long sessionMillis);
+
+    /**
+     * Set the number of staffed registers serving this line (at least 1)
+     * Scales the line's throughput right away; wait estimates switch to M/M/c
+     */
+    void setServerCount(int servers);
+
+    /**
+     * Set the number of staffed registers at a known point of the session (event log replay)
+     * @param sessionMillis Milliseconds since this tracker's session start
+     */
+    void setServerCountAt(int servers, long long sessionMillis);
+
+    int getServerCount() const;
+
+    /**
+     * Get the measured service rate of one register (people per second)
+     */
+    double getPerServerThroughput() const;
+
+    /**
+     * Get register-milliseconds staffed since the session start (completions are divided by this)
+     */
+    long long getStaffedServerMillis() const;
+
+    /**
+     * Record how long one customer of a class spent at the register
+     * @param serviceSeconds From reaching the register to leaving it
+     */
+    void recordClassService(CustomerClass customerClass, double serviceSeconds);
+
+    /**
+     * Get the mean time a customer of a class spends at the register (seconds)
+     * Falls back to the mean over all classes, then to 1/μ, until the class has enough services
+     */
+    double getMeanServiceSeconds(CustomerClass customerClass) const;
+
+    int getClassServiceCount(CustomerClass customerClass) const;
+    double getClassServiceSeconds(CustomerClass customerClass) const;
+
+    /**
+     * Get how much longer than the usual mix a given set of customers takes to serve
+     * @param classCounts People per class (CUSTOMER_CLASS_COUNT entries)
+     * @return Their mean service time over the mean of everyone served so far (1.0 = usual mix)
+     */
+    double getClassMixFactor(const int *classCounts) const;
+
+    /**
+     * Record the service demand of a person who just finished service
+     * @param serviceDemand 1.0 = one average customer (Person::getServiceDemand)
+     */
+    void recordServiceDemand(double serviceDemand);
+
+    /**
+     * Get the mean service demand of the people this line served (1.0 until enough were served)
+     */
+    double getMeanServiceDemand() const;
+
+    /**
+     * Get the throughput of the whole line in service demand per second
+     * Throughput counts people, so a line serving small baskets completes more of them; this
+     * divides that back out, so outstanding demand over it is the seconds of work ahead.
+     */
+    double getWorkThroughput() const;
+
+    int getDemandServiceCount() const;
+    double getCompletedDemand() const;
+
+    /**
+     * Record a person joining this line
+     */
+    void recordArrival();
+
+    /**
+     * Record a person leaving this line without being served (reneging)
+     */
+    void recordAbandonment();
+
+    /**
+     * Get the share of arrivals that abandoned the line (0 until enough arrivals were seen)
+     * Wait estimates assume each person ahead leaves with this probability
+     */
+    double getAbandonmentRatio() const;
+
+    int getArrivalCount() const;
+    int getAbandonmentCount() const;
+
+    /**
+     * Get current measured throughput of the whole line (people per second, all registers)
      * Blends expected rate with observed rate for stability
      */
     double getCurrentThroughput() const;
 
     /**
-     * Get estimated wait time using M/M/1 queue theory
-     * @param queueLength Current number of people in queue (n)
-     * @param arrivalRate Current arrival rate (λ)
-     * @return Expected wait time in seconds using W = n/μ or M/M/1 formulas
+     * Get estimated wait time using M/M/c queue theory
+     * With service memoryless, the wait of a new arrival depends only on the people already in
+     * line, not on the arrival rate behind them.
+     * @param queueLength Current number of people in line, including those at a register (n)
+     * @return Expected wait time in seconds until a register is free for a new arrival: 0 while
+     *         fewer than c people are in line, otherwise (n - c + 1)/(cμ), scaled down by the
+     *         abandonment ratio (people ahead who will leave)
      */
-    double getEstimatedWaitTime(int queueLength, double arrivalRate = 0.0) const;
+    double getEstimatedWaitTime(int queueLength) const;
 
     /**
-     * Get utilization factor (ρ = λ/μ)
-     * Critical for M/M/1 stability analysis
+     * Get utilization factor (ρ = λ/(cμ))
+     * Critical for M/M/c stability analysis
+     * @param arrivalRate Arrival rate of this line (λ), not of the whole system
      */
     double getUtilizationFactor(double arrivalRate) const;
 
@@ -83,7 +206,57 @@ public:
     double getSessionTimeSeconds() const;
 
     /**
-     * Reset tracking (start new measurement session)
+     * Get total session time in whole milliseconds (the resolution used for throughput)
+     */
+    long long getSessionTimeMillis() const;
+
+    /**
+     * Get the expected service rate of one register this tracker was initialized with
+     */
+    double getExpectedServiceRate() const;
+
+    /**
+     * Restore a previously measured state (QueueManager snapshot)
+     * The session clock is rewound so that downtime between save and restore
+     * does not count as idle service time.
+     * @param serviceCount Completed services at save time
+     * @param throughput Throughput at save time (people/second)
+     * @param sessionMillis Session length at save time (milliseconds)
+     */
+    void restore(int serviceCount, double throughput, long long sessionMillis);
+
+    /**
+     * Continue the session clock from a known session time (QueueManager event log replay)
+     * Completions and staffing changes replayed at their logged session times are then
+     * divided by the logged session, not by the few seconds this process has been running.
+     * @param sessionMillis Last session time found in the log (milliseconds)
+     */
+    void resumeSessionAt(long long sessionMillis);
+
+    /**
+     * Restore previously recorded arrival and abandonment counts (QueueManager snapshot)
+     */
+    void restoreAbandonment(int arrivals, int abandonments);
+
+    /**
+     * Restore staffing (QueueManager snapshot); call after restore()
+     * @param servers Registers staffed at save time
+     * @param staffedMillis Register-milliseconds staffed at save time
+     */
+    void restoreStaffing(int servers, long long staffedMillis);
+
+    /**
+     * Restore the service time recorded for one class (QueueManager snapshot)
+     */
+    void restoreClassService(CustomerClass customerClass, int serviceCount, double serviceSeconds);
+
+    /**
+     * Restore the service demand recorded for the people served (QueueManager snapshot)
+     */
+    void restoreServiceDemand(int serviceCount, double serviceDemand);
+
+    /**
+     * Reset tracking (start new measurement session; the staffed registers stay)
      */
     void reset();
 
@@ -93,8 +266,6 @@ public:
     bool hasReliableData() const;
 
 private:
-    /**
-     * Apply M/M/1 queue theory for wait time calculation
-     */
-    double applyMM1Theory(double basicWaitTime, int queueLength, double arrivalRate) const;
+    /// Mean time at the register over every class, or 1/μ until enough services were timed
+    double getOverallMeanServiceSeconds() const;
 };
\ No newline at end of file
@@ -0,0 +1,79 @@
+#pragma once
+
+#include <cmath>
+#include <vector>
+
+/**
+ * @brief Where one line is, seen from the hostess station
+ */
+struct LinePlacement
+{
+    double x;           ///< Metres from the hostess station, across the venue
+    double y;           ///< Metres from the hostess station, into the venue
+    double walkSeconds; ///< Time to walk from the hostess station to the end of the line
+};
+
+/**
+ * @brief Venue geometry: the position of every line and the walking time to it
+ *
+ * Lines are added in line number order. A line's walking time is either measured on site
+ * or derived from its straight-line distance at a walking speed. QueueManager::setVenueLayout
+ * hands the walking times to the strategies (LineStatus::walkSeconds), so routing can weigh a
+ * shorter wait against a longer walk instead of assuming that line number equals distance.
+ */
+class VenueLayout
+{
+public:
+    static constexpr double DEFAULT_WALKING_SPEED = 1.0; ///< Metres per second, a shopper with a cart
+
+    /// @param walkingSpeed Metres per second used for lines added without a measured walking time
+    explicit VenueLayout(double walkingSpeed = DEFAULT_WALKING_SPEED)
+        : m_walkingSpeed(walkingSpeed > 0.0 ? walkingSpeed : DEFAULT_WALKING_SPEED) {}
+
+    /**
+     * @brief Lines in a row in front of the hostess station, line 1 nearest
+     * @param numberOfLines Lines in the row
+     * @param firstDistance Metres from the station to line 1
+     * @param spacing Metres between neighbouring lines
+     * @param walkingSpeed Metres per second
+     */
+    static VenueLayout row(int numberOfLines, double firstDistance, double spacing,
+                           double walkingSpeed = DEFAULT_WALKING_SPEED)
+    {
+        VenueLayout layout(walkingSpeed);
+        for (int i = 0; i < numberOfLines; ++i)
+        {
+            layout.addLine(firstDistance + i * spacing, 0.0);
+        }
+        return layout;
+    }
+
+    /// Adds the next line; its walking time is the straight-line distance at the walking speed
+    void addLine(double x, double y)
+    {
+        m_lines.push_back(LinePlacement{x, y, std::sqrt(x * x + y * y) / m_walkingSpeed});
+    }
+
+    /// Adds the next line with a measured walking time (aisles, doors and displays in the way)
+    void addLine(double x, double y, double walkSeconds)
+    {
+        m_lines.push_back(LinePlacement{x, y, walkSeconds > 0.0 ? walkSeconds : 0.0});
+    }
+
+    int getNumberOfLines() const { return static_cast<int>(m_lines.size()); }
+
+    /// @param lineNumber 1-based line, must be between 1 and getNumberOfLines()
+    const LinePlacement &getLine(int lineNumber) const { return m_lines[lineNumber - 1]; }
+
+    /// @return Walking time to a line in seconds, or 0 if the line is not in the layout
+    double getWalkSeconds(int lineNumber) const
+    {
+        return lineNumber >= 1 && lineNumber <= getNumberOfLines() ? m_lines[lineNumber - 1].walkSeconds : 0.0;
+    }
+
+    double getWalkingSpeed() const { return m_walkingSpeed; }
+
+private:
+    double m_walkingSpeed;
+    std::vector<LinePlacement> m_lines;
+};
@@ -1,6 +1,7 @@
 #include <WiFi.h>
 #include <WiFiClient.h>
 #include "QueueManager.h"
+#include <LittleFS.h>
 #include <esp_core_dump.h> // for esp_core_dump_image_erase()
 #include "time.h"
 
@@ -91,6 +92,13 @@ static const int EXIT2_LINE_NUMBER = 2; // Sensor C drains line 2
 
 QueueManager *g_qm = nullptr; // late init in setup()
 
+// Warm restart: queue state is snapshotted to flash and restored on boot
+static const char *SNAPSHOT_FILE = "/queue_snapshot.bin";                   // LittleFS path
+static const char *SNAPSHOT_PATH = "/littlefs/queue_snapshot.bin";          // same file via VFS (stdio)
+static const unsigned long SNAPSHOT_INTERVAL_MS = 60000;                     // at most one flash write per minute
+unsigned long g_lastSnapshotAt = 0;
+uint64_t g_lastSnapshotVersion = 0;
+
 // ============================ Globals ==============================
 Sensor A, B, C;
 unsigned long lastUiAt = 0;
@@ -472,12 +480,12 @@ void handleKeyboard(Sensor &a, Sensor &b, Sensor &c)
     { // manual enqueue by strategy
       if (g_qm)
       {
-        int recommended = g_qm->getNextLineNumber(g_strategy);
-        bool ok = g_qm->enqueue(g_strategy);
-        if (ok)
+        EnqueueResult ticket = g_qm->enqueue(g_strategy);
+        if (ticket)
         {
           g_entryEvents++;
-          g_lastEvent = String("[ENTRY] Manual -> line ") + recommended;
+          g_lastEvent = String("[ENTRY] Manual -> line ") + ticket.lineNumber + " #" + ticket.position +
+                        " (~" + (int)ticket.predictedWait + "s)";
         }
         else
         {
@@ -535,15 +543,47 @@ void processEdges3(QueueManager &qmRef,
   bool exit1Rising = risingEdgeReady(exit1);
   bool exit2Rising = risingEdgeReady(exit2);
 
+  if (!hostessRising && !exit1Rising && !exit2Rising)
+    return;
+
+  // Collect this loop's edges and apply them together -> one Firebase publish per burst
+  QueueEvent events[3];
+  bool applied[3] = {false, false, false};
+  EnqueueResult tickets[3];
+  size_t eventCount = 0;
+  int hostessIdx = -1, exit1Idx = -1, exit2Idx = -1;
+
   // --- Hostess sensor triggered -> enqueue (assign a line by strategy) ---
   if (hostessRising)
   {
-    int recommended = qmRef.getNextLineNumber(g_strategy); // peek for logging
-    bool ok = qmRef.enqueue(g_strategy);                   // writes to Firebase inside
-    if (ok)
+    hostessIdx = eventCount;
+    events[eventCount++] = QueueEvent::arrival();
+  }
+
+  // --- Exit B drains line 1 ---
+  if (exit1Rising)
+  {
+    exit1Idx = eventCount;
+    events[eventCount++] = QueueEvent::serviceCompletion(EXIT1_LINE_NUMBER);
+  }
+
+  // --- Exit C drains line 2 ---
+  if (exit2Rising)
+  {
+    exit2Idx = eventCount;
+    events[eventCount++] = QueueEvent::serviceCompletion(EXIT2_LINE_NUMBER);
+  }
+
+  qmRef.applyBatch(events, eventCount, g_strategy, applied, tickets); // writes to Firebase once inside
+
+  if (hostessIdx >= 0)
+  {
+    if (applied[hostessIdx])
     {
+      const EnqueueResult &ticket = tickets[hostessIdx];
       g_entryEvents++;
-      g_lastEvent = String("[ENTRY] Hostess -> line ") + recommended;
+      g_lastEvent = String("[ENTRY] Hostess -> line ") + ticket.lineNumber + " #" + ticket.position +
+                    " (~" + (int)ticket.predictedWait + "s)";
     }
     else
     {
@@ -551,11 +591,9 @@ void processEdges3(QueueManager &qmRef,
     }
   }
 
-  // --- Exit B drains line 1 ---
-  if (exit1Rising)
+  if (exit1Idx >= 0)
   {
-    bool ok = qmRef.dequeue(EXIT1_LINE_NUMBER);
-    if (ok)
+    if (applied[exit1Idx])
     {
       g_exitEvents++;
       g_lastEvent = "[EXIT] Exit(B) -> line 1";
@@ -566,11 +604,9 @@ void processEdges3(QueueManager &qmRef,
     }
   }
 
-  // --- Exit C drains line 2 ---
-  if (exit2Rising)
+  if (exit2Idx >= 0)
   {
-    bool ok = qmRef.dequeue(EXIT2_LINE_NUMBER);
-    if (ok)
+    if (applied[exit2Idx])
     {
       g_exitEvents++;
       g_lastEvent = "[EXIT] Exit(C) -> line 2";
@@ -603,7 +639,7 @@ void snapshotPrevStates(Sensor &S)
 // onWifiReconnect()
 // Called once when WiFi transitions from offline -> online.
 // 1. re-syncs time so dashboard prints correct timestamps
-// 2. asks QueueManager to flush/clean offline backlog
+// 2. resumes cloud publishing and asks QueueManager to flush/clean offline backlog
 // 3. restores normal online strategy
 // 4. logs a dashboard event
 //
@@ -620,6 +656,7 @@ void onWifiReconnect()
   // 2. Let QueueManager clean / push backlog now that we're online again
   if (g_qm)
   {
+    g_qm->setCloudPublishingEnabled(true);
     g_qm->updateAllAndCleanHistory();
   }
   else
@@ -642,6 +679,7 @@ void onWifiReconnect()
 // Specifically:
 // - Switch strategy to NEAREST_TO_ENTRANCE so hostess routing
 //   continues deterministically even with no Firebase/clock.
+// - Pause per-event cloud writes until the connection is back.
 // - Record that for the dashboard.
 //
 void onWifiDisconnect()
@@ -651,6 +689,11 @@ void onWifiDisconnect()
   // Switch to offline failover strategy
   g_strategy = LineSelectionStrategy::NEAREST_TO_ENTRANCE;
 
+  // Stop attempting cloud writes on every event (they would fail and churn the heap);
+  // the last-hour history is uploaded on reconnect instead
+  if (g_qm)
+    g_qm->setCloudPublishingEnabled(false);
+
   // Let dashboard reflect this state change
   g_lastEvent = "[NET] WiFi lost -> NEAREST_TO_ENTRANCE";
 }
@@ -678,6 +721,10 @@ void setup()
   bool wifiOk = connectWiFi();
   g_wifiWasConnected = wifiOk; // remember startup state
 
+  // A snapshot from before the reboot means we resume, so keep the cloud data
+  bool fsOk = LittleFS.begin(true);
+  bool haveSnapshot = fsOk && LittleFS.exists(SNAPSHOT_FILE);
+
   if (wifiOk)
   {
     if (!syncNTP())
@@ -685,15 +732,22 @@ void setup()
       Serial.println("WARN: Time sync failed; using epoch=1970 fallback.");
     }
     g_strategy = LineSelectionStrategy::SHORTEST_WAIT_TIME;
-    g_qm = new QueueManager(0, NUM_LINES, "_ESP32", "iot-queue-management-ESP32");
+    g_qm = new QueueManager(0, NUM_LINES, "_ESP32", "iot-queue-management-ESP32", {}, !haveSnapshot);
   }
   else
   {
     // We start offline. Pick fallback strategy immediately.
     g_strategy = LineSelectionStrategy::NEAREST_TO_ENTRANCE;
-    g_qm = new QueueManager(0, NUM_LINES, "_ESP32", "iot-queue-management-ESP32");
+    g_qm = new QueueManager(0, NUM_LINES, "_ESP32", "iot-queue-management-ESP32", {}, !haveSnapshot);
+    g_qm->setCloudPublishingEnabled(false);
   }
 
+  if (haveSnapshot && !g_qm->loadSnapshotFromFile(SNAPSHOT_PATH))
+  {
+    Serial.println("WARN: Snapshot unreadable; starting with empty queues.");
+  }
+  g_lastSnapshotVersion = g_qm->getStateVersion();
+
   fakeClearScreen();
   Serial.println(F("Queue Manager ready."));
   Serial.println(F("Sensor A = Entry (TRIG=19,ECHO=18) -> enqueue by strategy"));
@@ -748,5 +802,15 @@ void loop()
     lastUiAt = now;
   }
 
+  // Periodic snapshot for warm restart (skipped while nothing changed, to spare the flash)
+  if (g_qm && now - g_lastSnapshotAt >= SNAPSHOT_INTERVAL_MS)
+  {
+    if (g_qm->getStateVersion() != g_lastSnapshotVersion && g_qm->saveSnapshotToFile(SNAPSHOT_PATH))
+    {
+      g_lastSnapshotVersion = g_qm->getStateVersion();
+    }
+    g_lastSnapshotAt = now;
+  }
+
   delay(30);
 }
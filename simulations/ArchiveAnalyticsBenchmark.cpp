@@ -0,0 +1,190 @@
+#include <iostream>
+#include <chrono>
+#include <cmath>
+#include <iomanip>
+#include <random>
+#include <vector>
+#include "../shared/cpp/CompletedPeopleArchive.h"
+#include "../shared/cpp/QueueManager.h"
+
+// ============================================================================
+// ARCHIVE ANALYTICS BENCHMARK
+// Fills a CompletedPeopleArchive with a synthetic day of traffic (millions of
+// served and abandoned customers over several lines and routing strategies),
+// then times whole-day, per-line, per-hour and per-strategy aggregates and a
+// wait histogram. Every SIMD result is checked against the scalar kernel.
+// Exits with status 1 on any mismatch. Runs without Firebase.
+// ============================================================================
+namespace BenchConfig
+{
+    const int NUMBER_OF_LINES = 6;
+    const int PEOPLE = 3000000;            // ~35 departures per second over the day
+    const long long DAY_SECONDS = 24 * 3600;
+    const double ABANDONMENT_RATIO = 0.04;
+    const int HISTOGRAM_BINS = 60;         // 30 second bins up to half an hour
+    const double HISTOGRAM_BIN_SECONDS = 30.0;
+    const int REPEATS = 20;                // Timings are averaged over this many runs
+}
+
+static double millisSince(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+}
+
+static bool sameStats(const CompletedPeopleArchive::Stats &a, const CompletedPeopleArchive::Stats &b)
+{
+    auto close = [](double x, double y)
+    {
+        return std::fabs(x - y) <= 1e-6 * std::max(1.0, std::fabs(x));
+    };
+    return a.count == b.count && a.totalActualWait == b.totalActualWait && a.minActualWait == b.minActualWait &&
+           a.maxActualWait == b.maxActualWait && close(a.totalExpectedWait, b.totalExpectedWait) &&
+           a.minExpectedWait == b.minExpectedWait && a.maxExpectedWait == b.maxExpectedWait;
+}
+
+static void fillDay(CompletedPeopleArchive &archive)
+{
+    std::mt19937 rng(42);
+    std::uniform_int_distribution<int> lineDist(1, BenchConfig::NUMBER_OF_LINES);
+    std::uniform_int_distribution<int> routingDist(0, 2); // Direct, shortest wait, fewest people
+    std::exponential_distribution<double> waitDist(1.0 / 240.0);
+    std::uniform_real_distribution<double> unit(0.0, 1.0);
+
+    archive.reserve(BenchConfig::PEOPLE);
+    for (int i = 0; i < BenchConfig::PEOPLE; ++i)
+    {
+        long long completed = static_cast<long long>(i) * BenchConfig::DAY_SECONDS / BenchConfig::PEOPLE;
+        long long wait = static_cast<long long>(waitDist(rng));
+        long long service = 20 + static_cast<long long>(unit(rng) * 60.0);
+        long long entering = std::max(0LL, completed - wait - service);
+
+        Person person(wait * (0.7 + 0.6 * unit(rng)), lineDist(rng), entering);
+        person.setPersonId(i + 1);
+        int routing = routingDist(rng);
+        person.setRoutingTag(routing == 0 ? Person::NOT_ROUTED
+                                          : QueueManager::routingTagOf(routing == 1 ? LineSelectionStrategy::SHORTEST_WAIT_TIME
+                                                                                    : LineSelectionStrategy::FEWEST_PEOPLE));
+        if (unit(rng) < BenchConfig::ABANDONMENT_RATIO)
+            person.recordAbandonmentAt(entering + wait / 2);
+        else
+            person.recordExitAt(entering + wait);
+        archive.append(person, completed);
+    }
+}
+
+int main()
+{
+    std::cout << "=== ARCHIVE ANALYTICS BENCHMARK ===" << std::endl;
+    std::cout << "SIMD kernels: " << (CompletedPeopleArchive::simdAvailable() ? "SSE2" : "not available (scalar)") << std::endl;
+
+    CompletedPeopleArchive archive;
+    auto start = std::chrono::steady_clock::now();
+    fillDay(archive);
+    std::cout << "Archived " << archive.size() << " people in " << std::fixed << std::setprecision(1)
+              << millisSince(start) << " ms" << std::endl;
+
+    bool consistent = true;
+    CompletedPeopleArchive::Query day;
+
+    // 1. Whole day, SIMD against scalar
+    CompletedPeopleArchive::Stats simd, scalar;
+    start = std::chrono::steady_clock::now();
+    for (int r = 0; r < BenchConfig::REPEATS; ++r)
+        simd = archive.aggregate(day);
+    double simdMs = millisSince(start) / BenchConfig::REPEATS;
+    start = std::chrono::steady_clock::now();
+    for (int r = 0; r < BenchConfig::REPEATS; ++r)
+        scalar = archive.aggregate(day, false);
+    double scalarMs = millisSince(start) / BenchConfig::REPEATS;
+    consistent = consistent && sameStats(simd, scalar);
+
+    std::cout << "\nWhole day (served): " << simd.count << " people, mean wait " << std::setprecision(1)
+              << simd.meanActualWait << "s (told " << simd.meanExpectedWait << "s), range "
+              << simd.minActualWait << "-" << simd.maxActualWait << "s" << std::endl;
+    std::cout << "  SIMD " << std::setprecision(2) << simdMs << " ms, scalar " << scalarMs << " ms" << std::endl;
+
+    // 2. Per line
+    std::vector<CompletedPeopleArchive::Stats> byLine;
+    start = std::chrono::steady_clock::now();
+    for (int r = 0; r < BenchConfig::REPEATS; ++r)
+        byLine = archive.aggregateByLine(day, BenchConfig::NUMBER_OF_LINES);
+    double lineMs = millisSince(start) / BenchConfig::REPEATS;
+    std::cout << "\nPer line (" << std::setprecision(2) << lineMs << " ms):" << std::endl;
+    for (int i = 0; i < BenchConfig::NUMBER_OF_LINES; ++i)
+    {
+        CompletedPeopleArchive::Query lineQuery;
+        lineQuery.lineNumber = i + 1;
+        consistent = consistent && sameStats(byLine[i], archive.aggregate(lineQuery, false));
+        std::cout << "  Line " << (i + 1) << ": " << std::setw(7) << byLine[i].count << " people, mean wait "
+                  << std::setprecision(1) << byLine[i].meanActualWait << "s" << std::endl;
+    }
+
+    // 3. Per hour
+    std::vector<CompletedPeopleArchive::Stats> byHour;
+    long long firstHour = 0;
+    start = std::chrono::steady_clock::now();
+    for (int r = 0; r < BenchConfig::REPEATS; ++r)
+        byHour = archive.aggregateByPeriod(day, 3600, &firstHour);
+    double hourMs = millisSince(start) / BenchConfig::REPEATS;
+    size_t hourTotal = 0;
+    for (const auto &hour : byHour)
+        hourTotal += hour.count;
+    consistent = consistent && hourTotal == simd.count;
+    std::cout << "\nPer hour: " << byHour.size() << " periods in " << std::setprecision(2) << hourMs << " ms" << std::endl;
+
+    // 4. Per strategy
+    const struct
+    {
+        const char *name;
+        int tag;
+    } strategies[] = {
+        {"direct", Person::NOT_ROUTED},
+        {"shortest wait", QueueManager::routingTagOf(LineSelectionStrategy::SHORTEST_WAIT_TIME)},
+        {"fewest people", QueueManager::routingTagOf(LineSelectionStrategy::FEWEST_PEOPLE)},
+    };
+    std::cout << "\nPer strategy:" << std::endl;
+    for (const auto &strategy : strategies)
+    {
+        CompletedPeopleArchive::Query strategyQuery;
+        strategyQuery.routingTag = strategy.tag;
+        CompletedPeopleArchive::Query abandonedQuery = strategyQuery;
+        abandonedQuery.outcome = CompletedPeopleArchive::Outcome::ABANDONED;
+
+        start = std::chrono::steady_clock::now();
+        CompletedPeopleArchive::Stats served = archive.aggregate(strategyQuery);
+        CompletedPeopleArchive::Stats abandoned = archive.aggregate(abandonedQuery);
+        double strategyMs = millisSince(start);
+        consistent = consistent && sameStats(served, archive.aggregate(strategyQuery, false)) &&
+                     sameStats(abandoned, archive.aggregate(abandonedQuery, false));
+
+        double abandonment = 100.0 * abandoned.count / std::max<size_t>(1, served.count + abandoned.count);
+        std::cout << "  " << std::setw(14) << strategy.name << ": mean wait " << std::setprecision(1)
+                  << served.meanActualWait << "s, abandoned " << abandonment << "% ("
+                  << std::setprecision(2) << strategyMs << " ms)" << std::endl;
+    }
+
+    // 5. Wait histogram for the busiest afternoon hour
+    CompletedPeopleArchive::Query afternoon;
+    afternoon.fromTimestamp = 15 * 3600;
+    afternoon.toTimestamp = 16 * 3600;
+    std::vector<uint32_t> bins(BenchConfig::HISTOGRAM_BINS), scalarBins(BenchConfig::HISTOGRAM_BINS);
+    size_t counted = 0;
+    start = std::chrono::steady_clock::now();
+    for (int r = 0; r < BenchConfig::REPEATS; ++r)
+        counted = archive.histogram(day, BenchConfig::HISTOGRAM_BIN_SECONDS, bins.data(), bins.size());
+    double histogramMs = millisSince(start) / BenchConfig::REPEATS;
+    archive.histogram(day, BenchConfig::HISTOGRAM_BIN_SECONDS, scalarBins.data(), scalarBins.size(), false);
+    consistent = consistent && counted == simd.count && bins == scalarBins;
+
+    size_t afternoonCount = archive.histogram(afternoon, BenchConfig::HISTOGRAM_BIN_SECONDS, bins.data(), bins.size());
+    std::cout << "\nWhole-day wait histogram: " << std::setprecision(2) << histogramMs << " ms" << std::endl;
+    std::cout << "15:00-16:00 waits (" << afternoonCount << " people):" << std::endl;
+    for (int i = 0; i < 10; ++i)
+    {
+        std::cout << "  " << std::setw(4) << static_cast<int>(i * BenchConfig::HISTOGRAM_BIN_SECONDS) << "s+ "
+                  << std::string(bins[i] * 60 / std::max<size_t>(1, afternoonCount / 4), '#') << " " << bins[i] << std::endl;
+    }
+
+    std::cout << "\nSIMD and scalar results match: " << (consistent ? "yes" : "NO") << std::endl;
+    return consistent ? 0 : 1;
+}
@@ -0,0 +1,133 @@
+#include <iostream>
+#include <atomic>
+#include <chrono>
+#include <iomanip>
+#include <random>
+#include <thread>
+#include <vector>
+#include "../shared/cpp/ConcurrentQueueManager.h"
+
+// ============================================================================
+// CONCURRENT INGESTION BENCHMARK
+// Several producer threads submit arrivals and service completions to one
+// ConcurrentQueueManager while reader threads poll snapshots. Reports
+// submit throughput and checks that the final snapshot accounts for every
+// event exactly once. Runs without Firebase.
+// ============================================================================
+namespace BenchConfig
+{
+    const int NUMBER_OF_LINES = 10;
+    const std::vector<int> PRODUCER_COUNTS = {1, 2, 4, 8};
+    const int READER_THREADS = 2;
+    const int EVENTS_PER_PRODUCER = 200000;
+    const size_t EVENT_CAPACITY = 1 << 14;
+}
+
+struct BenchmarkResult
+{
+    int producers;
+    double submitNsPerEvent;
+    double eventsPerSecond;
+    long long snapshotsRead;
+    uint64_t retries;
+    bool consistent;
+};
+
+static BenchmarkResult runBenchmark(int producers)
+{
+    ConcurrentQueueManager manager(0, BenchConfig::NUMBER_OF_LINES, "_concurrent", "", {}, BenchConfig::EVENT_CAPACITY);
+    manager.start();
+
+    std::atomic<bool> producing{true};
+    std::atomic<long long> snapshotsRead{0};
+    std::atomic<uint64_t> retries{0};
+    std::vector<std::thread> readers;
+    for (int r = 0; r < BenchConfig::READER_THREADS; ++r)
+    {
+        readers.emplace_back([&]()
+                             {
+            uint64_t lastVersion = 0;
+            while (producing.load())
+            {
+                auto snapshot = manager.getSnapshot();
+                if (snapshot->version < lastVersion)
+                {
+                    std::cout << "❌ Snapshot version went backwards" << std::endl;
+                }
+                lastVersion = snapshot->version;
+                snapshotsRead.fetch_add(1, std::memory_order_relaxed);
+            } });
+    }
+
+    // Each producer alternates arrival / service on its own line, so the final state is known
+    auto start = std::chrono::steady_clock::now();
+    std::vector<std::thread> producerThreads;
+    for (int p = 0; p < producers; ++p)
+    {
+        producerThreads.emplace_back([&, p]()
+                                     {
+            int line = 1 + p % BenchConfig::NUMBER_OF_LINES;
+            for (int i = 0; i < BenchConfig::EVENTS_PER_PRODUCER; ++i)
+            {
+                QueueEvent event = (i % 2 == 0) ? QueueEvent::arrival(line) : QueueEvent::serviceCompletion(line);
+                while (!manager.submit(event))
+                {
+                    retries.fetch_add(1, std::memory_order_relaxed);
+                    std::this_thread::yield();
+                }
+            } });
+    }
+    for (auto &thread : producerThreads)
+        thread.join();
+    auto submitted = std::chrono::steady_clock::now();
+
+    manager.flush();
+    auto applied = std::chrono::steady_clock::now();
+    producing.store(false);
+    for (auto &thread : readers)
+        thread.join();
+    manager.stop();
+
+    long long totalEvents = static_cast<long long>(producers) * BenchConfig::EVENTS_PER_PRODUCER;
+    auto snapshot = manager.getSnapshot();
+    bool consistent = snapshot->eventsApplied == static_cast<uint64_t>(totalEvents) &&
+                      snapshot->totalPeople == 0 &&
+                      snapshot->peopleSummary.totalPeople == totalEvents / 2 &&
+                      snapshot->peopleSummary.completedPeople == totalEvents / 2;
+
+    double submitNs = std::chrono::duration<double, std::nano>(submitted - start).count() / totalEvents;
+    double seconds = std::chrono::duration<double>(applied - start).count();
+    return BenchmarkResult{producers, submitNs, totalEvents / seconds, snapshotsRead.load(), retries.load(), consistent};
+}
+
+int main()
+{
+    std::cout << "=== CONCURRENT INGESTION BENCHMARK ===" << std::endl;
+
+    std::vector<BenchmarkResult> results;
+    for (int producers : BenchConfig::PRODUCER_COUNTS)
+    {
+        results.push_back(runBenchmark(producers));
+    }
+
+    std::cout << "\n"
+              << std::setw(10) << "producers"
+              << std::setw(18) << "submit ns/event"
+              << std::setw(16) << "applied ev/s"
+              << std::setw(16) << "snapshot reads"
+              << std::setw(14) << "full retries"
+              << std::setw(12) << "consistent" << std::endl;
+    bool allConsistent = true;
+    for (const auto &result : results)
+    {
+        std::cout << std::setw(10) << result.producers
+                  << std::setw(18) << std::fixed << std::setprecision(1) << result.submitNsPerEvent
+                  << std::setw(16) << std::setprecision(0) << result.eventsPerSecond
+                  << std::setw(16) << result.snapshotsRead
+                  << std::setw(14) << result.retries
+                  << std::setw(12) << (result.consistent ? "yes" : "NO") << std::endl;
+        allConsistent = allConsistent && result.consistent;
+    }
+
+    return allConsistent ? 0 : 1;
+}
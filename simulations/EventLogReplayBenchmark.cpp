@@ -0,0 +1,175 @@
+#include <iostream>
+#include <chrono>
+#include <cstdio>
+#include <iomanip>
+#include <memory>
+#include <random>
+#include <vector>
+#include "../shared/cpp/QueueManager.h"
+#include "../shared/cpp/EventLog.h"
+
+// ============================================================================
+// EVENT LOG REPLAY BENCHMARK
+// Drives a QueueManager with a random workload while it appends every
+// mutation to a memory-mapped event log, reopens the log from disk and
+// rebuilds a second manager by replay. Reports logging overhead and replay
+// speed, and checks that the rebuilt state matches the original. Also restores
+// a snapshot over a manager that has abandonments of its own and checks that
+// the restored lines are ranked as on a fresh manager.
+// Runs without Firebase.
+// ============================================================================
+namespace BenchConfig
+{
+    const char *LOG_PATH = "event_log_benchmark.qlog";
+    const int NUMBER_OF_LINES = 8;
+    const int MAX_QUEUE_SIZE = 200;
+    const int OPERATIONS = 1000000;
+    const std::vector<double> SERVICE_RATES = {0.08, 0.12, 0.18, 0.24, 0.30, 0.36, 0.42, 0.48};
+}
+
+static double secondsSince(std::chrono::steady_clock::time_point start)
+{
+    return std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+}
+
+static void runWorkload(QueueManager &queueManager, std::mt19937 &rng)
+{
+    std::uniform_int_distribution<int> lineDist(1, BenchConfig::NUMBER_OF_LINES);
+    std::uniform_int_distribution<int> opDist(0, 999);
+
+    for (int i = 0; i < BenchConfig::OPERATIONS; ++i)
+    {
+        int op = opDist(rng);
+        if (op < 480)
+            queueManager.enqueue(LineSelectionStrategy::SHORTEST_WAIT_TIME);
+        else if (op < 500)
+            queueManager.enqueueOnLine(lineDist(rng));
+        else if (op < 995)
+            queueManager.dequeue(lineDist(rng));
+        else if (op < 998)
+            queueManager.setLineAvailability(lineDist(rng), opDist(rng) < 800);
+        else
+            queueManager.setArrivalRate(opDist(rng) / 1000.0);
+    }
+}
+
+static bool sameState(const QueueManager &original, const QueueManager &rebuilt)
+{
+    if (original.size() != rebuilt.size() || original.getStateVersion() == 0)
+        return false;
+
+    auto a = original.getCumulativePeopleSummary();
+    auto b = rebuilt.getCumulativePeopleSummary();
+    if (a.totalPeople != b.totalPeople || a.completedPeople != b.completedPeople ||
+        a.historicalAvgExpectedWait != b.historicalAvgExpectedWait ||
+        a.historicalAvgActualWait != b.historicalAvgActualWait)
+        return false;
+
+    for (int line = 1; line <= BenchConfig::NUMBER_OF_LINES; ++line)
+    {
+        if (original.getEstimatedWaitTimeForNewPerson(line) != rebuilt.getEstimatedWaitTimeForNewPerson(line) ||
+            original.isLineAvailable(line) != rebuilt.isLineAvailable(line))
+            return false;
+
+        auto left = original.getLineView(line);
+        auto right = rebuilt.getLineView(line);
+        if (left.size() != right.size())
+            return false;
+        for (size_t i = 0; i < left.size(); ++i)
+        {
+            if (left[i].getPersonId() != right[i].getPersonId() ||
+                left[i].getEnteringTimestamp() != right[i].getEnteringTimestamp() ||
+                left[i].getExitingTimestamp() != right[i].getExitingTimestamp())
+                return false;
+        }
+    }
+
+    return original.getNextLineNumber() == rebuilt.getNextLineNumber() &&
+           original.getPeopleFromLastHour().size() == rebuilt.getPeopleFromLastHour().size();
+}
+
+// Restores a snapshot with abandonments onto the manager that took it (whose index still holds their
+// tombstones) and onto a fresh one: both must estimate and rank lines as the source did
+static bool snapshotRestoresOverAbandonments()
+{
+    QueueManager source(BenchConfig::MAX_QUEUE_SIZE, BenchConfig::NUMBER_OF_LINES, "_snapshot_source", "", BenchConfig::SERVICE_RATES);
+    std::vector<int> personIds;
+    for (int i = 0; i < 6; ++i)
+        personIds.push_back(source.enqueueOnLine(1).personId);
+    source.enqueueOnLine(2);
+    source.abandon(personIds[2]);
+    source.abandon(personIds[3]);
+
+    std::vector<double> estimates;
+    for (int line = 1; line <= BenchConfig::NUMBER_OF_LINES; ++line)
+        estimates.push_back(source.getEstimatedWaitTimeForNewPerson(line));
+    int nextLine = source.getNextLineNumber();
+
+    std::vector<uint8_t> blob = source.saveSnapshot();
+    QueueManager fresh(BenchConfig::MAX_QUEUE_SIZE, BenchConfig::NUMBER_OF_LINES, "_snapshot_fresh", "", BenchConfig::SERVICE_RATES);
+    if (!source.loadSnapshot(blob.data(), blob.size()) || !fresh.loadSnapshot(blob.data(), blob.size()))
+        return false;
+
+    for (int line = 1; line <= BenchConfig::NUMBER_OF_LINES; ++line)
+    {
+        if (source.getEstimatedWaitTimeForNewPerson(line) != estimates[line - 1] ||
+            fresh.getEstimatedWaitTimeForNewPerson(line) != estimates[line - 1])
+            return false;
+    }
+    return source.getNextLineNumber() == nextLine && fresh.getNextLineNumber() == nextLine;
+}
+
+int main()
+{
+    std::cout << "=== EVENT LOG REPLAY BENCHMARK ===" << std::endl;
+
+    std::mt19937 rng(11);
+
+    // 1. Workload without a log (baseline)
+    QueueManager baseline(BenchConfig::MAX_QUEUE_SIZE, BenchConfig::NUMBER_OF_LINES, "_baseline", "", BenchConfig::SERVICE_RATES);
+    auto start = std::chrono::steady_clock::now();
+    runWorkload(baseline, rng);
+    double baselineSeconds = secondsSince(start);
+
+    // 2. Same workload with every mutation appended to the mapped log
+    auto eventLog = std::make_shared<EventLog>();
+    if (!eventLog->open(BenchConfig::LOG_PATH, true))
+        return 1;
+
+    QueueManager original(BenchConfig::MAX_QUEUE_SIZE, BenchConfig::NUMBER_OF_LINES, "_logged", "", BenchConfig::SERVICE_RATES);
+    original.attachEventLog(eventLog);
+    rng.seed(11);
+    start = std::chrono::steady_clock::now();
+    runWorkload(original, rng);
+    double loggedSeconds = secondsSince(start);
+    size_t recordCount = eventLog->size();
+    eventLog->sync();
+
+    // 3. Reopen from disk, as after a restart, and rebuild
+    original.attachEventLog(nullptr);
+    eventLog->close();
+    EventLog reopened;
+    if (!reopened.open(BenchConfig::LOG_PATH))
+        return 1;
+
+    QueueManager rebuilt(BenchConfig::MAX_QUEUE_SIZE, BenchConfig::NUMBER_OF_LINES, "_replayed", "", BenchConfig::SERVICE_RATES);
+    start = std::chrono::steady_clock::now();
+    size_t applied = rebuilt.replay(reopened);
+    double replaySeconds = secondsSince(start);
+
+    bool matches = applied == recordCount && sameState(original, rebuilt);
+    bool snapshotMatches = snapshotRestoresOverAbandonments();
+
+    std::cout << std::fixed << std::setprecision(1)
+              << "\nOperations:             " << BenchConfig::OPERATIONS << std::endl
+              << "Records logged:         " << recordCount << " (" << recordCount * sizeof(EventLogRecord) / 1024 << " KB)" << std::endl
+              << "Workload without log:   " << baselineSeconds * 1e9 / BenchConfig::OPERATIONS << " ns/op" << std::endl
+              << "Workload with log:      " << loggedSeconds * 1e9 / BenchConfig::OPERATIONS << " ns/op" << std::endl
+              << "Replay:                 " << std::setprecision(2) << recordCount / replaySeconds / 1e6 << " M events/s" << std::endl
+              << "Rebuilt state matches:  " << (matches ? "yes" : "NO") << std::endl
+              << "Snapshot over abandons: " << (snapshotMatches ? "yes" : "NO") << std::endl;
+
+    reopened.close();
+    std::remove(BenchConfig::LOG_PATH);
+    return matches && snapshotMatches ? 0 : 1;
+}
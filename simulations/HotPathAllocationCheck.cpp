@@ -0,0 +1,127 @@
+#include <iostream>
+#include <atomic>
+#include <cstdlib>
+#include <new>
+#include <random>
+#include <vector>
+#include "../shared/cpp/QueueManager.h"
+
+// ============================================================================
+// HOT PATH ALLOCATION CHECK
+// Replaces the global operator new with a counting version and verifies that,
+// once line, history and archive storage are warm, enqueue/enqueueGroup/dequeue/applyBatch perform
+// zero heap allocations (cloud publishing disabled, as on the offline ESP32).
+// Exits with status 1 if any steady-state operation allocates.
+// ============================================================================
+namespace CheckConfig
+{
+    const int NUMBER_OF_LINES = 3;
+    const int PEOPLE_PER_LINE = 256; // Headroom reserved up front
+    const int WARMUP_OPERATIONS = 20000;
+    const int MEASURED_OPERATIONS = 200000;
+    const size_t ARCHIVED_PEOPLE = 2 * (WARMUP_OPERATIONS + MEASURED_OPERATIONS); // At most two departures per operation
+}
+
+static std::atomic<long long> g_allocationCount{0};
+static std::atomic<bool> g_counting{false};
+
+void *operator new(std::size_t size)
+{
+    if (g_counting.load(std::memory_order_relaxed))
+        g_allocationCount.fetch_add(1, std::memory_order_relaxed);
+    if (void *memory = std::malloc(size ? size : 1))
+        return memory;
+    throw std::bad_alloc();
+}
+
+void *operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+void *operator new(std::size_t size, const std::nothrow_t &) noexcept
+{
+    if (g_counting.load(std::memory_order_relaxed))
+        g_allocationCount.fetch_add(1, std::memory_order_relaxed);
+    return std::malloc(size ? size : 1);
+}
+
+void *operator new[](std::size_t size, const std::nothrow_t &tag) noexcept
+{
+    return operator new(size, tag);
+}
+
+void operator delete(void *memory) noexcept { std::free(memory); }
+void operator delete[](void *memory) noexcept { std::free(memory); }
+void operator delete(void *memory, std::size_t) noexcept { std::free(memory); }
+void operator delete[](void *memory, std::size_t) noexcept { std::free(memory); }
+
+// Mixed arrival/service workload that keeps every line well below the reserved size
+static void runWorkload(QueueManager &queueManager, std::mt19937 &rng, int operations)
+{
+    std::uniform_int_distribution<int> lineDist(1, CheckConfig::NUMBER_OF_LINES);
+    std::uniform_int_distribution<int> opDist(0, 6);
+    QueueEvent burst[4];
+
+    for (int i = 0; i < operations; ++i)
+    {
+        int line = lineDist(rng);
+        bool tooLong = queueManager.getLineCount(line) >= CheckConfig::PEOPLE_PER_LINE / 2;
+        switch (tooLong ? 6 : opDist(rng))
+        {
+        case 0:
+            queueManager.enqueue(LineSelectionStrategy::SHORTEST_WAIT_TIME);
+            break;
+        case 1:
+            queueManager.enqueue(LineSelectionStrategy::FEWEST_PEOPLE);
+            break;
+        case 2:
+            queueManager.enqueueOnLine(line);
+            break;
+        case 3:
+            burst[0] = QueueEvent::arrival();
+            burst[1] = QueueEvent::arrival(line);
+            burst[2] = QueueEvent::serviceCompletion(lineDist(rng));
+            burst[3] = QueueEvent::availabilityChange(line, true);
+            queueManager.applyBatch(burst, 4, LineSelectionStrategy::SHORTEST_WAIT_TIME);
+            break;
+        case 4:
+            queueManager.enqueueGroup(2, 1.5, LineSelectionStrategy::SHORTEST_WAIT_TIME);
+            break;
+        default:
+            queueManager.dequeue(line, LineSelectionStrategy::SHORTEST_WAIT_TIME);
+            queueManager.dequeue(lineDist(rng), LineSelectionStrategy::FEWEST_PEOPLE);
+            break;
+        }
+    }
+}
+
+int main()
+{
+    std::cout << "=== HOT PATH ALLOCATION CHECK ===" << std::endl;
+
+    QueueManager queueManager(0, CheckConfig::NUMBER_OF_LINES, "_alloc_check", "");
+    queueManager.setCloudPublishingEnabled(false);
+    queueManager.reserveCapacity(CheckConfig::PEOPLE_PER_LINE, CheckConfig::ARCHIVED_PEOPLE);
+
+    std::mt19937 rng(7);
+    runWorkload(queueManager, rng, CheckConfig::WARMUP_OPERATIONS);
+
+    g_allocationCount.store(0);
+    g_counting.store(true);
+    runWorkload(queueManager, rng, CheckConfig::MEASURED_OPERATIONS);
+    g_counting.store(false);
+
+    long long allocations = g_allocationCount.load();
+    std::cout << "Steady-state operations: " << CheckConfig::MEASURED_OPERATIONS
+              << ", heap allocations: " << allocations << std::endl;
+
+    if (allocations != 0)
+    {
+        std::cout << "❌ Hot path allocated memory" << std::endl;
+        return 1;
+    }
+
+    std::cout << "✅ Hot path is allocation-free" << std::endl;
+    return 0;
+}
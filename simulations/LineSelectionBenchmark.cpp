@@ -0,0 +1,129 @@
+#include <iostream>
+#include <chrono>
+#include <random>
+#include <iomanip>
+#include <limits>
+#include <vector>
+#include "../shared/cpp/QueueManager.h"
+
+// ============================================================================
+// LINE SELECTION BENCHMARK
+// Measures the cost of picking a line (getNextLineNumber) and of the state
+// updates that keep the per-strategy line ranking current, for growing venues.
+// Runs without Firebase so only the in-memory queue logic is measured.
+// ============================================================================
+namespace BenchConfig
+{
+    const std::vector<int> LINE_COUNTS = {10, 100, 1000};
+    const int PEOPLE_PER_LINE = 20;   // Initial occupancy before measuring
+    const int OPERATIONS = 200000;    // Enqueue/dequeue pairs per measurement
+    const int SELECTIONS = 1000000;   // getNextLineNumber calls per measurement
+}
+
+static double nanosecondsPerOp(std::chrono::steady_clock::time_point start, int operations)
+{
+    auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - start);
+    return static_cast<double>(elapsed.count()) / operations;
+}
+
+// Reference cost of the previous implementation: score every line on every call
+static int linearScanSelection(const QueueManager &queueManager, int numberOfLines)
+{
+    double minWaitTime = std::numeric_limits<double>::max();
+    int bestLine = -1;
+    for (int line = 1; line <= numberOfLines; ++line)
+    {
+        if (!queueManager.isLineAvailable(line))
+            continue;
+        double waitTime = queueManager.getEstimatedWaitTimeForNewPerson(line);
+        if (waitTime < minWaitTime)
+        {
+            minWaitTime = waitTime;
+            bestLine = line;
+        }
+    }
+    return bestLine;
+}
+
+struct BenchmarkResult
+{
+    int numberOfLines;
+    double selectNs;
+    double scanNs;
+    double updateNs;
+    bool agrees;
+};
+
+static BenchmarkResult runBenchmark(int numberOfLines)
+{
+    std::vector<double> serviceRates(numberOfLines);
+    std::mt19937 rng(42);
+    std::uniform_real_distribution<double> rateDist(0.05, 0.4);
+    for (double &rate : serviceRates)
+        rate = rateDist(rng);
+
+    QueueManager queueManager(0, numberOfLines, "_benchmark", "", serviceRates);
+    for (int line = 1; line <= numberOfLines; ++line)
+    {
+        for (int i = 0; i < BenchConfig::PEOPLE_PER_LINE; ++i)
+            queueManager.enqueueOnLine(line);
+    }
+
+    std::uniform_int_distribution<int> lineDist(1, numberOfLines);
+    volatile int sink = 0;
+
+    // 1. Pure selection cost (heap top)
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < BenchConfig::SELECTIONS; ++i)
+        sink = sink + queueManager.getNextLineNumber(LineSelectionStrategy::SHORTEST_WAIT_TIME);
+    double selectNs = nanosecondsPerOp(start, BenchConfig::SELECTIONS);
+
+    // 2. Full linear scan for comparison
+    int scanIterations = std::max(1000, BenchConfig::SELECTIONS / numberOfLines);
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < scanIterations; ++i)
+        sink = sink + linearScanSelection(queueManager, numberOfLines);
+    double scanNs = nanosecondsPerOp(start, scanIterations);
+
+    // 3. Arrival + service with incremental ranking updates
+    start = std::chrono::steady_clock::now();
+    for (int i = 0; i < BenchConfig::OPERATIONS; ++i)
+    {
+        queueManager.enqueue(LineSelectionStrategy::SHORTEST_WAIT_TIME);
+        queueManager.dequeue(lineDist(rng), LineSelectionStrategy::SHORTEST_WAIT_TIME);
+    }
+    double updateNs = nanosecondsPerOp(start, BenchConfig::OPERATIONS * 2);
+
+    bool agrees = queueManager.getNextLineNumber(LineSelectionStrategy::SHORTEST_WAIT_TIME) ==
+                  linearScanSelection(queueManager, numberOfLines);
+
+    return BenchmarkResult{numberOfLines, selectNs, scanNs, updateNs, agrees};
+}
+
+int main()
+{
+    std::cout << "=== LINE SELECTION BENCHMARK ===" << std::endl;
+
+    std::vector<BenchmarkResult> results;
+    for (int numberOfLines : BenchConfig::LINE_COUNTS)
+    {
+        results.push_back(runBenchmark(numberOfLines));
+    }
+
+    std::cout << "\n"
+              << std::setw(8) << "lines"
+              << std::setw(16) << "select ns/op"
+              << std::setw(18) << "linear scan ns"
+              << std::setw(20) << "enq/deq ns/op"
+              << std::setw(12) << "same pick" << std::endl;
+    for (const auto &result : results)
+    {
+        std::cout << std::setw(8) << result.numberOfLines
+                  << std::setw(16) << std::fixed << std::setprecision(1) << result.selectNs
+                  << std::setw(18) << result.scanNs
+                  << std::setw(20) << result.updateNs
+                  << std::setw(12) << (result.agrees ? "yes" : "NO") << std::endl;
+    }
+
+    return 0;
+}
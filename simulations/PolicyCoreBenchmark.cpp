@@ -0,0 +1,144 @@
+#include <iostream>
+#include <atomic>
+#include <chrono>
+#include <cstdlib>
+#include <iomanip>
+#include <new>
+#include <random>
+#include "../shared/cpp/BasicQueueManager.h"
+#include "../shared/cpp/QueueManager.h"
+
+// ============================================================================
+// POLICY CORE BENCHMARK
+// Compares the compile-time BasicQueueManager (fixed line count, inlined policy,
+// inline fixed storage) with the runtime-configured QueueManager on the ESP32
+// layout (2 lines): per-event cost, RAM (object size plus heap bytes), and
+// that both pick the same line for the same event stream. Runs without Firebase.
+// Exits with status 1 if the selections disagree.
+// ============================================================================
+namespace BenchConfig
+{
+    const int NUMBER_OF_LINES = 2;  // Same as NUM_LINES in cpp.ino
+    const int LINE_CAPACITY = 32;   // Fixed storage per line
+    const int EVENTS = 2000000;     // Arrivals/services per measurement
+    const int AGREEMENT_EVENTS = 200000;
+}
+
+using FirmwareCore = BasicQueueManager<BenchConfig::NUMBER_OF_LINES, AutoPolicy, FixedLineStorage<BenchConfig::LINE_CAPACITY>>;
+using FewestCore = BasicQueueManager<BenchConfig::NUMBER_OF_LINES, FewestPeoplePolicy, FixedLineStorage<BenchConfig::LINE_CAPACITY>>;
+
+static std::atomic<long long> g_heapBytes{0};
+
+void *operator new(std::size_t size)
+{
+    g_heapBytes.fetch_add(static_cast<long long>(size), std::memory_order_relaxed);
+    if (void *memory = std::malloc(size ? size : 1))
+        return memory;
+    throw std::bad_alloc();
+}
+
+void *operator new[](std::size_t size)
+{
+    return operator new(size);
+}
+
+void operator delete(void *memory) noexcept { std::free(memory); }
+void operator delete[](void *memory) noexcept { std::free(memory); }
+void operator delete(void *memory, std::size_t) noexcept { std::free(memory); }
+void operator delete[](void *memory, std::size_t) noexcept { std::free(memory); }
+
+// Event stream: arrival when the coin says so and there is room, otherwise a service on a random line
+template <typename Enqueue, typename Dequeue, typename Count>
+static double runEvents(int events, Enqueue enqueue, Dequeue dequeue, Count count)
+{
+    std::mt19937 rng(11);
+    std::uniform_int_distribution<int> coin(0, 1);
+    std::uniform_int_distribution<int> lineDist(1, BenchConfig::NUMBER_OF_LINES);
+
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < events; ++i)
+    {
+        if (coin(rng) == 0 && count() < BenchConfig::NUMBER_OF_LINES * BenchConfig::LINE_CAPACITY / 2)
+            enqueue();
+        else
+            dequeue(lineDist(rng));
+    }
+    return std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / events;
+}
+
+int main()
+{
+    std::cout << "=== POLICY CORE BENCHMARK ===" << std::endl;
+
+    // QueueManager logs enqueueAuto strategy switches and availability changes; keep the report readable
+    std::cout.setstate(std::ios::failbit);
+
+    // 1. RAM: object size plus heap used by construction and a warm-up
+    long long heapBefore = g_heapBytes.load();
+    QueueManager runtime(BenchConfig::LINE_CAPACITY, BenchConfig::NUMBER_OF_LINES, "_policy_core", "");
+    runtime.setCloudPublishingEnabled(false);
+    runEvents(20000, [&] { runtime.enqueueAuto(); }, [&](int line) { runtime.dequeue(line); },
+              [&] { return runtime.size(); });
+    long long runtimeHeap = g_heapBytes.load() - heapBefore;
+
+    heapBefore = g_heapBytes.load();
+    FirmwareCore core;
+    runEvents(20000, [&] { core.enqueue(); }, [&](int line) { core.dequeue(line); },
+              [&] { return core.size(); });
+    long long coreHeap = g_heapBytes.load() - heapBefore;
+
+    std::cout.clear();
+    std::cout << "\nMemory (object + heap allocated while warming up):" << std::endl;
+    std::cout << "  QueueManager:      " << std::setw(8) << sizeof(QueueManager) << " + " << runtimeHeap << " bytes" << std::endl;
+    std::cout << "  BasicQueueManager: " << std::setw(8) << sizeof(FirmwareCore) << " + " << coreHeap << " bytes" << std::endl;
+
+    // 2. Per-event cost (enqueueAuto through the adaptive strategy, and plain enqueue)
+    std::cout.setstate(std::ios::failbit);
+    double autoRuntimeNs = runEvents(BenchConfig::EVENTS, [&] { runtime.enqueueAuto(); },
+                                     [&](int line) { runtime.dequeue(line); }, [&] { return runtime.size(); });
+    std::cout.clear();
+    double runtimeNs = runEvents(BenchConfig::EVENTS, [&] { runtime.enqueue(LineSelectionStrategy::SHORTEST_WAIT_TIME); },
+                                 [&](int line) { runtime.dequeue(line); }, [&] { return runtime.size(); });
+    double coreNs = runEvents(BenchConfig::EVENTS, [&] { core.enqueue(); }, [&](int line) { core.dequeue(line); },
+                              [&] { return core.size(); });
+
+    std::cout << "\nPer event:" << std::endl;
+    std::cout << "  QueueManager enqueueAuto/dequeue:    " << std::fixed << std::setprecision(1) << autoRuntimeNs << " ns" << std::endl;
+    std::cout << "  QueueManager enqueue/dequeue:        " << runtimeNs << " ns" << std::endl;
+    std::cout << "  BasicQueueManager<2, AutoPolicy>:    " << coreNs << " ns" << std::endl;
+
+    // 3. Same event stream, same selections (fewest people does not depend on timing)
+    std::cout.setstate(std::ios::failbit);
+    QueueManager reference(BenchConfig::LINE_CAPACITY, BenchConfig::NUMBER_OF_LINES, "_policy_ref", "");
+    reference.setCloudPublishingEnabled(false);
+    FewestCore fewest(BenchConfig::LINE_CAPACITY);
+    std::mt19937 rng(5);
+    std::uniform_int_distribution<int> opDist(0, 2);
+    std::uniform_int_distribution<int> lineDist(1, BenchConfig::NUMBER_OF_LINES);
+    int disagreements = 0;
+    for (int i = 0; i < BenchConfig::AGREEMENT_EVENTS; ++i)
+    {
+        int op = opDist(rng);
+        int line = lineDist(rng);
+        if (op == 0)
+        {
+            EnqueueResult expected = reference.enqueue(LineSelectionStrategy::FEWEST_PEOPLE);
+            EnqueueResult actual = fewest.enqueue();
+            if (expected.admitted != actual.admitted || expected.lineNumber != actual.lineNumber)
+                disagreements++;
+        }
+        else if (op == 1)
+        {
+            reference.setLineAvailability(line, i % 7 != 0);
+            fewest.setLineAvailability(line, i % 7 != 0);
+        }
+        else if (reference.dequeue(line) != fewest.dequeue(line))
+        {
+            disagreements++;
+        }
+    }
+    std::cout.clear();
+    std::cout << "\nSelections compared: " << BenchConfig::AGREEMENT_EVENTS << ", disagreements: " << disagreements << std::endl;
+
+    return disagreements == 0 ? 0 : 1;
+}
@@ -97,20 +97,18 @@ private:
             // Simulate arrivals
             if (arrivalDist(rng) < arrivalRate)
             {
-                // Use automatic strategy selection (FEWEST_PEOPLE until 30 completions, then SHORTEST_WAIT_TIME)
-                if (queueManager->enqueueAuto())
+                // Use automatic strategy selection (FEWEST_PEOPLE until every line is reliable, then SHORTEST_WAIT_TIME)
+                EnqueueResult ticket = queueManager->enqueueAuto();
+                if (ticket)
                 {
                     // Determine which strategy was used for display purposes
-                    LineSelectionStrategy usedStrategy = (queueManager->getCumulativePeopleSummary().completedPeople >= 30)
-                                                             ? LineSelectionStrategy::SHORTEST_WAIT_TIME
-                                                             : LineSelectionStrategy::FEWEST_PEOPLE;
-                    int selectedLine = queueManager->getNextLineNumber(usedStrategy);
+                    LineSelectionStrategy usedStrategy = queueManager->getEffectiveStrategy(LineSelectionStrategy::ADAPTIVE);
                     std::string strategyName = (usedStrategy == LineSelectionStrategy::SHORTEST_WAIT_TIME)
                                                    ? "SHORTEST WAIT TIME"
                                                    : "FEWEST PEOPLE";
-                    std::cout << "New arrival! Selected line " << selectedLine << " (" << strategyName << " strategy)"
+                    std::cout << "New arrival! Selected line " << ticket.lineNumber << " (" << strategyName << " strategy)"
                               << " (wait time: " << std::fixed << std::setprecision(1)
-                              << queueManager->getEstimatedWaitTime(selectedLine) << "s)"
+                              << ticket.predictedWait << "s)"
                               << " Total queue size: " << queueManager->size() << std::endl;
                 }
                 else
@@ -98,11 +98,11 @@ private:
             if (arrivalDist(rng) < arrivalRate)
             {
                 // Use FEWEST_PEOPLE strategy
-                if (queueManager->enqueue(LineSelectionStrategy::FEWEST_PEOPLE))
+                EnqueueResult ticket = queueManager->enqueue(LineSelectionStrategy::FEWEST_PEOPLE);
+                if (ticket)
                 {
-                    int selectedLine = queueManager->getNextLineNumber(LineSelectionStrategy::FEWEST_PEOPLE);
-                    std::cout << "New arrival! Selected line " << selectedLine << " (FEWEST PEOPLE strategy)"
-                              << " (people in line: " << queueManager->getLineCount(selectedLine) << ")"
+                    std::cout << "New arrival! Selected line " << ticket.lineNumber << " (FEWEST PEOPLE strategy)"
+                              << " (people in line: " << ticket.position << ")"
                               << " Total queue size: " << queueManager->size() << std::endl;
                 }
                 else
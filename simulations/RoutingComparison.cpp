@@ -0,0 +1,718 @@
+#include <iostream>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <deque>
+#include <functional>
+#include <iomanip>
+#include <memory>
+#include <queue>
+#include <random>
+#include <vector>
+#include "../shared/cpp/QueueManager.h"
+#include "../shared/cpp/SimulationClock.h"
+
+// ============================================================================
+// ROUTING COMPARISON
+// Offline discrete-event simulation of a venue with many lines (one server per
+// line, exponential service at different rates, Poisson arrivals at 90% load)
+// comparing SHORTEST_WAIT_TIME with power-of-d choices (d = 2 and 3).
+// Arrivals are routed either on live state or on a view that is only refreshed
+// every few seconds, like a published recommendation, which makes full-information
+// routing herd onto one line. Reports the cost of one routing decision and the
+// mean, p95 and p99 wait. A second run gives customers very different basket
+// sizes (announced as a service demand hint on arrival) and compares
+// SHORTEST_WAIT_TIME with SHORTEST_WORKLOAD. A third run has people arrive in groups
+// and walk to the line they were recommended, so the sensors only see them later,
+// and compares LOOKAHEAD with the strategies that only see people already in line.
+// A fourth run staffs some lines with several registers (one line only for part of
+// the day) and compares routing and wait estimates with the staffing reported to the
+// manager (M/M/c) or not. A fifth run sends half the customers with small baskets as
+// EXPRESS and compares a venue without express lanes with one whose first lines only
+// serve EXPRESS customers (QueueManager::setLineClasses), routing each class on its own
+// eligible lines. A sixth run places the lines in a venue (VenueLayout) where each line
+// has its own walking time from the hostess station, and compares routing on the time
+// from asking at the station to reaching a register (walk plus wait). A seventh run
+// routes customers with unannounced baskets and turns on rebalancing advice
+// (QueueManager::setRebalanceThreshold): whoever is told to move walks over to the
+// faster line (QueueManager::moveWaitingPerson).
+// An eighth run closes registers for half an hour while people wait behind them
+// (setLineAvailability) and compares leaving those people to wait with failover
+// (setFailoverEnabled), which moves them to the other lines.
+// Runs on a simulated clock, without Firebase.
+// ============================================================================
+namespace SimConfig
+{
+    const std::vector<int> LINE_COUNTS = {16, 64};
+    const std::vector<int> STALENESS_SECONDS = {0, 10, 30}; // 0 = route on live state
+    const double LOAD = 0.9;                                 // Arrival rate / total service rate
+    const double SIMULATED_SECONDS = 8 * 3600.0;             // One working day
+    const int DECISION_TIMING_CALLS = 1000000;
+    const int BASKET_LINES = 16;
+    // Basket mix (mean 1.0 average customer): mostly quick visits, a few very large carts
+    const double BASKET_SIZES[] = {0.5, 1.4, 6.0};
+    const double BASKET_SHARES[] = {0.70, 0.25, 0.05};
+    const double HINT_ERROR = 0.25; // Log-normal sigma of the hostess's basket estimate
+    const int WALK_LINES = 16;
+    const double MEAN_GROUP_SIZE = 4.0;                      // People arriving together (bus, train, event)
+    const double MIN_WALK_SECONDS = 15.0;                    // From the recommendation screen to the line
+    const double MAX_WALK_SECONDS = 45.0;
+    const int STAFFED_LINES = 8;
+    const int ALL_DAY_REGISTERS = 3;                         // Lines 1 and 2
+    const double EXTRA_REGISTER_FROM = 2 * 3600.0;           // Line 3 has a second register from hour 2 to hour 6
+    const double EXTRA_REGISTER_UNTIL = 6 * 3600.0;
+    const int EXPRESS_VENUE_LINES = 8;
+    const int EXPRESS_LANES = 1;                             // Line 1 only serves EXPRESS customers
+    const double EXPRESS_SHARE = 0.5;                        // Customers with an express-sized basket
+    const double EXPRESS_BASKET = 0.4;                       // Mean basket of the whole mix stays 1.0
+    const double STANDARD_BASKET = 1.6;
+    const int VENUE_LINES = 16;                              // Two rows of 8 lines behind the hostess station
+    const double VENUE_LINE_SPACING = 4.0;                   // Metres between neighbouring lines in a row
+    const double VENUE_FIRST_ROW = 8.0;                      // Metres from the station to the first row
+    const double VENUE_ROW_SPACING = 14.0;
+    const double VENUE_WALKING_SPEED = 0.8;                  // Metres per second
+    const std::vector<double> VENUE_LOADS = {0.6, 0.9};      // Quiet hours and peak
+    const int REBALANCE_LINES = 16;
+    const std::vector<double> REBALANCE_THRESHOLDS = {0.0, 30.0, 15.0, 10.0, 5.0}; // Minimum saving per move, 0 = off
+    const int OUTAGE_LINES = 8;
+    const double OUTAGE_SECONDS = 1800.0;                     // Each closure lasts half an hour
+    const std::vector<std::pair<double, int>> OUTAGES = {{2 * 3600.0, 3}, {5 * 3600.0, 6}}; // (earliest start, line)
+    const uint32_t SEED = 2024;
+}
+
+static long long g_simulatedMillis = 0;
+
+static long long simulatedNow()
+{
+    return g_simulatedMillis;
+}
+
+// Service rate of each line: a mix of slow and fast counters (0.05 to 0.14 people/second)
+static std::vector<double> serviceRates(int numberOfLines)
+{
+    std::vector<double> rates(numberOfLines);
+    for (int i = 0; i < numberOfLines; ++i)
+        rates[i] = 0.05 + 0.01 * ((i * 7) % 10);
+    return rates;
+}
+
+struct RoutingResult
+{
+    double selectNs = 0.0;
+    double meanWait = 0.0;
+    double p95Wait = 0.0;
+    double p99Wait = 0.0;
+    double meanEstimateError = 0.0; // |estimated - actual| wait, seconds
+    double meanExpressWait = 0.0;   // EXPRESS customers only (express-lane runs)
+    double meanStandardWait = 0.0;  // STANDARD customers only (express-lane runs)
+    double meanTrip = 0.0;          // Walk from the hostess station plus wait (venue layout runs)
+    double p99Trip = 0.0;
+    double maxWait = 0.0;
+    size_t served = 0;
+    size_t moved = 0; // People who changed line on rebalancing advice
+};
+
+struct Candidate
+{
+    const char *name;
+    std::function<bool(QueueManager &, LineSelectionStrategy &)> attach; // Picks or adds the strategy on a fresh manager
+};
+
+enum class Scenario
+{
+    AVERAGE_CUSTOMERS, // Exponential service, Poisson arrivals that join at once
+    VARIABLE_BASKETS,  // Service time = basket size / rate with mild noise, arrivals announce a basket estimate
+    WALK_TO_LINE,      // Groups arrive together, are recommended a line and reach it after a walk
+    STAFFED_REGISTERS, // Some lines have several registers, and the manager is told (setServerCount)
+    STAFFED_UNREPORTED, // Same registers, but the manager assumes one per line
+    MIXED_CLASSES,      // Small and large baskets tagged EXPRESS/STANDARD, every line serves everyone
+    EXPRESS_LANES,      // Same customers, the first EXPRESS_LANES lines only serve EXPRESS
+    VENUE_LAYOUT,       // Each person walks from the hostess station to their line (VenueLayout walking times)
+    REBALANCING,        // Variable baskets nobody announces; people move lines when advised to
+    OUTAGE,             // Registers close for a while; everyone in their line waits for them to reopen
+    OUTAGE_FAILOVER     // Same closures, and the manager moves the people waiting to the other lines
+};
+
+struct StaffingChange
+{
+    double time;
+    int line;
+    int servers;
+};
+
+struct AvailabilityChange
+{
+    double time;
+    int line;
+    bool available;
+};
+
+struct WaitingPerson
+{
+    double arrival;
+    double work;     // Service time at a register serving one average customer per second
+    double estimate; // Wait the manager announced on arrival
+    CustomerClass customerClass;
+    double asked; // Left the hostess station (equals arrival unless the person walked there)
+    int personId; // Ticket assigned on joining (kept when the manager moves the person)
+};
+
+// Lines in two rows behind the hostess station, line 1 at the front left
+static VenueLayout venueLayout(int numberOfLines)
+{
+    VenueLayout layout(SimConfig::VENUE_WALKING_SPEED);
+    int perRow = (numberOfLines + 1) / 2;
+    for (int i = 0; i < numberOfLines; ++i)
+    {
+        double x = SimConfig::VENUE_LINE_SPACING * ((i % perRow) - (perRow - 1) / 2.0);
+        layout.addLine(x, SimConfig::VENUE_FIRST_ROW + SimConfig::VENUE_ROW_SPACING * (i / perRow));
+    }
+    return layout;
+}
+
+static double percentile(std::vector<double> &values, double fraction)
+{
+    if (values.empty())
+        return 0.0;
+    size_t index = std::min(values.size() - 1, static_cast<size_t>(fraction * values.size()));
+    std::nth_element(values.begin(), values.begin() + index, values.end());
+    return values[index];
+}
+
+static RoutingResult simulate(int numberOfLines, int stalenessSeconds, const Candidate &candidate, Scenario scenario,
+                              double load = SimConfig::LOAD, double rebalanceThreshold = 0.0)
+{
+    bool rebalancing = scenario == Scenario::REBALANCING;
+    bool outages = scenario == Scenario::OUTAGE || scenario == Scenario::OUTAGE_FAILOVER;
+    bool variableBaskets = scenario == Scenario::VARIABLE_BASKETS || rebalancing;
+    bool walkToLine = scenario == Scenario::WALK_TO_LINE;
+    bool staffed = scenario == Scenario::STAFFED_REGISTERS || scenario == Scenario::STAFFED_UNREPORTED;
+    bool classed = scenario == Scenario::MIXED_CLASSES || scenario == Scenario::EXPRESS_LANES;
+    bool venue = scenario == Scenario::VENUE_LAYOUT;
+    VenueLayout layout = venueLayout(numberOfLines);
+    // Fresh simulated day: timestamps and tracker sessions start at the same instant for every run
+    g_simulatedMillis = 1000000;
+    Person::setSimulationStartTime();
+
+    // Registers per line over the day; load is relative to the day's average capacity
+    std::vector<double> rates = serviceRates(numberOfLines);
+    std::vector<int> servers(numberOfLines, 1);
+    std::vector<StaffingChange> staffing;
+    if (staffed)
+    {
+        staffing = {{0.0, 1, SimConfig::ALL_DAY_REGISTERS},
+                    {0.0, 2, SimConfig::ALL_DAY_REGISTERS},
+                    {SimConfig::EXTRA_REGISTER_FROM, 3, 2},
+                    {SimConfig::EXTRA_REGISTER_UNTIL, 3, 1}};
+    }
+    double totalRate = 0.0;
+    for (int i = 0; i < numberOfLines; ++i)
+        totalRate += rates[i];
+    for (const StaffingChange &change : staffing)
+    {
+        double until = SimConfig::SIMULATED_SECONDS;
+        for (const StaffingChange &next : staffing)
+            if (next.line == change.line && next.time > change.time)
+                until = std::min(until, next.time);
+        totalRate += rates[change.line - 1] * (change.servers - 1) * (until - change.time) / SimConfig::SIMULATED_SECONDS;
+    }
+    double arrivalRate = load * totalRate;
+
+    QueueManager queueManager(0, numberOfLines, "_routing", "", rates);
+    queueManager.setCloudPublishingEnabled(false);
+    queueManager.setArrivalRate(arrivalRate);
+    size_t nextStaffingChange = 0;
+    LineSelectionStrategy strategy;
+    if (!candidate.attach(queueManager, strategy))
+        return RoutingResult();
+    if (scenario == Scenario::EXPRESS_LANES)
+        for (int line = 1; line <= SimConfig::EXPRESS_LANES; ++line)
+            queueManager.setLineClasses(line, customerClassBit(CustomerClass::EXPRESS));
+    if (venue)
+        queueManager.setVenueLayout(layout);
+    if (rebalancing)
+        queueManager.setRebalanceThreshold(rebalanceThreshold);
+    queueManager.setFailoverEnabled(scenario == Scenario::OUTAGE_FAILOVER);
+    std::vector<AvailabilityChange> closures;
+    if (outages)
+    {
+        for (const auto &outage : SimConfig::OUTAGES)
+            closures.push_back(AvailabilityChange{outage.first, outage.second, false});
+        std::sort(closures.begin(), closures.end(), [](const AvailabilityChange &a, const AvailabilityChange &b)
+                  { return a.time < b.time; });
+    }
+    size_t nextClosure = 0;
+    std::vector<bool> open(numberOfLines, true);
+
+    // Events: (time, line); line 0 = next arrival, line > 0 = service completion of that line,
+    // line < 0 = someone reaching line -line after the walk
+    using Event = std::pair<double, int>;
+    std::priority_queue<Event, std::vector<Event>, std::greater<Event>> events;
+    // One engine per stream, so every candidate sees the same arrivals, groups, walks, baskets and
+    // service work whatever it routes (a shared engine would hand each candidate a different day)
+    std::mt19937 arrivalRng(SimConfig::SEED);
+    std::mt19937 groupRng(SimConfig::SEED + 1);
+    std::mt19937 walkRng(SimConfig::SEED + 2);
+    std::mt19937 customerRng(SimConfig::SEED + 3);
+    std::mt19937 serviceRng(SimConfig::SEED + 4);
+    std::exponential_distribution<double> interArrival(walkToLine ? arrivalRate / SimConfig::MEAN_GROUP_SIZE : arrivalRate);
+    std::geometric_distribution<int> extraGroupMembers(1.0 / SimConfig::MEAN_GROUP_SIZE);
+    std::uniform_real_distribution<double> walkTime(SimConfig::MIN_WALK_SECONDS, SimConfig::MAX_WALK_SECONDS);
+    events.push(Event(interArrival(arrivalRng), 0));
+
+    std::discrete_distribution<int> basketDist(std::begin(SimConfig::BASKET_SHARES), std::end(SimConfig::BASKET_SHARES));
+    std::lognormal_distribution<double> hintError(0.0, SimConfig::HINT_ERROR);
+    std::gamma_distribution<double> serviceNoise(4.0, 0.25); // Mean 1, CV 0.5
+    std::bernoulli_distribution expressCustomer(SimConfig::EXPRESS_SHARE);
+    std::exponential_distribution<double> unitWork(1.0);
+
+    // Everyone not yet at a register, and the registers busy, per line
+    std::vector<std::deque<WaitingPerson>> waiting(numberOfLines);
+    std::vector<int> busy(numberOfLines, 0);
+    std::vector<double> waits;
+    waits.reserve(static_cast<size_t>(arrivalRate * SimConfig::SIMULATED_SECONDS * 1.1));
+    double totalEstimateError = 0.0;
+    std::vector<double> trips;
+    std::vector<std::deque<double>> walking(numberOfLines); // Station departure of everyone walking to each line
+    double classWaits[CUSTOMER_CLASS_COUNT] = {};
+    size_t classServed[CUSTOMER_CLASS_COUNT] = {};
+    size_t moved = 0;
+
+    std::unique_ptr<QueueManager> view; // State the arrivals see when routing is stale
+    double nextRefresh = 0.0;
+
+    auto startService = [&](int line, double now)
+    {
+        WaitingPerson front = waiting[line - 1].front();
+        waiting[line - 1].pop_front();
+        busy[line - 1]++;
+        waits.push_back(now - front.arrival);
+        trips.push_back(now - front.asked);
+        totalEstimateError += std::fabs(front.estimate - (now - front.arrival));
+        classWaits[static_cast<int>(front.customerClass)] += now - front.arrival;
+        classServed[static_cast<int>(front.customerClass)]++;
+        events.push(Event(now + front.work / rates[line - 1], line));
+    };
+
+    // Joins a line; straight to a register if one is free. The service work is drawn on joining
+    // (the n-th person to join gets the same work in every run): the basket with mild noise, or
+    // exponential for average customers
+    auto join = [&](int line, double now, double basket, double hint, CustomerClass customerClass, double asked)
+    {
+        double work = basket * (variableBaskets || classed ? serviceNoise(serviceRng) : unitWork(serviceRng));
+        double estimate = queueManager.getEstimatedWaitTime(line, customerClass);
+        EnqueueResult ticket = queueManager.enqueueOnLine(line, hint, customerClass);
+        if (!ticket)
+            return;
+        waiting[line - 1].push_back(WaitingPerson{now, work, estimate, customerClass, asked, ticket.personId});
+        if (open[line - 1] && busy[line - 1] < servers[line - 1])
+            startService(line, now);
+    };
+
+    while (!events.empty())
+    {
+        Event event = events.top();
+        events.pop();
+        double now = event.first;
+        if (now > SimConfig::SIMULATED_SECONDS)
+            break;
+        g_simulatedMillis = 1000000 + static_cast<long long>(now * 1000.0);
+
+        // Staff come and go between events; opened registers take the next people waiting
+        while (nextStaffingChange < staffing.size() && staffing[nextStaffingChange].time <= now)
+        {
+            const StaffingChange &change = staffing[nextStaffingChange++];
+            servers[change.line - 1] = change.servers;
+            if (scenario == Scenario::STAFFED_REGISTERS)
+                queueManager.setServerCount(change.line, change.servers);
+            while (busy[change.line - 1] < servers[change.line - 1] && !waiting[change.line - 1].empty())
+                startService(change.line, now);
+        }
+
+        // A register closes at the first event after its nominal time at which someone waits behind
+        // it (closing an empty line would strand nobody) and reopens OUTAGE_SECONDS later. It finishes
+        // its current customer; with failover, whoever the manager moved walks over to their new line
+        // (the lines stand side by side)
+        while (nextClosure < closures.size() && closures[nextClosure].time <= now)
+        {
+            AvailabilityChange change = closures[nextClosure];
+            int line = change.line;
+            if (!change.available && waiting[line - 1].empty())
+                break;
+            nextClosure++;
+            if (!change.available)
+            {
+                AvailabilityChange reopening{now + SimConfig::OUTAGE_SECONDS, line, true};
+                closures.insert(std::upper_bound(closures.begin() + static_cast<long>(nextClosure), closures.end(), reopening,
+                                                 [](const AvailabilityChange &a, const AvailabilityChange &b)
+                                                 { return a.time < b.time; }),
+                                reopening);
+            }
+            open[line - 1] = change.available;
+            queueManager.setLineAvailability(line, change.available);
+            std::deque<WaitingPerson> stayed;
+            for (const WaitingPerson &person : waiting[line - 1])
+            {
+                int newLine = queueManager.getLineNumberOfPerson(person.personId);
+                if (newLine == line || newLine == 0)
+                {
+                    stayed.push_back(person);
+                    continue;
+                }
+                waiting[newLine - 1].push_back(person);
+                moved++;
+                if (busy[newLine - 1] < servers[newLine - 1])
+                    startService(newLine, now);
+            }
+            waiting[line - 1].swap(stayed);
+            while (open[line - 1] && busy[line - 1] < servers[line - 1] && !waiting[line - 1].empty())
+                startService(line, now);
+        }
+
+        if (event.second == 0 && walkToLine)
+        {
+            events.push(Event(now + interArrival(arrivalRng), 0));
+            int groupSize = 1 + extraGroupMembers(groupRng);
+            for (int member = 0; member < groupSize; ++member)
+            {
+                int line = queueManager.recommendLine(strategy);
+                double walk = walkTime(walkRng);
+                if (line != -1)
+                    events.push(Event(now + walk, -line));
+            }
+        }
+        else if (event.second == 0 && venue)
+        {
+            events.push(Event(now + interArrival(arrivalRng), 0));
+            int line = queueManager.recommendLine(strategy);
+            if (line != -1)
+            {
+                // Walking times are fixed per line, so people reach a line in the order they left
+                walking[line - 1].push_back(now);
+                events.push(Event(now + layout.getWalkSeconds(line), -line));
+            }
+        }
+        else if (event.second < 0)
+        {
+            int line = -event.second;
+            double asked = now;
+            if (venue)
+            {
+                asked = walking[line - 1].front();
+                walking[line - 1].pop_front();
+            }
+            join(line, now, 1.0, 1.0, CustomerClass::STANDARD, asked);
+        }
+        else if (event.second == 0)
+        {
+            events.push(Event(now + interArrival(arrivalRng), 0));
+            double basket = variableBaskets ? SimConfig::BASKET_SIZES[basketDist(customerRng)] : 1.0;
+            double hint = variableBaskets && !rebalancing ? basket * hintError(customerRng) : 1.0;
+            CustomerClass customerClass = CustomerClass::STANDARD;
+            if (classed)
+            {
+                customerClass = expressCustomer(customerRng) ? CustomerClass::EXPRESS : CustomerClass::STANDARD;
+                basket = customerClass == CustomerClass::EXPRESS ? SimConfig::EXPRESS_BASKET : SimConfig::STANDARD_BASKET;
+                hint = basket;
+            }
+
+            // Live decision on every arrival (also keeps a sampling strategy's generator moving between views)
+            int line = queueManager.getNextLineNumber(strategy, customerClass);
+            if (stalenessSeconds > 0)
+            {
+                if (!view || now >= nextRefresh)
+                {
+                    view = queueManager.fork();
+                    nextRefresh = now + stalenessSeconds;
+                }
+                line = view->getNextLineNumber(strategy, customerClass);
+            }
+            if (line != -1)
+                join(line, now, basket, hint, customerClass, now);
+        }
+        else
+        {
+            int line = event.second;
+            queueManager.dequeue(line, strategy);
+            busy[line - 1]--;
+            if (open[line - 1] && busy[line - 1] < servers[line - 1] && !waiting[line - 1].empty())
+                startService(line, now);
+        }
+
+        // Everyone advised to move does so right away (the lines stand side by side), keeping their
+        // ticket and their place in the statistics from their first arrival
+        RebalanceMove move;
+        for (int round = 0; rebalancing && round < numberOfLines && queueManager.getRebalanceRecommendation(move); ++round)
+        {
+            std::deque<WaitingPerson> &from = waiting[move.fromLine - 1];
+            size_t count = std::min(static_cast<size_t>(move.people), from.size());
+            std::vector<WaitingPerson> movers(from.end() - count, from.end());
+            from.erase(from.end() - count, from.end());
+            for (WaitingPerson &person : movers)
+            {
+                if (!queueManager.moveWaitingPerson(person.personId, move.toLine))
+                {
+                    from.push_back(person);
+                    continue;
+                }
+                waiting[move.toLine - 1].push_back(person);
+                moved++;
+                if (busy[move.toLine - 1] < servers[move.toLine - 1])
+                    startService(move.toLine, now);
+            }
+        }
+    }
+
+    // Cost of one routing decision on the end-of-day state
+    auto start = std::chrono::steady_clock::now();
+    volatile int sink = 0;
+    for (int i = 0; i < SimConfig::DECISION_TIMING_CALLS; ++i)
+        sink = sink + queueManager.getNextLineNumber(strategy);
+    RoutingResult result;
+    result.selectNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() /
+                      SimConfig::DECISION_TIMING_CALLS;
+
+    result.served = waits.size();
+    result.moved = moved;
+    double total = 0.0;
+    for (double wait : waits)
+        total += wait;
+    result.meanWait = waits.empty() ? 0.0 : total / waits.size();
+    result.meanEstimateError = waits.empty() ? 0.0 : totalEstimateError / waits.size();
+    int express = static_cast<int>(CustomerClass::EXPRESS), standard = static_cast<int>(CustomerClass::STANDARD);
+    result.meanExpressWait = classServed[express] ? classWaits[express] / classServed[express] : 0.0;
+    result.meanStandardWait = classServed[standard] ? classWaits[standard] / classServed[standard] : 0.0;
+    double totalTrip = 0.0;
+    for (double trip : trips)
+        totalTrip += trip;
+    result.meanTrip = trips.empty() ? 0.0 : totalTrip / trips.size();
+    result.p99Trip = percentile(trips, 0.99);
+    result.maxWait = waits.empty() ? 0.0 : *std::max_element(waits.begin(), waits.end());
+    result.p95Wait = percentile(waits, 0.95);
+    result.p99Wait = percentile(waits, 0.99);
+    return result;
+}
+
+static bool useBuiltIn(LineSelectionStrategy strategy, LineSelectionStrategy &id)
+{
+    id = strategy;
+    return true;
+}
+
+static void printHeader()
+{
+    std::cout << std::setw(6) << "lines" << std::setw(8) << "stale" << "  " << std::left << std::setw(20)
+              << "strategy" << std::right << std::setw(12) << "select ns" << std::setw(10) << "served"
+              << std::setw(10) << "mean" << std::setw(10) << "p95" << std::setw(10) << "p99" << std::endl;
+}
+
+static void printRow(int lines, int staleness, const Candidate &candidate, const RoutingResult &result)
+{
+    std::cout << std::setw(6) << lines << std::setw(7) << staleness << "s" << "  " << std::left
+              << std::setw(20) << candidate.name << std::right << std::fixed << std::setprecision(1)
+              << std::setw(12) << result.selectNs << std::setw(10) << result.served
+              << std::setw(10) << result.meanWait << std::setw(10) << result.p95Wait
+              << std::setw(10) << result.p99Wait << std::endl;
+}
+
+static void printStaffedRow(const char *staffing, const Candidate &candidate, const RoutingResult &result)
+{
+    std::cout << std::setw(6) << SimConfig::STAFFED_LINES << "  " << std::left << std::setw(10) << staffing
+              << std::setw(20) << candidate.name << std::right << std::fixed << std::setprecision(1)
+              << std::setw(10) << result.served << std::setw(10) << result.meanWait << std::setw(10)
+              << result.p95Wait << std::setw(10) << result.p99Wait << std::setw(12) << result.meanEstimateError
+              << std::endl;
+}
+
+static void printExpressRow(const char *lanes, const Candidate &candidate, const RoutingResult &result)
+{
+    std::cout << std::setw(6) << SimConfig::EXPRESS_VENUE_LINES << "  " << std::left << std::setw(10) << lanes
+              << std::setw(20) << candidate.name << std::right << std::fixed << std::setprecision(1)
+              << std::setw(10) << result.served << std::setw(10) << result.meanWait << std::setw(10)
+              << result.meanExpressWait << std::setw(10) << result.meanStandardWait << std::setw(10)
+              << result.p99Wait << std::setw(12) << result.meanEstimateError << std::endl;
+}
+
+static void printVenueRow(double load, const Candidate &candidate, const RoutingResult &result)
+{
+    std::cout << std::setw(6) << SimConfig::VENUE_LINES << std::fixed << std::setprecision(1) << std::setw(6) << load
+              << "  " << std::left << std::setw(20) << candidate.name
+              << std::right << std::fixed << std::setprecision(1) << std::setw(10) << result.served
+              << std::setw(10) << result.meanWait << std::setw(10) << result.p99Wait << std::setw(12)
+              << result.meanTrip << std::setw(12) << result.p99Trip << std::endl;
+}
+
+static void printRebalanceRow(double threshold, const Candidate &candidate, const RoutingResult &result)
+{
+    std::cout << std::setw(6) << SimConfig::REBALANCE_LINES << "  " << std::left << std::setw(10)
+              << (threshold > 0.0 ? std::to_string(static_cast<int>(threshold)) + "s" : std::string("off"))
+              << std::setw(20) << candidate.name << std::right << std::fixed << std::setprecision(1)
+              << std::setw(10) << result.served << std::setw(10) << result.moved << std::setw(10)
+              << result.meanWait << std::setw(10) << result.p95Wait << std::setw(10) << result.p99Wait << std::endl;
+}
+
+static void printOutageRow(const char *failover, const Candidate &candidate, const RoutingResult &result)
+{
+    std::cout << std::setw(6) << SimConfig::OUTAGE_LINES << "  " << std::left << std::setw(10) << failover
+              << std::setw(20) << candidate.name << std::right << std::fixed << std::setprecision(1)
+              << std::setw(10) << result.served << std::setw(10) << result.moved << std::setw(10)
+              << result.meanWait << std::setw(10) << result.p99Wait << std::setw(10) << result.maxWait << std::endl;
+}
+
+int main()
+{
+    std::cout << "=== ROUTING COMPARISON ===" << std::endl;
+    SimulationClock::setSource(simulatedNow);
+
+    Candidate shortestWait = {"SHORTEST_WAIT_TIME", [](QueueManager &, LineSelectionStrategy &id)
+                              { return useBuiltIn(LineSelectionStrategy::SHORTEST_WAIT_TIME, id); }};
+    std::vector<Candidate> candidates = {
+        shortestWait,
+        {"power of 2 choices", [](QueueManager &queueManager, LineSelectionStrategy &id)
+         { return queueManager.addStrategy("power_of_two_choices", &id); }},
+        {"power of 3 choices", [](QueueManager &queueManager, LineSelectionStrategy &id)
+         { return queueManager.addStrategy(std::unique_ptr<SelectionStrategy>(new PowerOfDStrategy(3, SimConfig::SEED)), &id); }},
+    };
+    std::vector<Candidate> basketCandidates = {
+        shortestWait,
+        {"FEWEST_PEOPLE", [](QueueManager &, LineSelectionStrategy &id)
+         { return useBuiltIn(LineSelectionStrategy::FEWEST_PEOPLE, id); }},
+        {"SHORTEST_WORKLOAD", [](QueueManager &, LineSelectionStrategy &id)
+         { return useBuiltIn(LineSelectionStrategy::SHORTEST_WORKLOAD, id); }},
+    };
+    std::vector<Candidate> walkCandidates = {
+        shortestWait,
+        candidates[1],
+        {"lookahead, pending", [](QueueManager &queueManager, LineSelectionStrategy &id)
+         { return queueManager.addStrategy(std::unique_ptr<SelectionStrategy>(new LookaheadStrategy(0.0)), &id); }},
+        {"LOOKAHEAD", [](QueueManager &, LineSelectionStrategy &id)
+         { return useBuiltIn(LineSelectionStrategy::LOOKAHEAD, id); }},
+    };
+    std::vector<Candidate> staffedCandidates = {shortestWait, basketCandidates[2]};
+    std::vector<Candidate> expressCandidates = {shortestWait, basketCandidates[2]};
+    std::vector<Candidate> venueCandidates = {
+        shortestWait,
+        walkCandidates[3],
+        {"WALK_AND_WAIT", [](QueueManager &, LineSelectionStrategy &id)
+         { return useBuiltIn(LineSelectionStrategy::WALK_AND_WAIT, id); }},
+    };
+
+    // Line setup messages from every run would drown the table
+    std::cout.setstate(std::ios::failbit);
+    std::vector<RoutingResult> results;
+    for (int lines : SimConfig::LINE_COUNTS)
+        for (int staleness : SimConfig::STALENESS_SECONDS)
+            for (const Candidate &candidate : candidates)
+                results.push_back(simulate(lines, staleness, candidate, Scenario::AVERAGE_CUSTOMERS));
+    std::vector<RoutingResult> basketResults;
+    for (const Candidate &candidate : basketCandidates)
+        basketResults.push_back(simulate(SimConfig::BASKET_LINES, 0, candidate, Scenario::VARIABLE_BASKETS));
+    std::vector<RoutingResult> walkResults;
+    for (const Candidate &candidate : walkCandidates)
+        walkResults.push_back(simulate(SimConfig::WALK_LINES, 0, candidate, Scenario::WALK_TO_LINE));
+    std::vector<RoutingResult> staffedResults;
+    for (const Candidate &candidate : staffedCandidates)
+    {
+        staffedResults.push_back(simulate(SimConfig::STAFFED_LINES, 0, candidate, Scenario::STAFFED_UNREPORTED));
+        staffedResults.push_back(simulate(SimConfig::STAFFED_LINES, 0, candidate, Scenario::STAFFED_REGISTERS));
+    }
+    std::vector<RoutingResult> expressResults;
+    for (const Candidate &candidate : expressCandidates)
+    {
+        expressResults.push_back(simulate(SimConfig::EXPRESS_VENUE_LINES, 0, candidate, Scenario::MIXED_CLASSES));
+        expressResults.push_back(simulate(SimConfig::EXPRESS_VENUE_LINES, 0, candidate, Scenario::EXPRESS_LANES));
+    }
+    std::vector<RoutingResult> venueResults;
+    for (double load : SimConfig::VENUE_LOADS)
+        for (const Candidate &candidate : venueCandidates)
+            venueResults.push_back(simulate(SimConfig::VENUE_LINES, 0, candidate, Scenario::VENUE_LAYOUT, load));
+    std::vector<RoutingResult> rebalanceResults;
+    for (double threshold : SimConfig::REBALANCE_THRESHOLDS)
+        rebalanceResults.push_back(simulate(SimConfig::REBALANCE_LINES, 0, shortestWait, Scenario::REBALANCING,
+                                            SimConfig::LOAD, threshold));
+    RoutingResult outageResult = simulate(SimConfig::OUTAGE_LINES, 0, shortestWait, Scenario::OUTAGE);
+    RoutingResult failoverResult = simulate(SimConfig::OUTAGE_LINES, 0, shortestWait, Scenario::OUTAGE_FAILOVER);
+    std::cout.clear();
+
+    std::cout << "\nLoad " << SimConfig::LOAD << ", " << SimConfig::SIMULATED_SECONDS / 3600.0
+              << " simulated hours per run, waits in seconds" << std::endl;
+    printHeader();
+    size_t r = 0;
+    for (int lines : SimConfig::LINE_COUNTS)
+        for (int staleness : SimConfig::STALENESS_SECONDS)
+            for (const Candidate &candidate : candidates)
+                printRow(lines, staleness, candidate, results[r++]);
+
+    std::cout << "\nVariable basket sizes (70% x0.5, 25% x1.4, 5% x6.0; hint within ~"
+              << static_cast<int>(SimConfig::HINT_ERROR * 100) << "%)" << std::endl;
+    printHeader();
+    for (size_t i = 0; i < basketCandidates.size(); ++i)
+        printRow(SimConfig::BASKET_LINES, 0, basketCandidates[i], basketResults[i]);
+
+    std::cout << "\nGroups of " << SimConfig::MEAN_GROUP_SIZE << " on average, " << SimConfig::MIN_WALK_SECONDS
+              << "-" << SimConfig::MAX_WALK_SECONDS << "s walk from the recommendation to the line" << std::endl;
+    printHeader();
+    for (size_t i = 0; i < walkCandidates.size(); ++i)
+        printRow(SimConfig::WALK_LINES, 0, walkCandidates[i], walkResults[i]);
+
+    std::cout << "\nLines 1-2 with " << SimConfig::ALL_DAY_REGISTERS << " registers, line 3 with 2 from hour "
+              << SimConfig::EXTRA_REGISTER_FROM / 3600.0 << " to " << SimConfig::EXTRA_REGISTER_UNTIL / 3600.0
+              << "; est err = mean |announced - actual| wait" << std::endl;
+    std::cout << std::setw(6) << "lines" << "  " << std::left << std::setw(10) << "registers" << std::setw(20)
+              << "strategy" << std::right << std::setw(10) << "served" << std::setw(10) << "mean" << std::setw(10)
+              << "p95" << std::setw(10) << "p99" << std::setw(12) << "est err" << std::endl;
+    for (size_t i = 0; i < staffedCandidates.size(); ++i)
+    {
+        printStaffedRow("assumed 1", staffedCandidates[i], staffedResults[2 * i]);
+        printStaffedRow("reported", staffedCandidates[i], staffedResults[2 * i + 1]);
+    }
+
+    std::cout << "\n" << static_cast<int>(SimConfig::EXPRESS_SHARE * 100) << "% EXPRESS customers (basket x"
+              << SimConfig::EXPRESS_BASKET << ", others x" << SimConfig::STANDARD_BASKET << "); express = first "
+              << SimConfig::EXPRESS_LANES << " line(s) serve EXPRESS only" << std::endl;
+    std::cout << std::setw(6) << "lines" << "  " << std::left << std::setw(10) << "lanes" << std::setw(20)
+              << "strategy" << std::right << std::setw(10) << "served" << std::setw(10) << "mean" << std::setw(10)
+              << "express" << std::setw(10) << "standard" << std::setw(10) << "p99" << std::setw(12) << "est err"
+              << std::endl;
+    for (size_t i = 0; i < expressCandidates.size(); ++i)
+    {
+        printExpressRow("none", expressCandidates[i], expressResults[2 * i]);
+        printExpressRow("express", expressCandidates[i], expressResults[2 * i + 1]);
+    }
+
+    VenueLayout layout = venueLayout(SimConfig::VENUE_LINES);
+    double nearestWalk = layout.getWalkSeconds(1), farthestWalk = layout.getWalkSeconds(1);
+    for (int line = 2; line <= SimConfig::VENUE_LINES; ++line)
+    {
+        nearestWalk = std::min(nearestWalk, layout.getWalkSeconds(line));
+        farthestWalk = std::max(farthestWalk, layout.getWalkSeconds(line));
+    }
+    std::cout << "\nVenue with two rows of lines, " << std::setprecision(0) << nearestWalk << "-" << farthestWalk
+              << "s walk from the hostess station; trip = walk + wait" << std::endl;
+    std::cout << std::setw(6) << "lines" << std::setw(6) << "load" << "  " << std::left << std::setw(20)
+              << "strategy" << std::right << std::setw(10) << "served" << std::setw(10) << "mean" << std::setw(10) << "p99" << std::setw(12)
+              << "mean trip" << std::setw(12) << "p99 trip" << std::endl;
+    size_t v = 0;
+    for (double load : SimConfig::VENUE_LOADS)
+        for (const Candidate &candidate : venueCandidates)
+            printVenueRow(load, candidate, venueResults[v++]);
+
+    std::cout << "\nVariable basket sizes nobody announces; rebalance = minimum saving for advice to move"
+              << std::endl;
+    std::cout << std::setw(6) << "lines" << "  " << std::left << std::setw(10) << "rebalance" << std::setw(20)
+              << "strategy" << std::right << std::setw(10) << "served" << std::setw(10) << "moved" << std::setw(10)
+              << "mean" << std::setw(10) << "p95" << std::setw(10) << "p99" << std::endl;
+    for (size_t i = 0; i < SimConfig::REBALANCE_THRESHOLDS.size(); ++i)
+        printRebalanceRow(SimConfig::REBALANCE_THRESHOLDS[i], shortestWait, rebalanceResults[i]);
+
+    std::cout << "\n" << SimConfig::OUTAGES.size() << " registers closed for " << SimConfig::OUTAGE_SECONDS / 60.0
+              << " minutes each; failover = people waiting there move to the other lines" << std::endl;
+    std::cout << std::setw(6) << "lines" << "  " << std::left << std::setw(10) << "failover" << std::setw(20)
+              << "strategy" << std::right << std::setw(10) << "served" << std::setw(10) << "moved" << std::setw(10)
+              << "mean" << std::setw(10) << "p99" << std::setw(10) << "max" << std::endl;
+    printOutageRow("off", shortestWait, outageResult);
+    printOutageRow("on", shortestWait, failoverResult);
+
+    SimulationClock::setSource(nullptr);
+    return 0;
+}
@@ -110,7 +110,7 @@ public:
                   << " lines, max size per line: " << SimConfig::MAX_QUEUE_SIZE << std::endl;
     }
 
-    bool processArrival()
+    EnqueueResult processArrival()
     {
         switch (strategyType)
         {
@@ -121,7 +121,7 @@ public:
         case StrategyType::FARTHEST_FROM_ENTRANCE:
             return queueManager->enqueue(LineSelectionStrategy::FARTHEST_FROM_ENTRANCE);
         }
-        return false;
+        return EnqueueResult();
     }
 
     bool processService(int line)
@@ -129,16 +129,12 @@ public:
         if (queueManager->getLineCount(line) > 0)
         {
             // Get the person being served before removing them
-            auto peopleInLine = queueManager->getPeopleInLine(line);
-            if (!peopleInLine.empty())
+            const Person *personBeingServed = queueManager->peekFront(line);
+            if (personBeingServed && personBeingServed->hasExited())
             {
-                const auto &personBeingServed = peopleInLine.front();
-                if (personBeingServed.hasExited())
-                {
-                    // Track actual wait time for this line
-                    double actualWaitTime = personBeingServed.getActualWaitTime();
-                    lineWaitStats[line - 1].addCompletedPerson(actualWaitTime);
-                }
+                // Track actual wait time for this line
+                double actualWaitTime = personBeingServed->getActualWaitTime();
+                lineWaitStats[line - 1].addCompletedPerson(actualWaitTime);
             }
 
             // Use appropriate dequeue method for this simulator type
@@ -175,24 +171,6 @@ public:
         return queueManager->getEstimatedWaitTime(line);
     }
 
-    int getNextLineNumber() const
-    {
-        switch (strategyType)
-        {
-        case StrategyType::FEWEST_PEOPLE:
-            return queueManager->getNextLineNumber(LineSelectionStrategy::FEWEST_PEOPLE);
-        case StrategyType::SHORTEST_WAIT_TIME:
-            // Determine which strategy is currently being used
-            return queueManager->getNextLineNumber(
-                (queueManager->getCumulativePeopleSummary().completedPeople >= 30)
-                    ? LineSelectionStrategy::SHORTEST_WAIT_TIME
-                    : LineSelectionStrategy::FEWEST_PEOPLE);
-        case StrategyType::FARTHEST_FROM_ENTRANCE:
-            return queueManager->getNextLineNumber(LineSelectionStrategy::FARTHEST_FROM_ENTRANCE);
-        }
-        return 1;
-    }
-
     const std::string &getName() const
     {
         return strategyName;
@@ -202,7 +180,8 @@ public:
     {
         if (strategyType == StrategyType::SHORTEST_WAIT_TIME)
         {
-            bool usingShortestWait = queueManager->getCumulativePeopleSummary().completedPeople >= 30;
+            bool usingShortestWait = queueManager->getEffectiveStrategy(LineSelectionStrategy::ADAPTIVE) ==
+                                     LineSelectionStrategy::SHORTEST_WAIT_TIME;
             return usingShortestWait ? "SHORTEST_WAIT_TIME" : "FEWEST_PEOPLE (adaptive)";
         }
         return strategyName;
@@ -358,9 +337,6 @@ private:
     // Multithreading components
     std::thread eventGeneratorThread;
 
-    // Event coordination - single threaded synchronous processing
-    std::mutex eventMutex;
-
     // Output synchronization
     std::mutex outputMutex;
 
@@ -530,17 +506,16 @@ private:
 
         if (event.type == SimulationEvent::ARRIVAL)
         {
-            if (simulator->processArrival())
+            EnqueueResult ticket = simulator->processArrival();
+            if (ticket)
             {
-                int selectedLine = simulator->getNextLineNumber();
-
                 std::lock_guard<std::mutex> outputLock(outputMutex);
                 std::cout << "[" << simulator->getName() << "] ARRIVAL -> Line "
-                          << selectedLine << " (" << simulator->getCurrentStrategyDescription() << ")"
-                          << " | People: " << simulator->getLineCount(selectedLine)
+                          << ticket.lineNumber << " (" << simulator->getCurrentStrategyDescription() << ")"
+                          << " | Position: " << ticket.position
                           << " | Total: " << simulator->getTotalSize()
                           << " | Wait: " << std::fixed << std::setprecision(1)
-                          << simulator->getEstimatedWaitTime(selectedLine) << "s" << std::endl;
+                          << ticket.predictedWait << "s" << std::endl;
             }
             else
             {
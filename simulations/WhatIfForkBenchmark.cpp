@@ -0,0 +1,119 @@
+#include <iostream>
+#include <chrono>
+#include <iomanip>
+#include <memory>
+#include <random>
+#include <vector>
+#include "../shared/cpp/QueueManager.h"
+
+// ============================================================================
+// WHAT-IF FORK BENCHMARK
+// Builds a busy live QueueManager, then repeatedly forks it and plays short
+// scenarios on the forks ("close line 2", "open line 4") to compare projected
+// wait times. Reports how many forks per second are possible and checks that
+// the live instance is never modified. Runs without Firebase.
+// ============================================================================
+namespace BenchConfig
+{
+    const int NUMBER_OF_LINES = 4;
+    const int PEOPLE_PER_LINE = 2000;  // Live occupancy, so a deep copy would be expensive
+    const int FORKS = 20000;           // Plain forks for the fork cost measurement
+    const int SCENARIO_RUNS = 2000;    // Forks per scenario for the projection
+    const int SCENARIO_EVENTS = 40;    // Arrivals/services played on each fork
+    const std::vector<double> SERVICE_RATES = {0.08, 0.12, 0.18, 0.24};
+}
+
+struct Scenario
+{
+    const char *name;
+    int closedLine; // Line made unavailable for the run (0 = none)
+    int openedLine; // Line made available for the run (0 = none)
+};
+
+// Plays a burst of routed arrivals and services on the fork, returns the mean wait estimate told to arrivals
+static double runScenario(QueueManager &fork, const Scenario &scenario, std::mt19937 &rng)
+{
+    if (scenario.closedLine > 0)
+        fork.setLineAvailability(scenario.closedLine, false);
+    if (scenario.openedLine > 0)
+        fork.setLineAvailability(scenario.openedLine, true);
+
+    std::uniform_int_distribution<int> lineDist(1, BenchConfig::NUMBER_OF_LINES);
+    double totalWait = 0.0;
+    int arrivals = 0;
+    for (int i = 0; i < BenchConfig::SCENARIO_EVENTS; ++i)
+    {
+        if (i % 2 == 0)
+        {
+            int line = fork.getNextLineNumber(LineSelectionStrategy::SHORTEST_WAIT_TIME);
+            if (line == -1)
+                continue;
+            totalWait += fork.getEstimatedWaitTimeForNewPerson(line);
+            fork.enqueueOnLine(line);
+            arrivals++;
+        }
+        else
+        {
+            int line = lineDist(rng);
+            if (fork.isLineAvailable(line))
+                fork.dequeue(line);
+        }
+    }
+    return arrivals > 0 ? totalWait / arrivals : 0.0;
+}
+
+int main()
+{
+    std::cout << "=== WHAT-IF FORK BENCHMARK ===" << std::endl;
+
+    QueueManager live(0, BenchConfig::NUMBER_OF_LINES, "_live", "", BenchConfig::SERVICE_RATES);
+    for (int line = 1; line <= BenchConfig::NUMBER_OF_LINES; ++line)
+    {
+        for (int i = 0; i < BenchConfig::PEOPLE_PER_LINE; ++i)
+            live.enqueueOnLine(line);
+    }
+    live.setLineAvailability(4, false); // Line 4 is currently closed
+    uint64_t liveVersion = live.getStateVersion();
+    int livePeople = live.size();
+
+    // 1. Cost of a fork alone
+    auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < BenchConfig::FORKS; ++i)
+    {
+        std::unique_ptr<QueueManager> fork = live.fork();
+    }
+    double forkNs = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count() / BenchConfig::FORKS;
+
+    // 2. Projected waits for a few scenarios
+    const std::vector<Scenario> scenarios = {
+        {"as is", 0, 0},
+        {"close line 2", 2, 0},
+        {"open line 4", 0, 4},
+    };
+
+    std::cout << "\n"
+              << std::setw(16) << "scenario"
+              << std::setw(20) << "mean projected wait"
+              << std::setw(16) << "runs/sec" << std::endl;
+    std::mt19937 rng(21);
+    for (const auto &scenario : scenarios)
+    {
+        double waitSum = 0.0;
+        start = std::chrono::steady_clock::now();
+        for (int run = 0; run < BenchConfig::SCENARIO_RUNS; ++run)
+        {
+            std::unique_ptr<QueueManager> fork = live.fork();
+            waitSum += runScenario(*fork, scenario, rng);
+        }
+        double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::cout << std::setw(16) << scenario.name
+                  << std::setw(19) << std::fixed << std::setprecision(1) << waitSum / BenchConfig::SCENARIO_RUNS << "s"
+                  << std::setw(16) << std::setprecision(0) << BenchConfig::SCENARIO_RUNS / seconds << std::endl;
+    }
+
+    bool untouched = live.getStateVersion() == liveVersion && live.size() == livePeople && !live.isLineAvailable(4);
+    std::cout << "\nFork cost: " << std::setprecision(0) << forkNs << " ns ("
+              << live.size() << " people in the live instance)" << std::endl;
+    std::cout << "Live instance untouched: " << (untouched ? "yes" : "NO") << std::endl;
+    return untouched ? 0 : 1;
+}